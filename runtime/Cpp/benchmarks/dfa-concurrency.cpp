@@ -0,0 +1,84 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+//
+//  dfa-concurrency.cpp
+//  Measures how lexing throughput scales with the number of threads sharing one (warm) DFA cache.
+//
+//  Usage: antlr4-dfa-concurrency-benchmark [max threads] [iterations per thread]
+//
+
+#include <iostream>
+#include <iomanip>
+#include <thread>
+
+#include "antlr4-runtime.h"
+
+using namespace antlr4;
+
+static std::string createInput(size_t repetitions) {
+  // The XPath lexer has no whitespace rule, so tokens are simply concatenated.
+  std::string result;
+  for (size_t i = 0; i < repetitions; ++i) {
+    result += "//CompilationUnit/classDeclaration/*/!'some string'//member/ID";
+  }
+  return result;
+}
+
+static size_t lex(const std::string &text) {
+  ANTLRInputStream input(text);
+  XPathLexer lexer(&input);
+
+  size_t count = 0;
+  while (lexer.nextToken()->getType() != Token::EOF) {
+    ++count;
+  }
+  return count;
+}
+
+int main(int argc, const char **argv) {
+  size_t maxThreads = std::max(1U, std::thread::hardware_concurrency());
+  size_t iterations = 20;
+  if (argc > 1) {
+    maxThreads = std::stoul(argv[1]);
+  }
+  if (argc > 2) {
+    iterations = std::stoul(argv[2]);
+  }
+
+  std::string text = createInput(10000);
+  size_t tokensPerPass = lex(text); // Also warms the DFA, so all threads only walk existing edges below.
+
+  std::cout << "tokens per pass: " << tokensPerPass << ", passes per thread: " << iterations << std::endl;
+  std::cout << std::setw(8) << "threads" << std::setw(16) << "tokens/s" << std::setw(10) << "speedup" << std::endl;
+
+  double baseline = 0;
+  for (size_t threadCount = 1; threadCount <= maxThreads; threadCount *= 2) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < threadCount; ++i) {
+      threads.emplace_back([&text, iterations] {
+        for (size_t j = 0; j < iterations; ++j) {
+          lex(text);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double throughput = (double)(tokensPerPass * iterations * threadCount) / elapsed.count();
+    if (threadCount == 1) {
+      baseline = throughput;
+    }
+
+    std::cout << std::setw(8) << threadCount << std::setw(16) << std::fixed << std::setprecision(0) << throughput
+      << std::setw(10) << std::setprecision(2) << throughput / baseline << std::endl;
+  }
+
+  return 0;
+}
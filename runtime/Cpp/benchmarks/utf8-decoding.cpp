@@ -0,0 +1,97 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+//
+//  utf8-decoding.cpp
+//  Compares the UTF-8 <-> UTF-32 conversion of antlrcpp::UTF8 with the std::codecvt based converter
+//  (antlrcpp::UTF32Converter) it replaced, for ASCII and mixed input.
+//
+//  Usage: antlr4-utf8-decoding-benchmark [input size in MB] [iterations]
+//
+
+#include <iostream>
+#include <iomanip>
+
+#include "antlr4-runtime.h"
+
+using namespace antlrcpp;
+
+static std::string createInput(size_t size, bool ascii) {
+  // Source code like text. The mixed variant has 2, 3 and 4 byte sequences in its comments and strings.
+  const std::string line = ascii
+    ? "  int value = compute(left, right); // Combine both sides.\n"
+    : "  int wert = berechne(links, rechts); // Größe: \xe2\x88\x91 \xe6\x97\xa5\xe6\x9c\xac \xf0\x9f\x98\x80\n";
+
+  std::string result;
+  result.reserve(size + line.size());
+  while (result.size() < size) {
+    result += line;
+  }
+  return result;
+}
+
+template<typename Function>
+static double measure(size_t iterations, const Function &function) {
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    function();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / iterations;
+}
+
+static void run(const std::string &name, const std::string &input, size_t iterations) {
+  size_t sink = 0;
+
+  double codecvtDecode = measure(iterations, [&] {
+    UTF32Converter converter;
+    sink += converter.from_bytes(input.data(), input.data() + input.size()).size();
+  });
+  double decode = measure(iterations, [&] {
+    sink += UTF8::decode(input.data(), input.data() + input.size()).size();
+  });
+  double validate = measure(iterations, [&] {
+    sink += UTF8::isValid(input.data(), input.data() + input.size()) ? 1 : 0;
+  });
+
+  UTF32String text = UTF8::decode(input.data(), input.data() + input.size());
+  double codecvtEncode = measure(iterations, [&] {
+    UTF32Converter converter;
+    sink += converter.to_bytes(text).size();
+  });
+  double encode = measure(iterations, [&] {
+    sink += UTF8::encode(text.data(), text.data() + text.size()).size();
+  });
+
+  double megabytes = (double)input.size() / (1024 * 1024);
+  std::cout << name << " (" << std::fixed << std::setprecision(1) << megabytes << " MB, checksum " << sink << ")"
+    << std::endl;
+  std::cout << std::setw(20) << "" << std::setw(12) << "MB/s" << std::setw(10) << "speedup" << std::endl;
+  std::cout << std::setw(20) << "codecvt decode" << std::setw(12) << megabytes / codecvtDecode << std::endl;
+  std::cout << std::setw(20) << "decode" << std::setw(12) << megabytes / decode
+    << std::setw(10) << std::setprecision(2) << codecvtDecode / decode << std::endl;
+  std::cout << std::setw(20) << "validate" << std::setw(12) << std::setprecision(1) << megabytes / validate
+    << std::setw(10) << std::setprecision(2) << codecvtDecode / validate << std::endl;
+  std::cout << std::setw(20) << "codecvt encode" << std::setw(12) << std::setprecision(1)
+    << megabytes / codecvtEncode << std::endl;
+  std::cout << std::setw(20) << "encode" << std::setw(12) << megabytes / encode
+    << std::setw(10) << std::setprecision(2) << codecvtEncode / encode << std::endl;
+}
+
+int main(int argc, const char **argv) {
+  size_t size = 16;
+  size_t iterations = 10;
+  if (argc > 1) {
+    size = std::stoul(argv[1]);
+  }
+  if (argc > 2) {
+    iterations = std::stoul(argv[2]);
+  }
+
+  run("ASCII", createInput(size * 1024 * 1024, true), iterations);
+  run("Mixed", createInput(size * 1024 * 1024, false), iterations);
+
+  return 0;
+}
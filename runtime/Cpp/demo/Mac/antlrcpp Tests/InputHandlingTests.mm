@@ -30,10 +30,18 @@
 #import <XCTest/XCTest.h>
 
 #include "ANTLRInputStream.h"
+#include "CommonToken.h"
+#include "CommonTokenStream.h"
+#include "CompactTokenStream.h"
+#include "ListTokenSource.h"
+#include "ParserRuleContext.h"
+#include "tree/TerminalNodeImpl.h"
+#include "UTF8CharStream.h"
 #include "Exceptions.h"
 #include "Interval.h"
 #include "UnbufferedTokenStream.h"
 #include "StringUtils.h"
+#include "UTF8.h"
 
 using namespace antlrcpp;
 using namespace antlr4;
@@ -165,6 +173,234 @@ using namespace antlr4::misc;
   XCTAssertEqual(stream.getSourceName(), "unit tests");
 }
 
+- (void)testUTF8CharStreamUse {
+  std::string text(u8"🚧Lorem ipsum dolor sit amet🕶");
+  std::u32string wtext = utf8_to_utf32(text.c_str(), text.c_str() + text.size()); // Convert to UTF-32.
+  UTF8CharStream stream(text.data(), text.size());
+  XCTAssertFalse(stream.isAscii());
+  XCTAssertEqual(stream.index(), 0U);
+  XCTAssertEqual(stream.size(), wtext.size());
+  XCTAssertEqual(stream.toString(), text);
+
+  for (size_t i = 0; i < wtext.size(); ++i) {
+    XCTAssertEqual(stream.LA(1), wtext[i]);
+    stream.consume();
+    XCTAssertEqual(stream.index(), i + 1);
+  }
+  XCTAssertEqual(stream.LA(1), IntStream::EOF);
+
+  try {
+    stream.consume();
+    XCTFail();
+  } catch (IllegalStateException &e) {
+    // Expected.
+    std::string message = e.what();
+    XCTAssertEqual(message, "cannot consume EOF");
+  }
+
+  stream.seek(0);
+  XCTAssertEqual(stream.LA(0), 0ULL);
+  for (size_t i = 1; i < wtext.size(); ++i) {
+    XCTAssertEqual(stream.LA(static_cast<ssize_t>(i)), wtext[i - 1]); // LA(1) means: current char.
+    XCTAssertEqual(stream.index(), 0U); // No consumption when looking ahead.
+  }
+
+  stream.seek(wtext.size() - 1);
+  for (ssize_t i = 1; i < static_cast<ssize_t>(wtext.size()) - 1; ++i) {
+    XCTAssertEqual(stream.LA(-i), wtext[wtext.size() - i - 1]); // LA(-1) means: previous char.
+    XCTAssertEqual(stream.index(), wtext.size() - 1); // No consumption when looking ahead.
+  }
+  XCTAssertEqual(stream.LA(-10000), IntStream::EOF);
+
+  misc::Interval interval1(2, 10UL); // From - to, inclusive.
+  XCTAssertEqual(stream.getText(interval1), utf32_to_utf8(wtext.substr(2, 9)));
+
+  misc::Interval interval2(200, 10UL); // Start beyond bounds.
+  XCTAssert(stream.getText(interval2).empty());
+
+  misc::Interval interval3(0, 200UL); // End beyond bounds.
+  XCTAssertEqual(stream.getText(interval3), text);
+
+  // Pure ASCII input is served directly from the bytes.
+  std::string ascii = "Lorem ipsum dolor sit amet";
+  UTF8CharStream asciiStream(ascii.data(), ascii.size());
+  XCTAssert(asciiStream.isAscii());
+  XCTAssertEqual(asciiStream.size(), ascii.size());
+  asciiStream.seek(6);
+  XCTAssertEqual(asciiStream.LA(1), U'i');
+  XCTAssertEqual(asciiStream.LA(-1), U' ');
+  XCTAssertEqual(asciiStream.getText(misc::Interval(6, 10UL)), "ipsum");
+
+  // Invalid bytes are read as U+FFFD (one per byte) instead of failing the whole input.
+  std::string invalid = "a\xC3(b\xE2\x82z\x80";
+  UTF8CharStream invalidStream(invalid.data(), invalid.size());
+  XCTAssertEqual(invalidStream.size(), 8U);
+  std::u32string expected = U"a\uFFFD(b\uFFFD\uFFFDz\uFFFD";
+  for (size_t i = 0; i < expected.size(); ++i) {
+    XCTAssertEqual(invalidStream.LA(1), expected[i]);
+    invalidStream.consume();
+  }
+  XCTAssertEqual(invalidStream.LA(-2), U'z');
+  XCTAssertEqual(invalidStream.getText(misc::Interval(4, 6UL)), "\xE2\x82z");
+}
+
+- (void)testUTF8Conversion {
+  // Long enough to go through the block wise ASCII paths, with multi byte sequences at odd positions.
+  std::string text = u8"The quick brown fox jumps over the lazy dog. Größe 🚧 ∑ 日本語 and some more ASCII text.";
+  std::u32string wtext = UTF8::decode(text.data(), text.data() + text.size());
+  XCTAssertEqual(wtext.size(), 84U);
+  XCTAssertEqual(wtext[47], U'ö');
+  XCTAssertEqual(wtext[51], U'🚧');
+  XCTAssertEqual(UTF8::encode(wtext.data(), wtext.data() + wtext.size()), text);
+  XCTAssert(UTF8::isValid(text.data(), text.data() + text.size()));
+
+  // Overlong forms, surrogates, stray continuation bytes and truncated sequences are invalid.
+  std::string invalid = "a\xC0\xAF" "b\xED\xA0\x80" "c\x80" "d\xF0\x9F";
+  XCTAssertFalse(UTF8::isValid(invalid.data(), invalid.data() + invalid.size()));
+  XCTAssert(UTF8::decode(invalid.data(), invalid.data() + invalid.size()) ==
+            U"a\uFFFD\uFFFDb\uFFFD\uFFFD\uFFFDc\uFFFDd\uFFFD\uFFFD");
+  XCTAssert(UTF8::decode(invalid.data(), invalid.data() + invalid.size(), UTF8::ErrorPolicy::Replace, U'?') ==
+            U"a??b???c?d??");
+  XCTAssert(UTF8::decode(invalid.data(), invalid.data() + invalid.size(), UTF8::ErrorPolicy::Skip) == U"abcd");
+  XCTAssertThrows(UTF8::decode(invalid.data(), invalid.data() + invalid.size(), UTF8::ErrorPolicy::Throw));
+
+  // Values which are no code points are written as U+FFFD.
+  std::u32string noCodePoints = { 0xD800, U'x', 0x110000 };
+  XCTAssertEqual(UTF8::encode(noCodePoints.data(), noCodePoints.data() + noCodePoints.size()),
+                 "\xEF\xBF\xBDx\xEF\xBF\xBD");
+
+  ANTLRInputStream stream(invalid);
+  XCTAssertEqual(stream.size(), 12U);
+  XCTAssertEqual(stream.LA(2), 0xFFFDU);
+
+  stream.errorPolicy = UTF8::ErrorPolicy::Throw;
+  XCTAssertThrows(stream.load(invalid));
+}
+
+- (void)testCommonTokenText {
+  ANTLRInputStream input(u8"int größe;");
+  CommonToken token({ nullptr, &input }, 1, Token::DEFAULT_CHANNEL, 4, 8);
+  XCTAssertFalse(token.hasExplicitText());
+  XCTAssertEqual(token.getText(), u8"größe");
+  XCTAssertFalse(token.hasExplicitText());
+
+  // Text from the input follows changes of the token range, explicit text does not.
+  token.setStopIndex(6);
+  XCTAssertEqual(token.getText(), u8"grö");
+  token.setText("size");
+  XCTAssert(token.hasExplicitText());
+  token.setStartIndex(0);
+  XCTAssertEqual(token.getText(), "size");
+
+  CommonToken copy(&token);
+  XCTAssertEqual(copy.getText(), "size");
+  XCTAssert(copy.hasExplicitText());
+
+  // Empty text is explicit text, too.
+  token.setText("");
+  XCTAssert(token.hasExplicitText());
+  XCTAssertEqual(token.getText(), "");
+}
+
+- (void)testCommonTokenTextView {
+  std::string text = u8"int größe;";
+  UTF8CharStream input(text.data(), text.size());
+  std::pair<TokenSource *, CharStream *> source = { nullptr, &input };
+  CommonToken token(source, 1, Token::DEFAULT_CHANNEL, 4, 8);
+
+  // The view points into the input memory, so repeated calls neither extract nor copy the text.
+  std::pair<const char *, size_t> view = token.getTextView();
+  XCTAssert(view.first == text.data() + 4);
+  XCTAssertEqual(std::string(view.first, view.second), u8"größe");
+  XCTAssert(token.getTextView() == view);
+  XCTAssertEqual(token.getText(), u8"größe");
+
+  CommonToken eof(source, Token::EOF, Token::DEFAULT_CHANNEL, 10, 9);
+  XCTAssertEqual(std::string(eof.getTextView().first, eof.getTextView().second), "<EOF>");
+
+  // Other char streams have no view, their text is still available from getText().
+  ANTLRInputStream other(text);
+  CommonToken otherToken({ nullptr, &other }, 1, Token::DEFAULT_CHANNEL, 0, 2);
+  XCTAssert(otherToken.getTextView().first == nullptr);
+  std::string appended;
+  CommonToken::appendText(&otherToken, appended);
+  CommonToken::appendText(&token, appended);
+  XCTAssertEqual(appended, u8"intgröße");
+
+  // Rule contexts and token streams build their text from the views.
+  ParserRuleContext context;
+  tree::TerminalNodeImpl first(&otherToken);
+  tree::TerminalNodeImpl second(&token);
+  context.addChild(&first);
+  context.addChild(&second);
+  XCTAssertEqual(context.getText(), u8"intgröße");
+
+  std::vector<std::unique_ptr<Token>> tokens;
+  tokens.emplace_back(new CommonToken(source, 1, Token::DEFAULT_CHANNEL, 0, 2));
+  tokens.emplace_back(new CommonToken(source, 2, Token::HIDDEN_CHANNEL, 3, 3));
+  tokens.emplace_back(new CommonToken(source, 1, Token::DEFAULT_CHANNEL, 4, 8));
+  tokens.emplace_back(new CommonToken(source, 3, Token::DEFAULT_CHANNEL, 9, 9));
+  ListTokenSource tokenSource(std::move(tokens));
+  CommonTokenStream stream(&tokenSource);
+  stream.fill();
+  XCTAssertEqual(stream.getText(), text);
+}
+
+- (void)testCompactTokenStream {
+  std::string text = "a = b; // c";
+  ANTLRInputStream input(text);
+  std::pair<TokenSource *, CharStream *> source = { nullptr, &input };
+
+  std::vector<std::unique_ptr<Token>> tokens;
+  tokens.emplace_back(new CommonToken(source, 1, Token::DEFAULT_CHANNEL, 0, 0));
+  tokens.emplace_back(new CommonToken(source, 2, Token::HIDDEN_CHANNEL, 1, 1));
+  tokens.emplace_back(new CommonToken(source, 3, Token::DEFAULT_CHANNEL, 2, 2));
+  tokens.emplace_back(new CommonToken(source, 2, Token::HIDDEN_CHANNEL, 3, 3));
+  std::unique_ptr<CommonToken> empty(new CommonToken(source, 1, Token::DEFAULT_CHANNEL, 4, 4));
+  empty->setText("");
+  tokens.push_back(std::move(empty));
+  tokens.emplace_back(new CommonToken(source, 4, Token::DEFAULT_CHANNEL, 5, 5));
+  std::unique_ptr<CommonToken> comment(new CommonToken(source, 5, Token::HIDDEN_CHANNEL, 7, 10));
+  comment->setText("<comment>");
+  tokens.push_back(std::move(comment));
+  tokens.emplace_back(new CommonToken(source, Token::EOF, Token::DEFAULT_CHANNEL, 11, 10));
+  ListTokenSource tokenSource(std::move(tokens));
+
+  CompactTokenStream stream(&tokenSource);
+  XCTAssertEqual(stream.LA(1), 1U);
+  XCTAssertEqual(stream.LA(2), 3U); // Hidden tokens are skipped.
+  XCTAssertEqual(stream.LT(2)->getText(), "=");
+
+  stream.consume();
+  XCTAssertEqual(stream.index(), 2U);
+  XCTAssertEqual(stream.LT(-1)->getTokenIndex(), 0U);
+
+  stream.fill();
+  XCTAssertEqual(stream.size(), 8U);
+  XCTAssertEqual(stream.getNumberOfOnChannelTokens(), 5U);
+
+  // Handles are stable and take their values from the columns.
+  Token *token = stream.get(5);
+  XCTAssertEqual(token, stream.get(5));
+  XCTAssertEqual(token->getType(), 4U);
+  XCTAssertEqual(token->getStartIndex(), 5U);
+  XCTAssertEqual(token->getText(), ";");
+  XCTAssertEqual(stream.getType(5), 4U);
+
+  // Explicitly set text is kept, everything else is taken from the input.
+  XCTAssertEqual(stream.get(6)->getText(), "<comment>");
+  XCTAssertEqual(stream.get(4)->getText(), ""); // Explicitly set, even though empty.
+  XCTAssertEqual(stream.get(7)->getText(), "<EOF>");
+  XCTAssertEqual(stream.getText(), "a = ;<comment>");
+
+  std::vector<Token *> hidden = stream.getHiddenTokensToRight(5);
+  XCTAssertEqual(hidden.size(), 1U);
+  XCTAssertEqual(hidden[0]->getTokenIndex(), 6U);
+
+  stream.seek(6);
+  XCTAssertEqual(stream.LA(1), Token::EOF);
+}
+
 - (void)testUnbufferedTokenSteam {
   //UnbufferedTokenStream stream;
 }
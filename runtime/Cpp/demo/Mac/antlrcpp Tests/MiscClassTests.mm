@@ -35,6 +35,15 @@ using namespace antlr4;
 using namespace antlr4::misc;
 using namespace antlrcpp;
 
+// Creates a DFA state with a single (readonly) configuration, as used by the DFA tests. Owned by the DFA once added.
+static dfa::DFAState* createDFAState(atn::ATNState *state, size_t alt,
+  RefPtr<PredictionContext> const& context = PredictionContext::EMPTY) {
+  std::unique_ptr<atn::ATNConfigSet> configs(new atn::ATNConfigSet());
+  configs->add(std::make_shared<atn::ATNConfig>(state, alt, context));
+  configs->setReadonly(true);
+  return new dfa::DFAState(std::move(configs));
+}
+
 @interface MiscClassTests : XCTestCase
 
 @end
@@ -385,4 +394,759 @@ using namespace antlrcpp;
   XCTAssert(IntervalSet::of(15, 20).subtract(IntervalSet::of(7, 55)) == IntervalSet::EMPTY_SET);
 }
 
+- (void)testBitSet {
+  BitSet set;
+  XCTAssert(set.none());
+  XCTAssertEqual(set.count(), 0U);
+  XCTAssertEqual(set.nextSetBit(0), INVALID_INDEX);
+  XCTAssertEqual(set.toString(), "{}");
+
+  set.set(1).set(5).set(63);
+  XCTAssert(set.any());
+  XCTAssertEqual(set.count(), 3U);
+  XCTAssertEqual(set.size(), 64U);
+  XCTAssert(set.test(5));
+  XCTAssertFalse(set.test(6));
+  XCTAssertFalse(set.test(1000));
+  XCTAssertEqual(set.nextSetBit(0), 1U);
+  XCTAssertEqual(set.nextSetBit(2), 5U);
+  XCTAssertEqual(set.nextSetBit(6), 63U);
+  XCTAssertEqual(set.nextSetBit(64), INVALID_INDEX);
+  XCTAssertEqual(set.toString(), "{1, 5, 63}");
+
+  // Indices beyond the inline word.
+  set.set(64).set(1000);
+  XCTAssertEqual(set.count(), 5U);
+  XCTAssert(set.size() > 1000);
+  XCTAssertEqual(set.nextSetBit(64), 64U);
+  XCTAssertEqual(set.nextSetBit(65), 1000U);
+  XCTAssertEqual(set.nextSetBit(1001), INVALID_INDEX);
+
+  set.reset(1000);
+  set.reset(2000);
+  XCTAssertFalse(set.test(1000));
+  XCTAssertEqual(set.count(), 4U);
+
+  BitSet other;
+  other.set(1).set(5).set(63).set(64);
+  XCTAssert(set == other);
+  other.reset(64);
+  XCTAssert(set != other);
+  other.set(200);
+  other |= set;
+  XCTAssertEqual(other.toString(), "{1, 5, 63, 64, 200}");
+
+  set.reset();
+  XCTAssert(set.none());
+  XCTAssert(set == BitSet());
+}
+
+- (void)testTypeTags {
+  // Parse tree nodes.
+  CommonToken token(1, "x");
+  tree::TerminalNodeImpl terminal(&token);
+  tree::ErrorNodeImpl error(&token);
+  ParserRuleContext context;
+
+  XCTAssert(context.getTreeType() == tree::ParseTreeType::RULE_NODE);
+  XCTAssert(context.isRuleNode() && !context.isTerminalNode() && !context.isErrorNode());
+  XCTAssert(terminal.getTreeType() == tree::ParseTreeType::TERMINAL_NODE);
+  XCTAssert(terminal.isTerminalNode() && !terminal.isErrorNode());
+  XCTAssert(error.getTreeType() == tree::ParseTreeType::ERROR_NODE);
+  XCTAssert(error.isTerminalNode() && error.isErrorNode() && !error.isRuleNode());
+
+  // Prediction contexts.
+  using namespace antlr4::atn;
+  RefPtr<PredictionContext> a = SingletonPredictionContext::create(PredictionContext::EMPTY, 1);
+  RefPtr<PredictionContext> b = SingletonPredictionContext::create(PredictionContext::EMPTY, 2);
+  XCTAssert(PredictionContext::EMPTY->getContextType() == PredictionContextType::EMPTY);
+  XCTAssert(PredictionContext::EMPTY->isSingleton());
+  XCTAssert(a->getContextType() == PredictionContextType::SINGLETON);
+
+  RefPtr<PredictionContext> merged = PredictionContext::merge(a, b, true, nullptr);
+  XCTAssert(merged->getContextType() == PredictionContextType::ARRAY);
+  XCTAssertFalse(merged->isSingleton());
+  XCTAssertFalse(*merged == *a);
+  XCTAssertFalse(*a == *merged);
+  XCTAssert(*a == *SingletonPredictionContext::create(PredictionContext::EMPTY, 1));
+
+  // ATN states.
+  BasicState basic;
+  StarLoopEntryState loopEntry;
+  XCTAssertFalse(basic.isDecisionState());
+  XCTAssert(loopEntry.isDecisionState());
+}
+
+- (void)testIntrusivePtr {
+  using namespace antlr4::atn;
+
+  RefPtr<PredictionContext> a = SingletonPredictionContext::create(PredictionContext::EMPTY, 1);
+  XCTAssertEqual(a.use_count(), 1U);
+  {
+    RefPtr<PredictionContext> b = a;
+    RefPtr<SingletonPredictionContext> c = antlrcpp::static_pointer_cast<SingletonPredictionContext>(b);
+    XCTAssertEqual(a.use_count(), 3U);
+    XCTAssert(c == a);
+    XCTAssert(antlrcpp::dynamic_pointer_cast<ArrayPredictionContext>(b) == nullptr);
+  }
+  XCTAssertEqual(a.use_count(), 1U);
+
+  // The parent is shared by the context which refers to it.
+  RefPtr<PredictionContext> child = SingletonPredictionContext::create(a, 2);
+  XCTAssertEqual(a.use_count(), 2U);
+  child.reset();
+  XCTAssertEqual(a.use_count(), 1U);
+
+  RefPtr<PredictionContext> moved = std::move(a);
+  XCTAssert(a == nullptr);
+  XCTAssertEqual(moved.use_count(), 1U);
+  moved = nullptr;
+  XCTAssertFalse(moved);
+
+  RefPtr<SemanticContext> p1 = antlrcpp::makeRefPtr<SemanticContext::Predicate>(1, 1, false);
+  RefPtr<SemanticContext> p2 = antlrcpp::makeRefPtr<SemanticContext::Predicate>(1, 2, false);
+  RefPtr<SemanticContext> both = SemanticContext::And(p1, p2);
+  XCTAssert(is<SemanticContext::AND>(both));
+  XCTAssertEqual(p1.use_count(), 2U);
+
+  // Unchanged contexts return themselves.
+  XCTAssert(both->evalPrecedence(nullptr, nullptr) == both);
+  XCTAssert(SemanticContext::And(p1, SemanticContext::NONE) == p1);
+}
+
+
+- (void)testPredictionContextCache {
+  atn::PredictionContextCache cache(4);
+
+  RefPtr<PredictionContext> a = SingletonPredictionContext::create(PredictionContext::EMPTY, 1);
+  RefPtr<PredictionContext> b = SingletonPredictionContext::create(PredictionContext::EMPTY, 1);
+  XCTAssert(cache.add(a) == a);
+  XCTAssert(cache.add(b) == a); // Equal contexts are interned.
+  XCTAssert(cache.get(b) == a);
+  XCTAssert(cache.add(PredictionContext::EMPTY) == PredictionContext::EMPTY);
+  XCTAssertEqual(cache.size(), 1U);
+
+  // Fill two generations. The second entry is used again before it would be evicted, so only the others get dropped.
+  std::vector<RefPtr<PredictionContext>> contexts;
+  for (size_t i = 2; i < 8; ++i) {
+    contexts.push_back(SingletonPredictionContext::create(PredictionContext::EMPTY, i));
+    cache.add(contexts.back());
+    XCTAssert(cache.size() <= 4U);
+    if (i == 4) {
+      XCTAssert(cache.get(contexts[0]) == contexts[0]);
+    }
+  }
+  XCTAssert(cache.get(contexts[0]) == contexts[0]);
+  XCTAssert(cache.get(a) == nullptr);
+
+  atn::PredictionContextCache::Statistics statistics = cache.getStatistics();
+  XCTAssertEqual(statistics.insertions, 7U);
+  XCTAssertEqual(statistics.size, cache.size());
+  XCTAssertEqual(statistics.insertions - statistics.evictions, statistics.size);
+  XCTAssert(statistics.generation > 0);
+  XCTAssertEqual(statistics.hits, 4U);
+
+  cache.setMaxSize(2);
+  XCTAssert(cache.size() <= 2U);
+  cache.newGeneration();
+  cache.newGeneration();
+  XCTAssertEqual(cache.size(), 0U);
+
+  cache.setMaxSize(0);
+  for (size_t i = 10; i < 100; ++i) {
+    cache.add(SingletonPredictionContext::create(PredictionContext::EMPTY, i));
+  }
+  XCTAssertEqual(cache.size(), 90U);
+  cache.clear();
+  XCTAssertEqual(cache.size(), 0U);
+}
+
+
+- (void)testDFAMemoryBudget {
+  dfa::DFA dfa(nullptr, 0);
+  atn::BasicState atnState;
+  atnState.stateNumber = 1;
+
+  dfa::DFAState *first = createDFAState(&atnState, 1);
+  dfa::DFAState *second = createDFAState(&atnState, 2);
+  {
+    std::lock_guard<std::mutex> lck(dfa.getLock());
+    dfa.addState(first);
+    dfa.addState(second);
+    dfa.addEdge(first, 1, second);
+    dfa.s0 = first;
+  }
+  XCTAssertEqual(second->stateNumber, 1);
+  XCTAssert(first->edges.get(1) == second);
+
+  dfa::DFA::Statistics statistics = dfa.getStatistics();
+  XCTAssertEqual(statistics.states, 2U);
+  XCTAssert(statistics.memoryUsage > 0);
+  XCTAssertEqual(statistics.peakMemoryUsage, statistics.memoryUsage);
+
+  {
+    // A reset while the states are in use keeps them alive until they are no longer used.
+    dfa::DFA::EpochGuard guard(dfa);
+    dfa.reset();
+    XCTAssert(dfa.s0 == nullptr);
+    XCTAssertEqual(dfa.getStatistics().states, 0U);
+    XCTAssertEqual(dfa.getStatistics().retiredStates, 2U);
+    XCTAssert(first->edges.get(1) == second);
+  }
+  { dfa::DFA::EpochGuard guard(dfa); }
+  statistics = dfa.getStatistics();
+  XCTAssertEqual(statistics.retiredStates, 0U);
+  XCTAssertEqual(statistics.memoryUsage, 0U);
+  XCTAssertEqual(statistics.resets, 1U);
+
+  // Exceeding the budget resets the DFA before its next use.
+  dfa.setMemoryBudget(1);
+  {
+    std::lock_guard<std::mutex> lck(dfa.getLock());
+    dfa.addState(createDFAState(&atnState, 3));
+  }
+  XCTAssertEqual(dfa.getStatistics().states, 1U);
+  { dfa::DFA::EpochGuard guard(dfa); }
+  statistics = dfa.getStatistics();
+  XCTAssertEqual(statistics.states, 0U);
+  XCTAssertEqual(statistics.resets, 2U);
+  XCTAssertEqual(statistics.memoryBudget, 1U);
+}
+
+
+- (void)testCompactDFAStates {
+  dfa::DFA dfa(nullptr, 0);
+  dfa.setCompactStates(true);
+  atn::BasicState atnState;
+  atnState.stateNumber = 1;
+
+  dfa::DFAState *state = createDFAState(&atnState, 1);
+  {
+    std::lock_guard<std::mutex> lck(dfa.getLock());
+    XCTAssert(dfa.findState(state) == nullptr);
+    XCTAssert(state->hasFingerprint());
+    dfa.addState(state);
+  }
+  size_t memoryUsage = dfa.getStatistics().memoryUsage;
+
+  {
+    std::lock_guard<std::mutex> lck(dfa.getLock());
+    dfa.releaseConfigs(state);
+  }
+  XCTAssert(state->configs == nullptr);
+  XCTAssert(dfa.getStatistics().memoryUsage < memoryUsage);
+
+  // Lookups use the fingerprint, so they still find the state.
+  std::unique_ptr<dfa::DFAState> same(createDFAState(&atnState, 1));
+  std::unique_ptr<dfa::DFAState> other(createDFAState(&atnState, 2));
+  {
+    std::lock_guard<std::mutex> lck(dfa.getLock());
+    XCTAssert(dfa.findState(same.get()) == state);
+    XCTAssert(dfa.findState(other.get()) == nullptr);
+    XCTAssertFalse(*same == *other);
+
+    // A released state which becomes a start state gets its configs back.
+    dfa.restoreConfigs(state, std::move(same->configs));
+  }
+  XCTAssert(state->configs != nullptr);
+  XCTAssertEqual(dfa.getStatistics().memoryUsage, memoryUsage);
+
+  // Fingerprints cover the whole context graph, not just the context hash codes.
+  auto newContextState = [&atnState](size_t returnState) {
+    auto parent = SingletonPredictionContext::create(PredictionContext::EMPTY, returnState);
+    std::unique_ptr<dfa::DFAState> result(createDFAState(&atnState, 1, SingletonPredictionContext::create(parent, 7)));
+    result->computeFingerprint();
+    return result;
+  };
+  XCTAssert(*newContextState(5) == *newContextState(5));
+  XCTAssertFalse(*newContextState(5) == *newContextState(6));
+}
+
+
+- (void)testDFASnapshot {
+  atn::ATN atn(atn::ATNType::PARSER, 1);
+  atn.addState(new atn::BasicState()); // Owned by the ATN.
+  auto context = SingletonPredictionContext::create(PredictionContext::EMPTY, 5);
+
+  std::vector<dfa::DFA> decisionToDFA;
+  decisionToDFA.emplace_back(nullptr, 0);
+  dfa::DFAState *first = createDFAState(atn.states[0], 1, context);
+  dfa::DFAState *second = createDFAState(atn.states[0], 2, context);
+  second->isAcceptState = true;
+  second->prediction = 2;
+  {
+    std::lock_guard<std::mutex> lck(decisionToDFA[0].getLock());
+    decisionToDFA[0].addState(first);
+    decisionToDFA[0].addState(second);
+    decisionToDFA[0].addEdge(first, 1, second);
+    decisionToDFA[0].s0 = first;
+  }
+
+  std::string snapshot = dfa::DFASnapshot::save(atn, decisionToDFA);
+  std::vector<dfa::DFA> restored;
+  restored.emplace_back(nullptr, 0);
+  dfa::DFASnapshot::load(atn, restored, snapshot.data(), snapshot.size());
+  XCTAssertEqual(restored[0].getStatistics().states, 2U);
+
+  dfa::DFAState *s0 = restored[0].s0;
+  XCTAssert(s0 != nullptr && *s0 == *first);
+  dfa::DFAState *target = s0->edges.get(1);
+  XCTAssert(target != nullptr && *target == *second);
+  XCTAssert(target->isAcceptState);
+  XCTAssertEqual(target->prediction, 2U);
+  XCTAssert(dfa::DFASnapshot::save(atn, restored) == snapshot);
+
+  // Snapshots of other ATNs and damaged ones are rejected, without touching the DFAs.
+  atn::ATN other(atn::ATNType::LEXER, 1);
+  XCTAssert(dfa::DFASnapshot::isCompatible(atn, snapshot.data(), snapshot.size()));
+  XCTAssertFalse(dfa::DFASnapshot::isCompatible(other, snapshot.data(), snapshot.size()));
+  XCTAssertThrows(dfa::DFASnapshot::load(atn, restored, snapshot.data(), snapshot.size() - 1));
+  XCTAssert(restored[0].s0 == s0);
+}
+
+
+- (void)testDFAPrecomputer {
+  std::vector<std::string> samples = { "//rule/ID", "/*/!TOKEN", "//'literal'//*", "/a/b/C/d" };
+  auto tokenize = [](XPathLexer &lexer) {
+    std::vector<std::pair<size_t, std::string>> result;
+    for (auto &token : lexer.getAllTokens()) {
+      result.push_back({ token->getType(), token->getText() });
+    }
+    return result;
+  };
+
+  // Lexes the samples on several threads, which all extend the DFAs shared by the XPath lexers.
+  dfa::DFAPrecomputer precomputer([&](CharStream *input) {
+    XPathLexer lexer(input);
+    if (tokenize(lexer).empty()) {
+      throw RuntimeException("empty input");
+    }
+  });
+  ANTLRInputStream empty("");
+  XPathLexer lexer(&empty);
+  precomputer.addRecognizer("XPathLexerDFA", &lexer);
+  XCTAssertThrows(precomputer.addRecognizer("None", nullptr));
+  for (size_t i = 0; i < 20; ++i) {
+    precomputer.addInput(i % 5 == 4 ? "" : samples[i % 5], "sample");
+  }
+
+  dfa::DFAPrecomputer::Statistics statistics = precomputer.run(4);
+  XCTAssertEqual(statistics.inputs, 20U);
+  XCTAssertEqual(statistics.failures, 4U);
+  XCTAssert(statistics.states > 0);
+
+  std::vector<std::string> snapshots = precomputer.getSnapshots();
+  XCTAssertEqual(snapshots.size(), 1U);
+  std::string source = precomputer.generateSource();
+  XCTAssert(source.find("extern const unsigned char XPathLexerDFA[] = {") != std::string::npos);
+  XCTAssert(source.find("extern const size_t XPathLexerDFASize = sizeof(XPathLexerDFA);") != std::string::npos);
+  XCTAssertThrows(precomputer.addFile("/nonexistent/input"));
+
+  // Loaded into fresh DFAs, the image lexes the samples exactly like the shared DFAs, without adding any states.
+  const atn::ATN &atn = lexer.getATN();
+  std::vector<dfa::DFA> decisionToDFA;
+  for (size_t i = 0; i < atn.getNumberOfDecisions(); ++i) {
+    decisionToDFA.emplace_back(atn.getDecisionState(i), i);
+  }
+  dfa::DFASnapshot::load(atn, decisionToDFA, snapshots[0].data(), snapshots[0].size());
+  auto countStates = [&decisionToDFA]() {
+    size_t count = 0;
+    for (auto &dfa : decisionToDFA) {
+      count += dfa.getStatistics().states;
+    }
+    return count;
+  };
+  XCTAssertEqual(countStates(), statistics.states);
+
+  atn::PredictionContextCache cache;
+  for (auto &sample : samples) {
+    ANTLRInputStream sharedInput(sample);
+    XPathLexer sharedLexer(&sharedInput);
+    ANTLRInputStream loadedInput(sample);
+    XPathLexer loadedLexer(&loadedInput);
+    loadedLexer.setInterpreter(new atn::LexerATNSimulator(&loadedLexer, atn, decisionToDFA, cache));
+    XCTAssert(tokenize(loadedLexer) == tokenize(sharedLexer));
+  }
+  XCTAssertEqual(countStates(), statistics.states);
+}
+
+
+- (void)testATNDeserializationPerformance {
+  // Deserialization cost per grammar, as paid when the first recognizer for it is created. Add the serialized ATNs of
+  // other grammars here to compare them.
+  ANTLRInputStream input("");
+  XPathLexer lexer(&input);
+  std::vector<std::pair<std::string, std::vector<uint16_t>>> grammars = {
+    { lexer.getGrammarFileName(), lexer.getSerializedATN() }
+  };
+
+  atn::ATNDeserializationOptions options;
+  options.setVerifyATN(false);
+  for (auto &grammar : grammars) {
+    atn::ATN atn = atn::ATNDeserializer().deserialize(grammar.second);
+    atn::ATN unverified = atn::ATNDeserializer(options).deserialize(grammar.second);
+    XCTAssertEqual(atn.states.size(), unverified.states.size(), @"%s", grammar.first.c_str());
+    XCTAssertEqual(atn.getNumberOfDecisions(), unverified.getNumberOfDecisions(), @"%s", grammar.first.c_str());
+  }
+
+  [self measureBlock: ^{
+    for (auto &grammar : grammars) {
+      for (size_t i = 0; i < 1000; ++i) {
+        atn::ATN atn = atn::ATNDeserializer(options).deserialize(grammar.second);
+      }
+    }
+  }];
+}
+
+
+- (void)testLexerDFATable {
+  // A lexer with the rules A: 'a'+; and B: 'b';. All states are owned by the ATN.
+  atn::ATN atn(atn::ATNType::LEXER, 2);
+  auto addState = [&atn](atn::ATNState *state, size_t ruleIndex) {
+    state->ruleIndex = ruleIndex;
+    atn.addState(state);
+    return state;
+  };
+  atn::TokensStartState *start = static_cast<atn::TokensStartState *>(addState(new atn::TokensStartState(), 0));
+  atn.modeToStartState.push_back(start);
+  atn.defineDecisionState(start);
+  for (size_t rule = 0; rule < 2; ++rule) {
+    atn::RuleStartState *ruleStart = static_cast<atn::RuleStartState *>(addState(new atn::RuleStartState(), rule));
+    atn::RuleStopState *ruleStop = static_cast<atn::RuleStopState *>(addState(new atn::RuleStopState(), rule));
+    ruleStart->stopState = ruleStop;
+    atn.ruleToStartState.push_back(ruleStart);
+    atn.ruleToStopState.push_back(ruleStop);
+    atn.ruleToTokenType.push_back(rule + 1);
+
+    atn::ATNState *before = addState(new atn::BasicState(), rule);
+    atn::ATNState *after = addState(new atn::BasicState(), rule);
+    start->addTransition(new atn::EpsilonTransition(ruleStart));
+    ruleStart->addTransition(new atn::EpsilonTransition(before));
+    before->addTransition(new atn::AtomTransition(after, rule == 0 ? 'a' : 'b'));
+    after->addTransition(new atn::EpsilonTransition(ruleStop));
+    if (rule == 0) {
+      after->addTransition(new atn::EpsilonTransition(before));
+    }
+  }
+
+  XCTAssert(dfa::LexerDFATable::isSupported(atn));
+  dfa::LexerDFATable table(atn);
+  XCTAssertEqual(table.getStateCount(), 3U); // Start, after 'a' and after 'b'.
+  XCTAssertEqual(table.getClassCount(), 3U); // 'a', 'b' and everything else.
+
+  std::vector<uint32_t> data = table.serialize();
+  dfa::LexerDFATable loaded(atn, data.data(), data.size());
+  XCTAssert(loaded.serialize() == data);
+  XCTAssertThrows(dfa::LexerDFATable(atn, data.data(), data.size() - 1));
+
+  // Matching with the table gives the same tokens as ATN simulation.
+  std::vector<dfa::DFA> decisionToDFA;
+  decisionToDFA.emplace_back(start, 0);
+  atn::PredictionContextCache cache;
+  std::vector<dfa::LexerDFATable *> tables = { nullptr, &table, &loaded };
+  for (dfa::LexerDFATable *current : tables) {
+    atn::LexerATNSimulator simulator(atn, decisionToDFA, cache);
+    simulator.setTable(current);
+    ANTLRInputStream input("aaab\nb");
+    XCTAssertEqual(simulator.match(&input, 0), 1U);
+    XCTAssertEqual(input.index(), 3U);
+    XCTAssertEqual(simulator.match(&input, 0), 2U);
+    XCTAssertEqual(simulator.getCharPositionInLine(), 4U);
+    XCTAssertThrows(simulator.match(&input, 0));
+    input.consume();
+    XCTAssertEqual(simulator.match(&input, 0), 2U);
+    XCTAssertEqual(simulator.match(&input, 0), Token::EOF);
+  }
+
+  // XPath lexer uses a custom action.
+  ANTLRInputStream input("");
+  XPathLexer lexer(&input);
+  XCTAssertFalse(dfa::LexerDFATable::isSupported(lexer.getATN()));
+  XCTAssertThrows(dfa::LexerDFATable table(lexer.getATN()));
+  XCTAssertThrows(lexer.getInterpreter<atn::LexerATNSimulator>()->setTable(&table));
+}
+
+- (void)testParseTreeTracker {
+  CommonToken token(1, "a");
+  for (bool useArena : { true, false }) {
+    tree::ParseTreeTracker tracker;
+    tracker.setUseArena(useArena);
+    XCTAssertEqual(tracker.isUsingArena(), useArena);
+
+    for (size_t round = 0; round < 3; ++round) {
+      ParserRuleContext *root = tracker.createInstance<ParserRuleContext>();
+      for (size_t i = 0; i < 10000; ++i) {
+        tree::TerminalNode *node = tracker.createInstance<tree::TerminalNodeImpl>(&token);
+        node->setParent(root);
+        root->addChild(node);
+      }
+      XCTAssertEqual(root->children.size(), 10000U);
+      XCTAssertEqual(root->getText(), std::string(10000, 'a'));
+
+      XCTAssertThrows(tracker.setUseArena(!useArena));
+      tracker.reset();
+    }
+  }
+}
+
+- (void)testParseTreeChildren {
+  CommonToken token(1, "a");
+  tree::ParseTreeTracker tracker;
+  std::vector<tree::ParseTree *> nodes;
+  for (size_t i = 0; i < 10; ++i) {
+    nodes.push_back(tracker.createInstance<tree::TerminalNodeImpl>(&token));
+  }
+
+  tree::ParseTreeChildren children;
+  XCTAssert(children.empty());
+  XCTAssertEqual(sizeof(children), 16U);
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    children.push_back(nodes[i]);
+    XCTAssertEqual(children.size(), i + 1);
+    XCTAssertEqual(children.back(), nodes[i]);
+  }
+  XCTAssert(std::vector<tree::ParseTree *>(children) == nodes);
+
+  // Erase all odd entries.
+  children.erase(std::remove_if(children.begin(), children.end(), [&nodes](tree::ParseTree *node) {
+    return (std::find(nodes.begin(), nodes.end(), node) - nodes.begin()) % 2 == 1;
+  }), children.end());
+  XCTAssertEqual(children.size(), 5U);
+  XCTAssertEqual(children[4], nodes[8]);
+
+  tree::ParseTreeChildren copy = children;
+  children.erase(children.begin() + 1, children.end());
+  children.shrink_to_fit();
+  XCTAssertEqual(children.size(), 1U);
+  XCTAssertEqual(children.capacity(), 1U);
+  XCTAssertEqual(children.front(), nodes[0]);
+  XCTAssertEqual(copy.size(), 5U);
+  XCTAssertEqual(copy[1], nodes[2]);
+
+  children.pop_back();
+  XCTAssert(children.empty());
+  children = { nodes[3], nodes[4] };
+  XCTAssertEqual(children.size(), 2U);
+  XCTAssertEqual(children[1], nodes[4]);
+}
+
+- (void)testChildLookup {
+  CommonToken a(1, "a");
+  CommonToken b(2, "b");
+  tree::ParseTreeTracker tracker;
+  for (size_t count : { 1U, 5U, 1000U }) {
+    // Children alternate between rules 0 and 1 and tokens of type 1 and 2.
+    ParserRuleContext *root = tracker.createInstance<ParserRuleContext>();
+    std::vector<InterpreterRuleContext *> contexts[2];
+    std::vector<tree::TerminalNode *> tokens[2];
+    for (size_t i = 0; i < count; ++i) {
+      contexts[i % 2].push_back(tracker.createInstance<InterpreterRuleContext>(root, 0, i % 2));
+      root->addChild(contexts[i % 2].back());
+      tokens[i % 2].push_back(tracker.createInstance<tree::TerminalNodeImpl>(i % 2 == 0 ? &a : &b));
+      root->addChild(tokens[i % 2].back());
+    }
+
+    for (size_t rule = 0; rule < 3; ++rule) {
+      const std::vector<InterpreterRuleContext *> &expected = rule < 2 ? contexts[rule] : std::vector<InterpreterRuleContext *>();
+      tree::ChildSpan<InterpreterRuleContext> span = root->getRuleContextSpan<InterpreterRuleContext>(rule);
+      XCTAssert(std::vector<InterpreterRuleContext *>(span) == expected);
+      XCTAssert(root->getRuleContexts<InterpreterRuleContext>().size() == contexts[0].size() + contexts[1].size());
+      for (size_t i = 0; i <= expected.size(); ++i) {
+        XCTAssertEqual(root->getRuleContext<InterpreterRuleContext>(rule, i), i < expected.size() ? expected[i] : nullptr);
+      }
+    }
+    for (size_t type = 1; type < 3; ++type) {
+      XCTAssert(root->getTokens(type) == tokens[type - 1]);
+      XCTAssertEqual(root->getToken(type, 0), tokens[type - 1].empty() ? nullptr : tokens[type - 1][0]);
+      XCTAssertEqual(root->getToken(type, count), nullptr);
+    }
+    XCTAssert(root->getTokenSpan(3).empty());
+
+    // Changes to the children are seen by later lookups.
+    tree::TerminalNode *last = tracker.createInstance<tree::TerminalNodeImpl>(&a);
+    root->addChild(last);
+    XCTAssertEqual(root->getTokenSpan(1).back(), last);
+    root->removeLastChild();
+    root->children.erase(root->children.begin());
+    XCTAssertEqual(root->getRuleContextSpan<InterpreterRuleContext>(0).size(), contexts[0].size() - 1);
+  }
+
+  // Spans stay valid while the tree is only read.
+  class CountingVisitor : public tree::AbstractParseTreeVisitor {
+  public:
+    size_t count = 0;
+
+    virtual antlrcpp::Any visitTerminal(tree::TerminalNode * /*node*/) override {
+      ++count;
+      return antlrcpp::Any();
+    }
+  };
+  ParserRuleContext *root = tracker.createInstance<ParserRuleContext>();
+  for (size_t i = 0; i < 100; ++i) {
+    root->addChild(tracker.createInstance<tree::TerminalNodeImpl>(i % 2 == 0 ? &a : &b));
+  }
+  tree::ChildSpan<tree::TerminalNode> span = root->getTokenSpan(1);
+  std::vector<tree::TerminalNode *> expected = span;
+  XCTAssertEqual(root->getText().size(), 100U);
+  CountingVisitor visitor;
+  visitor.visitChildren(root);
+  XCTAssertEqual(visitor.count, 100U);
+  XCTAssert(std::vector<tree::TerminalNode *>(span) == expected);
+  XCTAssert(std::vector<tree::TerminalNode *>(root->getTokenSpan(1)) == expected);
+}
+
+- (void)testMultiListenerWalk {
+  class Recorder : public tree::ParseTreeListener {
+  public:
+    std::string events;
+
+    virtual void visitTerminal(tree::TerminalNode *node) override { events += node->getText(); }
+    virtual void visitErrorNode(tree::ErrorNode *node) override { events += "!" + node->getText(); }
+    virtual void enterEveryRule(ParserRuleContext *ctx) override { events += "(" + std::to_string(ctx->getRuleIndex()); }
+    virtual void exitEveryRule(ParserRuleContext *ctx) override { events += std::to_string(ctx->getRuleIndex()) + ")"; }
+  };
+  class OtherRecorder : public Recorder {
+  public:
+    virtual void visitTerminal(tree::TerminalNode *node) override { events += "<" + node->getText() + ">"; }
+  };
+
+  CommonToken a(1, "a");
+  CommonToken b(2, "b");
+  tree::ParseTreeTracker tracker;
+  InterpreterRuleContext *root = tracker.createInstance<InterpreterRuleContext>(nullptr, 0, 0);
+  for (size_t i = 1; i < 4; ++i) {
+    InterpreterRuleContext *child = tracker.createInstance<InterpreterRuleContext>(root, 0, i);
+    root->addChild(child);
+    child->addChild(tracker.createInstance<tree::TerminalNodeImpl>(&a));
+    root->addChild(tracker.createInstance<tree::ErrorNodeImpl>(&b));
+  }
+
+  Recorder expected1;
+  OtherRecorder expected2;
+  tree::ParseTreeWalker::DEFAULT.walk(&expected1, root);
+  tree::ParseTreeWalker::DEFAULT.walk(&expected2, root);
+  XCTAssertEqual(expected1.events, "(0(1a1)!b(2a2)!b(3a3)!b0)");
+
+  tree::ParseTreeWalker recursiveWalker;
+  for (tree::ParseTreeWalker *walker : { &tree::ParseTreeWalker::DEFAULT, &recursiveWalker }) {
+    Recorder recorder1;
+    OtherRecorder recorder2;
+    walker->walkAll({ &recorder1, &recorder2 }, root);
+    XCTAssertEqual(recorder1.events, expected1.events);
+    XCTAssertEqual(recorder2.events, expected2.events);
+  }
+
+  Recorder recorder1;
+  OtherRecorder recorder2;
+  tree::FusedParseTreeListener<tree::ParseTreeListener, Recorder, OtherRecorder> fused(recorder1, recorder2);
+  tree::ParseTreeWalker::DEFAULT.walk(&fused, root);
+  XCTAssertEqual(recorder1.events, expected1.events);
+  XCTAssertEqual(recorder2.events, expected2.events);
+}
+
+- (void)testParallelWalk {
+  class Recorder : public tree::ParseTreeListener {
+  public:
+    std::string events;
+
+    virtual void visitTerminal(tree::TerminalNode *node) override {
+      if (node->getText() == "!") {
+        throw IllegalStateException("stop");
+      }
+      events += node->getText();
+    }
+    virtual void visitErrorNode(tree::ErrorNode * /*node*/) override { }
+    virtual void enterEveryRule(ParserRuleContext *ctx) override { events += "(" + std::to_string(ctx->getRuleIndex()); }
+    virtual void exitEveryRule(ParserRuleContext * /*ctx*/) override { events += ")"; }
+  };
+  class TextVisitor : public tree::AbstractParseTreeVisitor {
+  public:
+    virtual antlrcpp::Any visitTerminal(tree::TerminalNode *node) override { return node->getText(); }
+  };
+
+  std::vector<CommonToken> tokens;
+  for (size_t i = 0; i < 1000; ++i) {
+    tokens.emplace_back(1, std::to_string(i));
+  }
+  tree::ParseTreeTracker tracker;
+  InterpreterRuleContext *root = tracker.createInstance<InterpreterRuleContext>(nullptr, 0, 0);
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    InterpreterRuleContext *child = tracker.createInstance<InterpreterRuleContext>(root, 0, i % 5);
+    root->addChild(child);
+    child->addChild(tracker.createInstance<tree::TerminalNodeImpl>(&tokens[i]));
+  }
+
+  Recorder expected;
+  tree::ParseTreeWalker::DEFAULT.walk(&expected, root);
+  for (size_t threadCount : { 1U, 3U, 8U }) {
+    tree::ParallelParseTreeWalker walker(threadCount);
+    XCTAssertEqual(walker.getThreadCount(), threadCount);
+
+    // Joining the events of the subtrees in order gives the events of a sequential walk.
+    Recorder recorder;
+    walker.walk(&recorder, root, []() {
+      return std::unique_ptr<tree::ParseTreeListener>(new Recorder());
+    }, [&recorder](tree::ParseTreeListener *fork) {
+      recorder.events += static_cast<Recorder *>(fork)->events;
+    });
+    XCTAssertEqual(recorder.events, expected.events);
+
+    std::vector<antlrcpp::Any> results = walker.visitChildren(root, []() {
+      return std::unique_ptr<tree::ParseTreeVisitor>(new TextVisitor());
+    });
+    XCTAssertEqual(results.size(), tokens.size());
+    XCTAssertEqual(results[123].as<std::string>(), "123");
+
+    // The walker's threads are reused for each walk.
+    for (size_t i = 0; i < 20; ++i) {
+      std::vector<antlrcpp::Any> again = walker.visitChildren(root, []() {
+        return std::unique_ptr<tree::ParseTreeVisitor>(new TextVisitor());
+      });
+      XCTAssertEqual(again[i].as<std::string>(), std::to_string(i));
+    }
+  }
+
+  CommonToken stop(1, "!");
+  static_cast<ParserRuleContext *>(root->children[500])->addChild(tracker.createInstance<tree::TerminalNodeImpl>(&stop));
+  tree::ParallelParseTreeWalker walker(4);
+  Recorder recorder;
+  XCTAssertThrows(walker.walk(&recorder, root, []() {
+    return std::unique_ptr<tree::ParseTreeListener>(new Recorder());
+  }, [](tree::ParseTreeListener * /*fork*/) {
+  }));
+}
+
+- (void)testLexerCharClasses {
+  ANTLRInputStream input("");
+  XPathLexer lexer(&input);
+  const atn::ATN &atn = lexer.getATN();
+  XCTAssert(atn.charClasses != nullptr);
+  const atn::LexerCharClasses &classes = *atn.charClasses;
+  XCTAssertEqual(classes.getClass(Token::EOF), classes.getEOFClass());
+  XCTAssertEqual(classes.getClass(Lexer::MAX_CHAR_VALUE + 1), classes.getOutOfRangeClass());
+
+  // Each transition must match a class exactly if it matches the characters in it.
+  std::vector<size_t> symbols = { Token::EOF, Lexer::MAX_CHAR_VALUE, Lexer::MAX_CHAR_VALUE + 1 };
+  for (size_t symbol = 0; symbol < 0x3000; ++symbol) {
+    symbols.push_back(symbol);
+  }
+  for (size_t symbol = 0x3000; symbol < Lexer::MAX_CHAR_VALUE; symbol += 97) {
+    symbols.push_back(symbol);
+  }
+  for (atn::ATNState *state : atn.states) {
+    for (size_t i = 0; i < state->transitions.size(); ++i) {
+      atn::Transition *transition = state->transitions[i];
+      for (size_t symbol : symbols) {
+        bool expected = !transition->isEpsilon() &&
+          transition->matches(symbol, Lexer::MIN_CHAR_VALUE, Lexer::MAX_CHAR_VALUE);
+        XCTAssertEqual(classes.matches(state->stateNumber, i, classes.getClass(symbol)), expected);
+      }
+    }
+  }
+
+  for (size_t classId = 0; classId < classes.getCharClassCount() + 2; ++classId) {
+    XCTAssertEqual(classes.getClass(classes.getRepresentative(classId)), classId);
+  }
+}
+
 @end
@@ -35,9 +35,9 @@ void ANTLRInputStream::load(const std::string &input) {
   // Remove the UTF-8 BOM if present.
   const char bom[4] = "\xef\xbb\xbf";
   if (input.compare(0, 3, bom, 3) == 0)
-    _data = antlrcpp::utf8_to_utf32(input.data() + 3, input.data() + input.size());
+    _data = UTF8::decode(input.data() + 3, input.data() + input.size(), errorPolicy, replacementCharacter);
   else
-    _data = antlrcpp::utf8_to_utf32(input.data(), input.data() + input.size());
+    _data = UTF8::decode(input.data(), input.data() + input.size(), errorPolicy, replacementCharacter);
   p = 0;
 }
 
@@ -136,7 +136,8 @@ std::string ANTLRInputStream::getText(const Interval &interval) {
     return "";
   }
 
-  return antlrcpp::utf32_to_utf8(_data.substr(start, count));
+  count = std::min(count, _data.size() - start);
+  return UTF8::encode(_data.data() + start, _data.data() + start + count);
 }
 
 std::string ANTLRInputStream::getSourceName() const {
@@ -152,4 +153,6 @@ std::string ANTLRInputStream::toString() const {
 
 void ANTLRInputStream::InitializeInstanceFields() {
   p = 0;
+  errorPolicy = UTF8::ErrorPolicy::Replace;
+  replacementCharacter = UTF8::REPLACEMENT_CHARACTER;
 }
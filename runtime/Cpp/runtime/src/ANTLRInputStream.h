@@ -6,6 +6,7 @@
 #pragma once
 
 #include "CharStream.h"
+#include "support/UTF8.h"
 
 namespace antlr4 {
 
@@ -25,6 +26,10 @@ namespace antlr4 {
     /// What is name or source of this char stream?
     std::string name;
 
+    /// How load() handles invalid UTF-8 input. By default every invalid byte is replaced by replacementCharacter.
+    antlrcpp::UTF8::ErrorPolicy errorPolicy;
+    uint32_t replacementCharacter;
+
     ANTLRInputStream(const std::string &input = "");
     ANTLRInputStream(const char data_[], size_t numberOfActualCharsInArray);
     ANTLRInputStream(std::istream &stream);
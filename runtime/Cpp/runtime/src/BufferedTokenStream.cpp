@@ -4,6 +4,7 @@
  */
 
 #include "WritableToken.h"
+#include "CommonToken.h"
 #include "Lexer.h"
 #include "RuleContext.h"
 #include "misc/Interval.h"
@@ -373,15 +374,15 @@ std::string BufferedTokenStream::getText(const misc::Interval &interval) {
     stop = _tokens.size() - 1;
   }
 
-  std::stringstream ss;
+  std::string result;
   for (size_t i = start; i <= stop; i++) {
     Token *t = _tokens[i].get();
     if (t->getType() == Token::EOF) {
       break;
     }
-    ss << t->getText();
+    CommonToken::appendText(t, result);
   }
-  return ss.str();
+  return result;
 }
 
 std::string BufferedTokenStream::getText(RuleContext *ctx) {
@@ -5,6 +5,7 @@
 
 #include "TokenSource.h"
 #include "CharStream.h"
+#include "UTF8CharStream.h"
 #include "Recognizer.h"
 #include "Vocabulary.h"
 
@@ -45,6 +46,7 @@ CommonToken::CommonToken(size_t type, const std::string &text) {
   _type = type;
   _channel = DEFAULT_CHANNEL;
   _text = text;
+  _hasExplicitText = true;
   _source = EMPTY_SOURCE;
 }
 
@@ -60,9 +62,11 @@ CommonToken::CommonToken(Token *oldToken) {
 
   if (is<CommonToken *>(oldToken)) {
     _text = (static_cast<CommonToken *>(oldToken))->_text;
+    _hasExplicitText = (static_cast<CommonToken *>(oldToken))->_hasExplicitText;
     _source = (static_cast<CommonToken *>(oldToken))->_source;
   } else {
     _text = oldToken->getText();
+    _hasExplicitText = true;
     _source = { oldToken->getTokenSource(), oldToken->getInputStream() };
   }
 }
@@ -76,7 +80,7 @@ void CommonToken::setLine(size_t line) {
 }
 
 std::string CommonToken::getText() const {
-  if (!_text.empty()) {
+  if (_hasExplicitText) {
     return _text;
   }
 
@@ -92,8 +96,47 @@ std::string CommonToken::getText() const {
   }
 }
 
+std::pair<const char *, size_t> CommonToken::getTextView() const {
+  if (_hasExplicitText) {
+    return { _text.data(), _text.size() };
+  }
+
+  CharStream *input = getInputStream();
+  if (input == nullptr) {
+    return { "", 0 };
+  }
+
+  UTF8CharStream *utf8Input = dynamic_cast<UTF8CharStream *>(input);
+  if (utf8Input == nullptr) {
+    return { nullptr, 0 };
+  }
+  size_t n = utf8Input->size();
+  if (_start < n && _stop < n) {
+    return utf8Input->getTextView(misc::Interval(_start, _stop));
+  } else {
+    return { "<EOF>", 5 };
+  }
+}
+
+void CommonToken::appendText(Token *token, std::string &target) {
+  CommonToken *commonToken = dynamic_cast<CommonToken *>(token);
+  if (commonToken != nullptr) {
+    std::pair<const char *, size_t> view = commonToken->getTextView();
+    if (view.first != nullptr) {
+      target.append(view.first, view.second);
+      return;
+    }
+  }
+  target += token->getText();
+}
+
 void CommonToken::setText(const std::string &text) {
   _text = text;
+  _hasExplicitText = true;
+}
+
+bool CommonToken::hasExplicitText() const {
+  return _hasExplicitText;
 }
 
 size_t CommonToken::getLine() const {
@@ -192,4 +235,5 @@ void CommonToken::InitializeInstanceFields() {
   _start = 0;
   _stop = 0;
   _source = EMPTY_SOURCE;
+  _hasExplicitText = false;
 }
@@ -60,6 +60,9 @@ namespace antlr4 {
      */
     std::string _text;
 
+    /// True if _text has been set (even to an empty string), false if the text is taken from the input.
+    bool _hasExplicitText;
+
     /**
      * This is the backing field for {@link #getTokenIndex} and
      * {@link #setTokenIndex}.
@@ -114,17 +117,25 @@ namespace antlr4 {
     virtual size_t getType() const override;
 
     /**
-     * Explicitly set the text for this token. If {code text} is not
-     * {@code null}, then {@link #getText} will return this value rather than
-     * extracting the text from the input.
+     * Explicitly set the text for this token. {@link #getText} will then return
+     * this value (even if it is empty) rather than extracting the text from the input.
      *
-     * @param text The explicit text of the token, or {@code null} if the text
-     * should be obtained from the input along with the start and stop indexes
-     * of the token.
+     * @param text The explicit text of the token.
      */
     virtual void setText(const std::string &text) override;
     virtual std::string getText() const override;
 
+    /// Returns the text of this token without copying it, where possible: explicit text, or text in the memory of a
+    /// UTF8CharStream. The text stays valid until it is changed or the stream is destroyed. For all other char streams
+    /// the result is { nullptr, 0 } and the text must be taken from getText().
+    std::pair<const char *, size_t> getTextView() const;
+
+    /// Appends the text of the given token to target, without a temporary copy if the token provides a text view.
+    static void appendText(Token *token, std::string &target);
+
+    /// Returns true if the text was set explicitly (see setText()), instead of being extracted from the input.
+    bool hasExplicitText() const;
+
     virtual void setLine(size_t line) override;
     virtual size_t getLine() const override;
 
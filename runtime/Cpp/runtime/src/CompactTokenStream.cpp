@@ -0,0 +1,531 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include "CommonToken.h"
+#include "CharStream.h"
+#include "Lexer.h"
+#include "RuleContext.h"
+#include "misc/Interval.h"
+#include "Exceptions.h"
+#include "support/CPPUtils.h"
+#include "support/StringUtils.h"
+
+#include "CompactTokenStream.h"
+
+using namespace antlr4;
+using namespace antlrcpp;
+
+using misc::symbolToNumeric;
+
+// INVALID_INDEX (which is also the value of EOF) is stored as the largest 32-bit value.
+static const uint32_t PACKED_INVALID = 0xFFFFFFFF;
+
+static inline uint32_t pack(size_t value) {
+  if (value == INVALID_INDEX) {
+    return PACKED_INVALID;
+  }
+  if (value >= PACKED_INVALID) {
+    throw IllegalStateException("token value " + std::to_string(value) + " exceeds the 32-bit range of compact tokens");
+  }
+  return static_cast<uint32_t>(value);
+}
+
+static inline size_t unpack(uint32_t value) {
+  return value == PACKED_INVALID ? INVALID_INDEX : value;
+}
+
+//----------------- CompactToken ---------------------------------------------------------------------------------------
+
+CompactToken::CompactToken() : _stream(nullptr), _index(INVALID_INDEX) {
+}
+
+std::string CompactToken::getText() const {
+  return _stream->getTokenText(_index);
+}
+
+size_t CompactToken::getType() const {
+  return _stream->getType(_index);
+}
+
+size_t CompactToken::getLine() const {
+  return _stream->getLine(_index);
+}
+
+size_t CompactToken::getCharPositionInLine() const {
+  return _stream->getCharPositionInLine(_index);
+}
+
+size_t CompactToken::getChannel() const {
+  return _stream->getChannel(_index);
+}
+
+size_t CompactToken::getTokenIndex() const {
+  return _index;
+}
+
+size_t CompactToken::getStartIndex() const {
+  return _stream->getStartIndex(_index);
+}
+
+size_t CompactToken::getStopIndex() const {
+  return _stream->getStopIndex(_index);
+}
+
+TokenSource* CompactToken::getTokenSource() const {
+  return _stream->getTokenSource();
+}
+
+CharStream* CompactToken::getInputStream() const {
+  return _stream->getInputStream();
+}
+
+std::string CompactToken::toString() const {
+  std::stringstream ss;
+
+  std::string channelStr;
+  size_t channel = getChannel();
+  if (channel > 0) {
+    channelStr = ",channel=" + std::to_string(channel);
+  }
+  std::string txt = getText();
+  if (!txt.empty()) {
+    antlrcpp::replaceAll(txt, "\n", "\\n");
+    antlrcpp::replaceAll(txt, "\r", "\\r");
+    antlrcpp::replaceAll(txt, "\t", "\\t");
+  } else {
+    txt = "<no text>";
+  }
+
+  ss << "[@" << symbolToNumeric(_index) << "," << symbolToNumeric(getStartIndex()) << ":"
+    << symbolToNumeric(getStopIndex()) << "='" << txt << "',<" << symbolToNumeric(getType()) << ">" << channelStr << ","
+    << getLine() << ":" << getCharPositionInLine() << "]";
+
+  return ss.str();
+}
+
+//----------------- CompactTokenStream ---------------------------------------------------------------------------------
+
+CompactTokenStream::CompactTokenStream(TokenSource *tokenSource)
+  : CompactTokenStream(tokenSource, Token::DEFAULT_CHANNEL) {
+}
+
+CompactTokenStream::CompactTokenStream(TokenSource *tokenSource, size_t channel)
+  : _tokenSource(tokenSource), _input(nullptr), _channel(channel), _p(0), _fetchedEOF(false), _needSetup(true) {
+}
+
+TokenSource* CompactTokenStream::getTokenSource() const {
+  return _tokenSource;
+}
+
+size_t CompactTokenStream::index() {
+  return _p;
+}
+
+ssize_t CompactTokenStream::mark() {
+  return 0;
+}
+
+void CompactTokenStream::release(ssize_t /*marker*/) {
+  // no resources to release
+}
+
+void CompactTokenStream::reset() {
+  seek(0);
+}
+
+void CompactTokenStream::seek(size_t index) {
+  lazyInit();
+  _p = nextTokenOnChannel(index, _channel);
+}
+
+size_t CompactTokenStream::size() {
+  return _types.size();
+}
+
+void CompactTokenStream::consume() {
+  bool skipEofCheck = false;
+  if (!_needSetup) {
+    if (_fetchedEOF) {
+      // The last token is EOF. Skip the check if p indexes any fetched token except the last.
+      skipEofCheck = _p < _types.size() - 1;
+    } else {
+      // No EOF token yet. Skip the check if p indexes a fetched token.
+      skipEofCheck = _p < _types.size();
+    }
+  }
+
+  if (!skipEofCheck && LA(1) == Token::EOF) {
+    throw IllegalStateException("cannot consume EOF");
+  }
+
+  if (sync(_p + 1)) {
+    _p = nextTokenOnChannel(_p + 1, _channel);
+  }
+}
+
+size_t CompactTokenStream::LA(ssize_t i) {
+  Token *token = LT(i);
+  return token == nullptr ? Token::INVALID_TYPE : token->getType();
+}
+
+Token* CompactTokenStream::LT(ssize_t k) {
+  lazyInit();
+  if (k == 0) {
+    return nullptr;
+  }
+  if (k < 0) {
+    return LB(static_cast<size_t>(-k));
+  }
+
+  size_t i = _p;
+  ssize_t n = 1; // We know tokens[p] is a good one.
+  while (n < k) {
+    // Skip off-channel tokens, but make sure to not look past EOF.
+    if (sync(i + 1)) {
+      i = nextTokenOnChannel(i + 1, _channel);
+    }
+    n++;
+  }
+
+  return handle(i);
+}
+
+Token* CompactTokenStream::LB(size_t k) {
+  if (k == 0 || k > _p) {
+    return nullptr;
+  }
+
+  ssize_t i = static_cast<ssize_t>(_p);
+  size_t n = 1;
+  // Find k good tokens looking backwards.
+  while (n <= k) {
+    if (i == 0) {
+      return nullptr;
+    }
+    i = previousTokenOnChannel(i - 1, _channel);
+    n++;
+  }
+  if (i < 0) {
+    return nullptr;
+  }
+
+  return handle(i);
+}
+
+Token* CompactTokenStream::get(size_t i) const {
+  if (i >= _types.size()) {
+    throw IndexOutOfBoundsException(std::string("token index ") + std::to_string(i) + std::string(" out of range 0..") +
+                                    std::to_string(_types.size() - 1));
+  }
+  return handle(i);
+}
+
+void CompactTokenStream::setTokenSource(TokenSource *tokenSource) {
+  _tokenSource = tokenSource;
+  _input = nullptr;
+  _types.clear();
+  _channels.clear();
+  _starts.clear();
+  _stops.clear();
+  _lines.clear();
+  _columns.clear();
+  _texts.clear();
+  _handles.clear();
+  _p = 0;
+  _fetchedEOF = false;
+  _needSetup = true;
+}
+
+void CompactTokenStream::fill() {
+  lazyInit();
+  const size_t blockSize = 1000;
+  while (true) {
+    size_t fetched = fetch(blockSize);
+    if (fetched < blockSize) {
+      return;
+    }
+  }
+}
+
+size_t CompactTokenStream::getNumberOfOnChannelTokens() {
+  size_t n = 0;
+  fill();
+  for (size_t i = 0; i < _types.size(); i++) {
+    if (getChannel(i) == _channel) {
+      n++;
+    }
+    if (getType(i) == Token::EOF) {
+      break;
+    }
+  }
+  return n;
+}
+
+std::vector<Token *> CompactTokenStream::getHiddenTokensToRight(size_t tokenIndex, ssize_t channel) {
+  lazyInit();
+  if (tokenIndex >= _types.size()) {
+    throw IndexOutOfBoundsException(std::to_string(tokenIndex) + " not in 0.." + std::to_string(_types.size() - 1));
+  }
+
+  ssize_t nextOnChannel = nextTokenOnChannel(tokenIndex + 1, Lexer::DEFAULT_TOKEN_CHANNEL);
+  size_t to;
+  size_t from = tokenIndex + 1;
+  // If none onchannel to right, nextOnChannel=-1 so set to = last token.
+  if (nextOnChannel == -1) {
+    to = size() - 1;
+  } else {
+    to = static_cast<size_t>(nextOnChannel);
+  }
+
+  return filterForChannel(from, to, channel);
+}
+
+std::vector<Token *> CompactTokenStream::getHiddenTokensToLeft(size_t tokenIndex, ssize_t channel) {
+  lazyInit();
+  if (tokenIndex >= _types.size()) {
+    throw IndexOutOfBoundsException(std::to_string(tokenIndex) + " not in 0.." + std::to_string(_types.size() - 1));
+  }
+
+  if (tokenIndex == 0) {
+    // Obviously no tokens can appear before the first token.
+    return { };
+  }
+
+  ssize_t prevOnChannel = previousTokenOnChannel(tokenIndex - 1, Lexer::DEFAULT_TOKEN_CHANNEL);
+  if (prevOnChannel == static_cast<ssize_t>(tokenIndex - 1)) {
+    return { };
+  }
+  // If none onchannel to left, prevOnChannel=-1 then from=0.
+  size_t from = static_cast<size_t>(prevOnChannel + 1);
+  size_t to = tokenIndex - 1;
+
+  return filterForChannel(from, to, channel);
+}
+
+std::string CompactTokenStream::getSourceName() const {
+  return _tokenSource->getSourceName();
+}
+
+std::string CompactTokenStream::getText() {
+  return getText(misc::Interval(0U, size() - 1));
+}
+
+std::string CompactTokenStream::getText(const misc::Interval &interval) {
+  lazyInit();
+  fill();
+  size_t start = interval.a;
+  size_t stop = interval.b;
+  if (start == INVALID_INDEX || stop == INVALID_INDEX) {
+    return "";
+  }
+  if (stop >= _types.size()) {
+    stop = _types.size() - 1;
+  }
+
+  std::string result;
+  for (size_t i = start; i <= stop; i++) {
+    if (getType(i) == Token::EOF) {
+      break;
+    }
+    result += getTokenText(i);
+  }
+  return result;
+}
+
+std::string CompactTokenStream::getText(RuleContext *ctx) {
+  return getText(ctx->getSourceInterval());
+}
+
+std::string CompactTokenStream::getText(Token *start, Token *stop) {
+  if (start != nullptr && stop != nullptr) {
+    return getText(misc::Interval(start->getTokenIndex(), stop->getTokenIndex()));
+  }
+
+  return "";
+}
+
+size_t CompactTokenStream::getType(size_t i) const {
+  return unpack(_types[i]);
+}
+
+size_t CompactTokenStream::getChannel(size_t i) const {
+  return unpack(_channels[i]);
+}
+
+size_t CompactTokenStream::getStartIndex(size_t i) const {
+  return unpack(_starts[i]);
+}
+
+size_t CompactTokenStream::getStopIndex(size_t i) const {
+  return unpack(_stops[i]);
+}
+
+size_t CompactTokenStream::getLine(size_t i) const {
+  return unpack(_lines[i]);
+}
+
+size_t CompactTokenStream::getCharPositionInLine(size_t i) const {
+  return unpack(_columns[i]);
+}
+
+std::string CompactTokenStream::getTokenText(size_t i) const {
+  if (!_texts.empty()) {
+    auto iterator = _texts.find(i);
+    if (iterator != _texts.end()) {
+      return iterator->second;
+    }
+  }
+
+  // Same as CommonToken::getText().
+  if (_input == nullptr) {
+    return "";
+  }
+  size_t n = _input->size();
+  size_t start = getStartIndex(i);
+  size_t stop = getStopIndex(i);
+  if (start < n && stop < n) {
+    return _input->getText(misc::Interval(start, stop));
+  } else {
+    return "<EOF>";
+  }
+}
+
+CharStream* CompactTokenStream::getInputStream() const {
+  return _input;
+}
+
+bool CompactTokenStream::sync(size_t i) {
+  if (i + 1 < _types.size()) {
+    return true;
+  }
+  size_t n = i - _types.size() + 1; // How many more elements do we need?
+
+  if (n > 0) {
+    size_t fetched = fetch(n);
+    return fetched >= n;
+  }
+
+  return true;
+}
+
+size_t CompactTokenStream::fetch(size_t n) {
+  if (_fetchedEOF) {
+    return 0;
+  }
+
+  size_t i = 0;
+  while (i < n) {
+    std::unique_ptr<Token> t(_tokenSource->nextToken());
+    add(t.get());
+    ++i;
+
+    if (t->getType() == Token::EOF) {
+      _fetchedEOF = true;
+      break;
+    }
+  }
+
+  return i;
+}
+
+void CompactTokenStream::add(Token *token) {
+  size_t index = _types.size();
+  if (index == 0) {
+    _input = token->getInputStream();
+  }
+
+  _types.push_back(pack(token->getType()));
+  _channels.push_back(pack(token->getChannel()));
+  _starts.push_back(pack(token->getStartIndex()));
+  _stops.push_back(pack(token->getStopIndex()));
+  _lines.push_back(pack(token->getLine()));
+  _columns.push_back(pack(token->getCharPositionInLine()));
+
+  // Keep the text only if it cannot be taken from the input later.
+  bool explicitText = true;
+  if (token->getInputStream() == _input && is<CommonToken *>(token)) {
+    explicitText = static_cast<CommonToken *>(token)->hasExplicitText();
+  }
+  if (explicitText) {
+    _texts[index] = token->getText();
+  }
+}
+
+void CompactTokenStream::lazyInit() {
+  if (_needSetup) {
+    _needSetup = false;
+    sync(0);
+    _p = nextTokenOnChannel(0, _channel);
+  }
+}
+
+CompactToken* CompactTokenStream::handle(size_t i) const {
+  size_t block = i / HANDLE_BLOCK_SIZE;
+  if (block >= _handles.size()) {
+    _handles.resize(block + 1);
+  }
+
+  if (!_handles[block]) {
+    _handles[block].reset(new CompactToken[HANDLE_BLOCK_SIZE]);
+    for (size_t j = 0; j < HANDLE_BLOCK_SIZE; ++j) {
+      _handles[block][j]._stream = this;
+      _handles[block][j]._index = block * HANDLE_BLOCK_SIZE + j;
+    }
+  }
+
+  return &_handles[block][i % HANDLE_BLOCK_SIZE];
+}
+
+ssize_t CompactTokenStream::nextTokenOnChannel(size_t i, size_t channel) {
+  sync(i);
+  if (i >= size()) {
+    return static_cast<ssize_t>(size() - 1);
+  }
+
+  while (getChannel(i) != channel) {
+    if (getType(i) == Token::EOF) {
+      return static_cast<ssize_t>(i);
+    }
+    i++;
+    sync(i);
+  }
+  return static_cast<ssize_t>(i);
+}
+
+ssize_t CompactTokenStream::previousTokenOnChannel(size_t i, size_t channel) {
+  sync(i);
+  if (i >= size()) {
+    // The EOF token is on every channel.
+    return static_cast<ssize_t>(size() - 1);
+  }
+
+  while (true) {
+    if (getType(i) == Token::EOF || getChannel(i) == channel) {
+      return static_cast<ssize_t>(i);
+    }
+
+    if (i == 0)
+      break;
+    i--;
+  }
+  return static_cast<ssize_t>(i);
+}
+
+std::vector<Token *> CompactTokenStream::filterForChannel(size_t from, size_t to, ssize_t channel) {
+  std::vector<Token *> hidden;
+  for (size_t i = from; i <= to; i++) {
+    if (channel == -1) {
+      if (getChannel(i) != Lexer::DEFAULT_TOKEN_CHANNEL) {
+        hidden.push_back(handle(i));
+      }
+    } else {
+      if (getChannel(i) == static_cast<size_t>(channel)) {
+        hidden.push_back(handle(i));
+      }
+    }
+  }
+
+  return hidden;
+}
@@ -0,0 +1,146 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include "TokenStream.h"
+
+namespace antlr4 {
+
+  class CompactTokenStream;
+
+  /// A read-only token handle which refers to a token stored in a CompactTokenStream. Handles are owned by the stream
+  /// and stay valid as long as the stream exists (and is not reset via setTokenSource()).
+  class ANTLR4CPP_PUBLIC CompactToken : public Token {
+  public:
+    CompactToken();
+
+    virtual std::string getText() const override;
+    virtual size_t getType() const override;
+    virtual size_t getLine() const override;
+    virtual size_t getCharPositionInLine() const override;
+    virtual size_t getChannel() const override;
+    virtual size_t getTokenIndex() const override;
+    virtual size_t getStartIndex() const override;
+    virtual size_t getStopIndex() const override;
+    virtual TokenSource *getTokenSource() const override;
+    virtual CharStream *getInputStream() const override;
+    virtual std::string toString() const override;
+
+  private:
+    friend class CompactTokenStream;
+
+    const CompactTokenStream *_stream;
+    size_t _index;
+  };
+
+  /// A token stream with the same behavior as CommonTokenStream (including the channel filtering of the lookahead
+  /// methods), which stores its tokens column wise instead of as individual Token objects.
+  ///
+  /// Type, channel, start, stop, line and column of each token are kept in arrays of 32-bit values (24 bytes per
+  /// token), the text is extracted from the input stream when requested. Only tokens with explicitly set text (e.g. by
+  /// a lexer action) store their text. The tokens from the token source are released right after they have been
+  /// added to the columns.
+  ///
+  /// Token objects (see CompactToken) are created only when requested via get() or LT(), in blocks of
+  /// HANDLE_BLOCK_SIZE, so code which only needs single fields should use the column accessors (getType(i) etc.).
+  ///
+  /// Limitations: all values (including char indices and line numbers) must fit into 32 bits and the input stream
+  /// must be able to return the text of any token for as long as the stream is used.
+  class ANTLR4CPP_PUBLIC CompactTokenStream : public TokenStream {
+  public:
+    static const size_t HANDLE_BLOCK_SIZE = 1024;
+
+    /// Creates a stream whose lookahead methods return tokens on the default channel (and EOF).
+    CompactTokenStream(TokenSource *tokenSource);
+
+    /// Creates a stream whose lookahead methods return tokens on the given channel (and EOF).
+    CompactTokenStream(TokenSource *tokenSource, size_t channel);
+
+    CompactTokenStream(const CompactTokenStream& other) = delete;
+    CompactTokenStream& operator = (const CompactTokenStream& other) = delete;
+
+    virtual TokenSource* getTokenSource() const override;
+    virtual size_t index() override;
+    virtual ssize_t mark() override;
+    virtual void release(ssize_t marker) override;
+    virtual void reset();
+    virtual void seek(size_t index) override;
+    virtual size_t size() override;
+    virtual void consume() override;
+
+    virtual size_t LA(ssize_t i) override;
+    virtual Token* LT(ssize_t k) override;
+    virtual Token* get(size_t i) const override;
+
+    virtual void setTokenSource(TokenSource *tokenSource);
+
+    /// Fetches all tokens from the token source.
+    virtual void fill();
+
+    /// Count EOF just once.
+    virtual size_t getNumberOfOnChannelTokens();
+
+    /// Returns the off channel tokens (or the tokens on the given channel) between the given token and the next on
+    /// channel token to its right (channel -1) or to its left.
+    virtual std::vector<Token *> getHiddenTokensToRight(size_t tokenIndex, ssize_t channel = -1);
+    virtual std::vector<Token *> getHiddenTokensToLeft(size_t tokenIndex, ssize_t channel = -1);
+
+    virtual std::string getSourceName() const override;
+    virtual std::string getText() override;
+    virtual std::string getText(const misc::Interval &interval) override;
+    virtual std::string getText(RuleContext *ctx) override;
+    virtual std::string getText(Token *start, Token *stop) override;
+
+    // Direct access to the fields of fetched tokens, without creating a token handle.
+    size_t getType(size_t i) const;
+    size_t getChannel(size_t i) const;
+    size_t getStartIndex(size_t i) const;
+    size_t getStopIndex(size_t i) const;
+    size_t getLine(size_t i) const;
+    size_t getCharPositionInLine(size_t i) const;
+    std::string getTokenText(size_t i) const;
+
+    /// The input stream the token text is taken from (the input of the first token).
+    CharStream* getInputStream() const;
+
+  protected:
+    TokenSource *_tokenSource;
+    CharStream *_input;
+    size_t _channel;
+
+    // The token columns.
+    std::vector<uint32_t> _types;
+    std::vector<uint32_t> _channels;
+    std::vector<uint32_t> _starts;
+    std::vector<uint32_t> _stops;
+    std::vector<uint32_t> _lines;
+    std::vector<uint32_t> _columns;
+
+    /// The text of tokens which did not take it from the input stream.
+    std::unordered_map<size_t, std::string> _texts;
+
+    mutable std::vector<std::unique_ptr<CompactToken[]>> _handles;
+
+    size_t _p;
+    bool _fetchedEOF;
+    bool _needSetup;
+
+    virtual bool sync(size_t i);
+    virtual size_t fetch(size_t n);
+
+    /// Appends the given token to the columns.
+    virtual void add(Token *token);
+
+    void lazyInit();
+    Token* LB(size_t k);
+    CompactToken* handle(size_t i) const;
+
+    ssize_t nextTokenOnChannel(size_t i, size_t channel);
+    ssize_t previousTokenOnChannel(size_t i, size_t channel);
+    std::vector<Token *> filterForChannel(size_t from, size_t to, ssize_t channel);
+  };
+
+} // namespace antlr4
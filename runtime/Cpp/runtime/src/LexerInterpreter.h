@@ -6,7 +6,7 @@
 #pragma once
 
 #include "Lexer.h"
-#include "atn/PredictionContext.h"
+#include "atn/PredictionContextCache.h"
 #include "Vocabulary.h"
 
 namespace antlr4 {
@@ -0,0 +1,91 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include "Exceptions.h"
+#include "support/StringUtils.h"
+
+#include "MappedFileStream.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace antlr4;
+
+MappedFileStream::MappedFileStream(const std::string &fileName)
+  : _fileName(fileName), _mapping(nullptr), _mappedSize(0) {
+
+#ifdef _WIN32
+  HANDLE file = CreateFileW(antlrcpp::s2ws(fileName).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+    FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    throw IOException("Cannot open file " + fileName);
+  }
+
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(file, &fileSize)) {
+    CloseHandle(file);
+    throw IOException("Cannot determine the size of file " + fileName);
+  }
+  _mappedSize = static_cast<size_t>(fileSize.QuadPart);
+
+  if (_mappedSize > 0) { // Empty files cannot be mapped.
+    HANDLE mappingObject = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingObject != nullptr) {
+      _mapping = MapViewOfFile(mappingObject, FILE_MAP_READ, 0, 0, 0);
+      CloseHandle(mappingObject); // The view keeps the mapping alive.
+    }
+  }
+  CloseHandle(file);
+#else
+  int file = open(fileName.c_str(), O_RDONLY);
+  if (file < 0) {
+    throw IOException("Cannot open file " + fileName);
+  }
+
+  struct stat fileInfo;
+  if (fstat(file, &fileInfo) != 0) {
+    close(file);
+    throw IOException("Cannot determine the size of file " + fileName);
+  }
+  _mappedSize = static_cast<size_t>(fileInfo.st_size);
+
+  if (_mappedSize > 0) { // Empty files cannot be mapped.
+    void *mapping = mmap(nullptr, _mappedSize, PROT_READ, MAP_PRIVATE, file, 0);
+    if (mapping != MAP_FAILED) {
+      _mapping = mapping;
+#ifdef MADV_SEQUENTIAL
+      madvise(_mapping, _mappedSize, MADV_SEQUENTIAL); // Lexing reads the file front to back.
+#endif
+    }
+  }
+  close(file); // The mapping stays valid.
+#endif
+
+  if (_mappedSize > 0 && _mapping == nullptr) {
+    throw IOException("Cannot map file " + fileName);
+  }
+
+  setData(static_cast<const char *>(_mapping), _mappedSize);
+}
+
+MappedFileStream::~MappedFileStream() {
+  if (_mapping != nullptr) {
+#ifdef _WIN32
+    UnmapViewOfFile(_mapping);
+#else
+    munmap(_mapping, _mappedSize);
+#endif
+  }
+}
+
+std::string MappedFileStream::getSourceName() const {
+  return _fileName;
+}
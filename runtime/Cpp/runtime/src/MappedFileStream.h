@@ -0,0 +1,34 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include "UTF8CharStream.h"
+
+namespace antlr4 {
+
+  /// A UTF8CharStream which maps a file into memory instead of reading it. Only the pages touched by the
+  /// lexer are loaded, and no copy of the input is made, so even very large inputs can be lexed with little memory.
+  /// Throws an IOException if the file cannot be opened or mapped.
+  class ANTLR4CPP_PUBLIC MappedFileStream : public UTF8CharStream {
+  public:
+    // Assumes a file name encoded in UTF-8 and file content in the same encoding (with or w/o BOM).
+    MappedFileStream(const std::string &fileName);
+    MappedFileStream(const MappedFileStream &other) = delete;
+    virtual ~MappedFileStream();
+
+    MappedFileStream& operator = (const MappedFileStream &other) = delete;
+
+    virtual std::string getSourceName() const override;
+
+  protected:
+    std::string _fileName; // UTF-8 encoded file name.
+
+  private:
+    void *_mapping;
+    size_t _mappedSize;
+  };
+
+} // namespace antlr4
@@ -328,7 +328,7 @@ void Parser::addContextToParseTree() {
   if (_ctx->parent == nullptr)
     return;
 
-  ParserRuleContext *parent = dynamic_cast<ParserRuleContext *>(_ctx->parent);
+  ParserRuleContext *parent = static_cast<ParserRuleContext *>(_ctx->parent);
   parent->addChild(_ctx);
 }
 
@@ -357,7 +357,7 @@ void Parser::exitRule() {
     triggerExitRuleEvent();
   }
   setState(_ctx->invokingState);
-  _ctx = dynamic_cast<ParserRuleContext *>(_ctx->parent);
+  _ctx = static_cast<ParserRuleContext *>(_ctx->parent);
 }
 
 void Parser::enterOuterAlt(ParserRuleContext *localctx, size_t altNum) {
@@ -367,7 +367,7 @@ void Parser::enterOuterAlt(ParserRuleContext *localctx, size_t altNum) {
   // that is previous child of parse tree
   if (_buildParseTrees && _ctx != localctx) {
     if (_ctx->parent != nullptr) {
-      ParserRuleContext *parent = dynamic_cast<ParserRuleContext *>(_ctx->parent);
+      ParserRuleContext *parent = static_cast<ParserRuleContext *>(_ctx->parent);
       parent->removeLastChild();
       parent->addChild(localctx);
     }
@@ -423,7 +423,7 @@ void Parser::unrollRecursionContexts(ParserRuleContext *parentctx) {
   if (_parseListeners.size() > 0) {
     while (_ctx != parentctx) {
       triggerExitRuleEvent();
-      _ctx = dynamic_cast<ParserRuleContext *>(_ctx->parent);
+      _ctx = static_cast<ParserRuleContext *>(_ctx->parent);
     }
   } else {
     _ctx = parentctx;
@@ -446,7 +446,7 @@ ParserRuleContext* Parser::getInvokingContext(size_t ruleIndex) {
     }
     if (p->parent == nullptr)
       break;
-    p = dynamic_cast<ParserRuleContext *>(p->parent);
+    p = static_cast<ParserRuleContext *>(p->parent);
   }
   return nullptr;
 }
@@ -490,7 +490,7 @@ bool Parser::isExpectedToken(size_t symbol) {
       return true;
     }
 
-    ctx = dynamic_cast<ParserRuleContext *>(ctx->parent);
+    ctx = static_cast<ParserRuleContext *>(ctx->parent);
   }
 
   if (following.contains(Token::EPSILON) && symbol == EOF) {
@@ -545,7 +545,7 @@ std::vector<std::string> Parser::getRuleInvocationStack(RuleContext *p) {
     }
     if (p->parent == nullptr)
       break;
-    run = dynamic_cast<RuleContext *>(run->parent);
+    run = static_cast<RuleContext *>(run->parent);
   }
   return stack;
 }
@@ -161,16 +161,16 @@ atn::ATNState* ParserInterpreter::getATNState() {
 
 void ParserInterpreter::visitState(atn::ATNState *p) {
   size_t predictedAlt = 1;
-  if (is<DecisionState *>(p)) {
-    predictedAlt = visitDecisionState(dynamic_cast<DecisionState *>(p));
+  if (p->isDecisionState()) {
+    predictedAlt = visitDecisionState(static_cast<DecisionState *>(p));
   }
 
   atn::Transition *transition = p->transitions[predictedAlt - 1];
   switch (transition->getSerializationType()) {
     case atn::Transition::EPSILON:
       if (p->getStateType() == ATNState::STAR_LOOP_ENTRY &&
-        (dynamic_cast<StarLoopEntryState *>(p))->isPrecedenceDecision &&
-        !is<LoopEndState *>(transition->target)) {
+        (static_cast<StarLoopEntryState *>(p))->isPrecedenceDecision &&
+        transition->target->getStateType() != ATNState::LOOP_END) {
         // We are at the start of a left recursive rule's (...)* loop
         // and we're not taking the exit branch of loop.
         InterpreterRuleContext *localctx = createInterpreterRuleContext(_parentContextStack.top().first,
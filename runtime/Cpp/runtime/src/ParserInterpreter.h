@@ -8,7 +8,7 @@
 #include "Parser.h"
 #include "atn/ATN.h"
 #include "support/BitSet.h"
-#include "atn/PredictionContext.h"
+#include "atn/PredictionContextCache.h"
 #include "Vocabulary.h"
 
 namespace antlr4 {
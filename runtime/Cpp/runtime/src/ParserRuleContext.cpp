@@ -39,8 +39,8 @@ void ParserRuleContext::copyFrom(ParserRuleContext *ctx) {
   // copy any error nodes to alt label node
   if (!ctx->children.empty()) {
     for (auto child : ctx->children) {
-      auto errorNode = dynamic_cast<ErrorNode *>(child);
-      if (errorNode != nullptr) {
+      if (child->isErrorNode()) {
+        auto errorNode = dynamic_cast<ErrorNode *>(child);
         errorNode->setParent(this);
         children.push_back(errorNode);
       }
@@ -81,35 +81,15 @@ tree::TerminalNode* ParserRuleContext::getToken(size_t ttype, size_t i) {
     return nullptr;
   }
 
-  size_t j = 0; // what token with ttype have we found?
-  for (auto o : children) {
-    if (is<tree::TerminalNode *>(o)) {
-      tree::TerminalNode *tnode = dynamic_cast<tree::TerminalNode *>(o);
-      Token *symbol = tnode->getSymbol();
-      if (symbol->getType() == ttype) {
-        if (j++ == i) {
-          return tnode;
-        }
-      }
-    }
-  }
-
-  return nullptr;
+  return static_cast<tree::TerminalNode *>(children.findToken(ttype, i));
 }
 
 std::vector<tree::TerminalNode *> ParserRuleContext::getTokens(size_t ttype) {
-  std::vector<tree::TerminalNode *> tokens;
-  for (auto &o : children) {
-    if (is<tree::TerminalNode *>(o)) {
-      tree::TerminalNode *tnode = dynamic_cast<tree::TerminalNode *>(o);
-      Token *symbol = tnode->getSymbol();
-      if (symbol->getType() == ttype) {
-        tokens.push_back(tnode);
-      }
-    }
-  }
+  return getTokenSpan(ttype);
+}
 
-  return tokens;
+tree::ChildSpan<tree::TerminalNode> ParserRuleContext::getTokenSpan(size_t ttype) const {
+  return children.findTokens(ttype);
 }
 
 misc::Interval ParserRuleContext::getSourceInterval() {
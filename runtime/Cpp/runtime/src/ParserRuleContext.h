@@ -94,6 +94,9 @@ namespace antlr4 {
 
     virtual std::vector<tree::TerminalNode *> getTokens(size_t ttype);
 
+    /// Like getTokens(), but without copying the nodes. The span is valid until the children change.
+    tree::ChildSpan<tree::TerminalNode> getTokenSpan(size_t ttype) const;
+
     template<typename T>
     T* getRuleContext(size_t i) {
       if (children.empty()) {
@@ -101,11 +104,13 @@ namespace antlr4 {
       }
 
       size_t j = 0; // what element have we found with ctxType?
-      for (auto &child : children) {
-        if (antlrcpp::is<T *>(child)) {
-          if (j++ == i) {
-            return dynamic_cast<T *>(child);
-          }
+      for (auto child : children) {
+        if (std::is_base_of<RuleContext, T>::value && child->isTerminalNode()) {
+          continue; // Saves the dynamic_cast for tokens.
+        }
+        T *context = dynamic_cast<T *>(child);
+        if (context != nullptr && j++ == i) {
+          return context;
         }
       }
       return nullptr;
@@ -115,14 +120,33 @@ namespace antlr4 {
     std::vector<T *> getRuleContexts() {
       std::vector<T *> contexts;
       for (auto child : children) {
-        if (antlrcpp::is<T *>(child)) {
-          contexts.push_back(dynamic_cast<T *>(child));
+        if (std::is_base_of<RuleContext, T>::value && child->isTerminalNode()) {
+          continue; // Saves the dynamic_cast for tokens.
+        }
+        T *context = dynamic_cast<T *>(child);
+        if (context != nullptr) {
+          contexts.push_back(context);
         }
       }
 
       return contexts;
     }
 
+    /// Returns the i-th child context of the rule with the given index, or null if there is none. Unlike
+    /// getRuleContext<T>(i) this needs neither a type check nor a scan of all children (for larger nodes),
+    /// but the caller must make sure that T is the context class of the rule (as generated code does).
+    template<typename T>
+    T* getRuleContext(size_t ruleIndex, size_t i) const {
+      return static_cast<T *>(children.findRuleContext(ruleIndex, i));
+    }
+
+    /// Returns the child contexts of the rule with the given index, see getRuleContext(size_t, size_t).
+    /// The span is valid until the children change.
+    template<typename T>
+    tree::ChildSpan<T> getRuleContextSpan(size_t ruleIndex) const {
+      return children.findRuleContexts(ruleIndex);
+    }
+
     virtual misc::Interval getSourceInterval() override;
 
     /**
@@ -9,6 +9,8 @@
 #include "atn/ATN.h"
 #include "atn/ATNState.h"
 #include "tree/ParseTreeVisitor.h"
+#include "tree/TerminalNode.h"
+#include "CommonToken.h"
 
 #include "RuleContext.h"
 
@@ -50,14 +52,20 @@ std::string RuleContext::getText() {
     return "";
   }
 
-  std::stringstream ss;
+  std::string result;
   for (size_t i = 0; i < children.size(); i++) {
     ParseTree *tree = children[i];
-    if (tree != nullptr)
-      ss << tree->getText();
+    if (tree == nullptr) {
+      continue;
+    }
+    if (tree->isTerminalNode()) {
+      CommonToken::appendText(static_cast<tree::TerminalNode *>(tree)->getSymbol(), result);
+    } else {
+      result += tree->getText();
+    }
   }
 
-  return ss.str();
+  return result;
 }
 
 size_t RuleContext::getRuleIndex() const {
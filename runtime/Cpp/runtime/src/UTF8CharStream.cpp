@@ -0,0 +1,285 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include "Exceptions.h"
+#include "misc/Interval.h"
+#include "support/UTF8.h"
+
+#include "UTF8CharStream.h"
+
+#include <string.h>
+
+using namespace antlr4;
+
+using antlrcpp::UTF8;
+using misc::Interval;
+
+static const size_t MAX_STEP_BACK = 8; // Longer backward seeks use the checkpoints.
+
+static inline bool isContinuation(unsigned char c) {
+  return (c & 0xC0) == 0x80;
+}
+
+// Invalid or truncated sequences yield U+FFFD and a length of 1.
+static inline size_t decode(const unsigned char *data, size_t available, size_t &length) {
+  uint32_t result = UTF8::decodeCodePoint(data, available, length);
+  return result == UTF8::INVALID ? UTF8::REPLACEMENT_CHARACTER : result;
+}
+
+static bool isAsciiOnly(const char *data, size_t length) {
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data + i, sizeof(word));
+    if ((word & 0x8080808080808080ULL) != 0) {
+      return false;
+    }
+  }
+  for (; i < length; ++i) {
+    if ((unsigned char)data[i] >= 0x80) {
+      return false;
+    }
+  }
+  return true;
+}
+
+UTF8CharStream::UTF8CharStream() {
+  setData(nullptr, 0);
+}
+
+UTF8CharStream::UTF8CharStream(const char *data, size_t length) {
+  setData(data, length);
+}
+
+void UTF8CharStream::setData(const char *data, size_t length) {
+  // Remove the UTF-8 BOM if present.
+  if (length >= 3 && memcmp(data, "\xef\xbb\xbf", 3) == 0) {
+    data += 3;
+    length -= 3;
+  }
+
+  _data = data;
+  _length = length;
+  _index = 0;
+  _offset = 0;
+  _lastIndex = 0;
+  _lastOffset = 0;
+  _checkpoints.clear();
+
+  _isAscii = isAsciiOnly(data, length);
+  if (_isAscii) {
+    _size = length;
+    return;
+  }
+
+  const unsigned char *bytes = reinterpret_cast<const unsigned char *>(_data);
+  size_t offset = 0;
+  size_t count = 0;
+  while (offset < _length) {
+    if (count % CHECKPOINT_INTERVAL == 0) {
+      _checkpoints.push_back(offset);
+    }
+
+    // ASCII runs are scanned without decoding, up to the next checkpoint.
+    size_t limit = std::min(_length, offset + CHECKPOINT_INTERVAL - count % CHECKPOINT_INTERVAL);
+    while (offset < limit && bytes[offset] < 0x80) {
+      ++offset;
+      ++count;
+    }
+
+    if (offset < limit) {
+      size_t length;
+      decode(bytes + offset, _length - offset, length);
+      offset += length;
+      ++count;
+    }
+  }
+  _size = count;
+}
+
+void UTF8CharStream::consume() {
+  if (_index >= _size) {
+    assert(LA(1) == IntStream::EOF);
+    throw IllegalStateException("cannot consume EOF");
+  }
+
+  if (_isAscii) {
+    ++_offset;
+  } else {
+    size_t length;
+    decode(reinterpret_cast<const unsigned char *>(_data) + _offset, _length - _offset, length);
+    _offset += length;
+  }
+  ++_index;
+}
+
+size_t UTF8CharStream::LA(ssize_t i) {
+  if (i == 0) {
+    return 0; // undefined
+  }
+
+  size_t offset;
+  if (i < 0) {
+    if (static_cast<size_t>(-i) > _index) {
+      return IntStream::EOF; // invalid; no char before first char
+    }
+    offset = offsetOf(_index - static_cast<size_t>(-i));
+  } else {
+    if (_index + static_cast<size_t>(i) - 1 >= _size) {
+      return IntStream::EOF;
+    }
+    if (_isAscii) {
+      return static_cast<unsigned char>(_data[_offset + static_cast<size_t>(i) - 1]);
+    }
+    offset = i == 1 ? _offset : skipForward(_offset, static_cast<size_t>(i) - 1);
+  }
+
+  size_t length;
+  return decode(reinterpret_cast<const unsigned char *>(_data) + offset, _length - offset, length);
+}
+
+size_t UTF8CharStream::index() {
+  return _index;
+}
+
+size_t UTF8CharStream::size() {
+  return _size;
+}
+
+ssize_t UTF8CharStream::mark() {
+  return -1;
+}
+
+void UTF8CharStream::release(ssize_t /* marker */) {
+}
+
+void UTF8CharStream::seek(size_t index) {
+  index = std::min(index, _size);
+  _offset = offsetOf(index);
+  _index = index;
+}
+
+std::string UTF8CharStream::getText(const Interval &interval) {
+  if (interval.a < 0 || interval.b < 0) {
+    return "";
+  }
+
+  size_t start = static_cast<size_t>(interval.a);
+  size_t stop = static_cast<size_t>(interval.b);
+  if (start >= _size) {
+    return "";
+  }
+  if (stop >= _size) {
+    stop = _size - 1;
+  }
+  if (stop < start) {
+    return "";
+  }
+
+  size_t startOffset = offsetOf(start);
+  size_t stopOffset = offsetOf(stop + 1);
+  return std::string(_data + startOffset, stopOffset - startOffset);
+}
+
+std::pair<const char *, size_t> UTF8CharStream::getTextView(const Interval &interval) const {
+  if (interval.a < 0 || interval.b < interval.a || static_cast<size_t>(interval.a) >= _size) {
+    return { "", 0 };
+  }
+
+  size_t start = static_cast<size_t>(interval.a);
+  size_t stop = std::min(static_cast<size_t>(interval.b), _size - 1);
+  if (_isAscii) {
+    return { _data + start, stop - start + 1 };
+  }
+
+  // Walk forward from the closest checkpoint, without touching the lookup cache of offsetOf().
+  size_t startOffset = skipForward(_checkpoints[start / CHECKPOINT_INTERVAL], start % CHECKPOINT_INTERVAL);
+  size_t stopOffset = skipForward(startOffset, stop - start + 1);
+  return { _data + startOffset, stopOffset - startOffset };
+}
+
+std::string UTF8CharStream::getSourceName() const {
+  if (name.empty()) {
+    return IntStream::UNKNOWN_SOURCE_NAME;
+  }
+  return name;
+}
+
+std::string UTF8CharStream::toString() const {
+  return std::string(_data, _length);
+}
+
+bool UTF8CharStream::isAscii() const {
+  return _isAscii;
+}
+
+size_t UTF8CharStream::offsetOf(size_t index) {
+  if (_isAscii) {
+    return index;
+  }
+  if (index == _index) {
+    return _offset;
+  }
+  if (index >= _size) {
+    return _length;
+  }
+
+  // A few steps back from the current position (typical for a lexer going back to its last accept state).
+  // Stepping back is only ambiguous with invalid input, which is detected by decoding forward again.
+  if (index < _index && _index - index <= MAX_STEP_BACK) {
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(_data);
+    size_t offset = _offset;
+    size_t current = _index;
+    while (current > index) {
+      size_t candidate = offset - 1;
+      while (candidate > 0 && offset - candidate < 4 && isContinuation(bytes[candidate])) {
+        --candidate;
+      }
+
+      size_t length;
+      decode(bytes + candidate, _length - candidate, length);
+      if (candidate + length != offset) {
+        break;
+      }
+      offset = candidate;
+      --current;
+    }
+
+    if (current == index) {
+      return offset;
+    }
+  }
+
+  // Otherwise walk forward from the closest known position before the index.
+  size_t baseIndex = index - index % CHECKPOINT_INTERVAL;
+  size_t baseOffset = _checkpoints[index / CHECKPOINT_INTERVAL];
+  if (_index <= index && _index > baseIndex) {
+    baseIndex = _index;
+    baseOffset = _offset;
+  }
+  if (_lastIndex <= index && _lastIndex > baseIndex) {
+    baseIndex = _lastIndex;
+    baseOffset = _lastOffset;
+  }
+
+  _lastIndex = index;
+  _lastOffset = skipForward(baseOffset, index - baseIndex);
+  return _lastOffset;
+}
+
+size_t UTF8CharStream::skipForward(size_t offset, size_t count) const {
+  const unsigned char *bytes = reinterpret_cast<const unsigned char *>(_data);
+  while (count > 0 && offset < _length) {
+    if (bytes[offset] < 0x80) {
+      ++offset;
+    } else {
+      size_t length;
+      decode(bytes + offset, _length - offset, length);
+      offset += length;
+    }
+    --count;
+  }
+  return offset;
+}
@@ -0,0 +1,81 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include "CharStream.h"
+
+namespace antlr4 {
+
+  /// A char stream which reads code points directly from UTF-8 encoded memory, without converting the input
+  /// to UTF-32 first (as ANTLRInputStream does). The memory is not copied and must stay valid (and unchanged)
+  /// as long as the stream is used.
+  ///
+  /// Stream indices are code point indices, like in all other char streams. For pure ASCII input they are
+  /// identical to byte offsets. Otherwise the stream tracks the byte offset of the current position and keeps
+  /// the byte offset of every CHECKPOINT_INTERVAL-th code point, to support seeking and getText() for arbitrary
+  /// positions with a small amount of extra memory.
+  ///
+  /// Invalid UTF-8 bytes are returned as U+FFFD (one per byte). getText() returns the original bytes.
+  class ANTLR4CPP_PUBLIC UTF8CharStream : public CharStream {
+  public:
+    static const size_t CHECKPOINT_INTERVAL = 256;
+
+    /// The name or source of this char stream.
+    std::string name;
+
+    UTF8CharStream(const char *data, size_t length);
+
+    virtual void consume() override;
+    virtual size_t LA(ssize_t i) override;
+
+    virtual size_t index() override;
+    virtual size_t size() override;
+
+    // Mark/release do nothing. We have the entire buffer.
+    virtual ssize_t mark() override;
+    virtual void release(ssize_t marker) override;
+
+    virtual void seek(size_t index) override;
+    virtual std::string getText(const misc::Interval &interval) override;
+
+    /// Like getText(), but returns the bytes in the input memory instead of a copy. Unlike getText() this doesn't
+    /// change the stream, so it can be called from several threads at once (as long as no thread consumes input).
+    std::pair<const char *, size_t> getTextView(const misc::Interval &interval) const;
+
+    virtual std::string getSourceName() const override;
+    virtual std::string toString() const override;
+
+    /// Returns true if the input consists only of ASCII characters (the fast path).
+    bool isAscii() const;
+
+  protected:
+    UTF8CharStream();
+
+    /// Sets the memory to read from and resets the stream position. Used by sub classes which acquire
+    /// the memory in their constructor.
+    void setData(const char *data, size_t length);
+
+  private:
+    const char *_data;
+    size_t _length;
+
+    size_t _size;   // Number of code points.
+    size_t _index;  // Current code point index.
+    size_t _offset; // Byte offset of _index.
+    bool _isAscii;
+
+    // Byte offsets of the code points 0, CHECKPOINT_INTERVAL, 2 * CHECKPOINT_INTERVAL, ... (non-ASCII input only).
+    std::vector<size_t> _checkpoints;
+
+    // The position of the last offset lookup, as getText() calls usually come in ascending order.
+    size_t _lastIndex;
+    size_t _lastOffset;
+
+    size_t offsetOf(size_t index);
+    size_t skipForward(size_t offset, size_t count) const;
+  };
+
+} // namespace antlr4
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <assert.h>
 #include <codecvt>
 #include <chrono>
@@ -129,3 +130,8 @@
 
 #define INVALID_INDEX std::numeric_limits<size_t>::max()
 template<class T> using Ref = std::shared_ptr<T>;
+
+#include "support/IntrusivePtr.h"
+
+// Intrusively reference counted pointer, used for the prediction and semantic context graphs.
+template<class T> using RefPtr = antlrcpp::IntrusivePtr<T>;
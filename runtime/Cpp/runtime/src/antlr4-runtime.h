@@ -20,6 +20,7 @@
 #include "CommonToken.h"
 #include "CommonTokenFactory.h"
 #include "CommonTokenStream.h"
+#include "CompactTokenStream.h"
 #include "ConsoleErrorListener.h"
 #include "DefaultErrorStrategy.h"
 #include "DiagnosticErrorListener.h"
@@ -32,6 +33,7 @@
 #include "LexerInterpreter.h"
 #include "LexerNoViableAltException.h"
 #include "ListTokenSource.h"
+#include "MappedFileStream.h"
 #include "NoViableAltException.h"
 #include "Parser.h"
 #include "ParserInterpreter.h"
@@ -47,6 +49,7 @@
 #include "TokenSource.h"
 #include "TokenStream.h"
 #include "TokenStreamRewriter.h"
+#include "UTF8CharStream.h"
 #include "UnbufferedCharStream.h"
 #include "UnbufferedTokenStream.h"
 #include "Vocabulary.h"
@@ -84,6 +87,7 @@
 #include "atn/LexerActionExecutor.h"
 #include "atn/LexerActionType.h"
 #include "atn/LexerChannelAction.h"
+#include "atn/LexerCharClasses.h"
 #include "atn/LexerCustomAction.h"
 #include "atn/LexerIndexedCustomAction.h"
 #include "atn/LexerModeAction.h"
@@ -104,6 +108,7 @@
 #include "atn/PredicateEvalInfo.h"
 #include "atn/PredicateTransition.h"
 #include "atn/PredictionContext.h"
+#include "atn/PredictionContextCache.h"
 #include "atn/PredictionMode.h"
 #include "atn/ProfilingATNSimulator.h"
 #include "atn/RangeTransition.h"
@@ -120,23 +125,32 @@
 #include "atn/Transition.h"
 #include "atn/WildcardTransition.h"
 #include "dfa/DFA.h"
+#include "dfa/DFAPrecomputer.h"
 #include "dfa/DFASerializer.h"
+#include "dfa/DFASnapshot.h"
 #include "dfa/DFAState.h"
 #include "dfa/LexerDFASerializer.h"
+#include "dfa/LexerDFATable.h"
 #include "misc/Interval.h"
 #include "misc/IntervalSet.h"
 #include "misc/MurmurHash.h"
 #include "misc/Predicate.h"
 #include "support/Any.h"
+#include "support/Arena.h"
 #include "support/Arrays.h"
 #include "support/BitSet.h"
 #include "support/CPPUtils.h"
+#include "support/IntrusivePtr.h"
 #include "support/StringUtils.h"
+#include "support/UTF8.h"
 #include "support/guid.h"
 #include "tree/AbstractParseTreeVisitor.h"
 #include "tree/ErrorNode.h"
 #include "tree/ErrorNodeImpl.h"
+#include "tree/FusedParseTreeListener.h"
+#include "tree/ParallelParseTreeWalker.h"
 #include "tree/ParseTree.h"
+#include "tree/ParseTreeChildren.h"
 #include "tree/ParseTreeListener.h"
 #include "tree/ParseTreeProperty.h"
 #include "tree/ParseTreeVisitor.h"
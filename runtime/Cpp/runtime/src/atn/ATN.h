@@ -54,6 +54,10 @@ namespace atn {
 
     std::vector<TokensStartState *> modeToStartState;
 
+    /// For lexer ATNs, the character classes of its transitions (computed by the deserializer). Can be null for
+    /// ATNs created otherwise, in which case the lexer tests each transition on the input characters directly.
+    Ref<LexerCharClasses> charClasses;
+
     ATN& operator = (ATN &other) NOEXCEPT;
     ATN& operator = (ATN &&other) NOEXCEPT;
 
@@ -45,7 +45,7 @@ namespace atn {
     /// execution of the ATN simulator.
     ///
     /// Can be shared between multiple ANTConfig instances.
-    Ref<PredictionContext> context;
+    RefPtr<PredictionContext> context;
 
     /**
      * We cannot execute predicates dependent upon local context unless
@@ -73,17 +73,17 @@ namespace atn {
     size_t reachesIntoOuterContext;
 
     /// Can be shared between multiple ATNConfig instances.
-    Ref<SemanticContext> semanticContext;
+    RefPtr<SemanticContext> semanticContext;
 
-    ATNConfig(ATNState *state, size_t alt, Ref<PredictionContext> const& context);
-    ATNConfig(ATNState *state, size_t alt, Ref<PredictionContext> const& context, Ref<SemanticContext> const& semanticContext);
+    ATNConfig(ATNState *state, size_t alt, RefPtr<PredictionContext> const& context);
+    ATNConfig(ATNState *state, size_t alt, RefPtr<PredictionContext> const& context, RefPtr<SemanticContext> const& semanticContext);
 
     ATNConfig(Ref<ATNConfig> const& c); // dup
     ATNConfig(Ref<ATNConfig> const& c, ATNState *state);
-    ATNConfig(Ref<ATNConfig> const& c, ATNState *state, Ref<SemanticContext> const& semanticContext);
-    ATNConfig(Ref<ATNConfig> const& c, Ref<SemanticContext> const& semanticContext);
-    ATNConfig(Ref<ATNConfig> const& c, ATNState *state, Ref<PredictionContext> const& context);
-    ATNConfig(Ref<ATNConfig> const& c, ATNState *state, Ref<PredictionContext> const& context, Ref<SemanticContext> const& semanticContext);
+    ATNConfig(Ref<ATNConfig> const& c, ATNState *state, RefPtr<SemanticContext> const& semanticContext);
+    ATNConfig(Ref<ATNConfig> const& c, RefPtr<SemanticContext> const& semanticContext);
+    ATNConfig(Ref<ATNConfig> const& c, ATNState *state, RefPtr<PredictionContext> const& context);
+    ATNConfig(Ref<ATNConfig> const& c, ATNState *state, RefPtr<PredictionContext> const& context, RefPtr<SemanticContext> const& semanticContext);
 
     ATNConfig(ATNConfig const&) = default;
     virtual ~ATNConfig();
@@ -15,6 +15,11 @@
 using namespace antlr4::atn;
 using namespace antlrcpp;
 
+static inline size_t firstSlot(size_t hash, size_t mask) {
+  // getHash() mostly varies in the low bits already, but fold in some higher bits too.
+  return (hash ^ (hash >> 16)) & mask;
+}
+
 ATNConfigSet::ATNConfigSet(bool fullCtx) : fullCtx(fullCtx) {
   InitializeInstanceFields();
 }
@@ -45,19 +50,33 @@ bool ATNConfigSet::add(const Ref<ATNConfig> &config, PredictionContextMergeCache
     dipsIntoOuterContext = true;
   }
 
+  if ((configs.size() + 1) * 2 > _configLookup.size()) {
+    growLookup();
+  }
+
   size_t hash = getHash(config.get());
-  ATNConfig *existing = _configLookup[hash];
-  if (existing == nullptr) {
-    _configLookup[hash] = config.get();
-    _cachedHashCode = 0;
-    configs.push_back(config); // track order here
+  size_t mask = _configLookup.size() - 1;
+  ATNConfig *existing = nullptr;
+  for (size_t i = firstSlot(hash, mask); ; i = (i + 1) & mask) {
+    LookupSlot &slot = _configLookup[i];
+    if (slot.index == 0) {
+      slot.hash = hash;
+      slot.index = configs.size() + 1;
+      _cachedHashCode = 0;
+      configs.push_back(config); // track order here
+
+      return true;
+    }
 
-    return true;
+    if (slot.hash == hash && equal(configs[slot.index - 1].get(), config.get())) {
+      existing = configs[slot.index - 1].get();
+      break;
+    }
   }
 
   // a previous (s,i,pi,_), merge with it and save result
   bool rootIsWildcard = !fullCtx;
-  Ref<PredictionContext> merged = PredictionContext::merge(existing->context, config->context, rootIsWildcard, mergeCache);
+  RefPtr<PredictionContext> merged = PredictionContext::merge(existing->context, config->context, rootIsWildcard, mergeCache);
   // no need to check for existing.context, config.context in cache
   // since only way to create new graphs is "call rule" and here. We
   // cache at both places.
@@ -99,14 +118,14 @@ std::vector<ATNState*> ATNConfigSet::getStates() {
 
 BitSet ATNConfigSet::getAlts() {
   BitSet alts;
-  for (ATNConfig config : configs) {
-    alts.set(config.alt);
+  for (auto &config : configs) {
+    alts.set(config->alt);
   }
   return alts;
 }
 
-std::vector<Ref<SemanticContext>> ATNConfigSet::getPredicates() {
-  std::vector<Ref<SemanticContext>> preds;
+std::vector<RefPtr<SemanticContext>> ATNConfigSet::getPredicates() {
+  std::vector<RefPtr<SemanticContext>> preds;
   for (auto c : configs) {
     if (c->semanticContext != SemanticContext::NONE) {
       preds.push_back(c->semanticContext);
@@ -172,7 +191,7 @@ void ATNConfigSet::clear() {
   }
   configs.clear();
   _cachedHashCode = 0;
-  _configLookup.clear();
+  std::fill(_configLookup.begin(), _configLookup.end(), LookupSlot { 0, 0 }); // Keep the capacity for reuse.
 }
 
 bool ATNConfigSet::isReadonly() {
@@ -181,7 +200,7 @@ bool ATNConfigSet::isReadonly() {
 
 void ATNConfigSet::setReadonly(bool readonly) {
   _readonly = readonly;
-  _configLookup.clear();
+  std::vector<LookupSlot>().swap(_configLookup); // Not needed anymore, release the memory.
 }
 
 std::string ATNConfigSet::toString() {
@@ -218,6 +237,26 @@ size_t ATNConfigSet::getHash(ATNConfig *c) {
   return hashCode;
 }
 
+bool ATNConfigSet::equal(ATNConfig *lhs, ATNConfig *rhs) {
+  return lhs->state->stateNumber == rhs->state->stateNumber && lhs->alt == rhs->alt &&
+    (lhs->semanticContext == rhs->semanticContext || *lhs->semanticContext == *rhs->semanticContext);
+}
+
+void ATNConfigSet::growLookup() {
+  std::vector<LookupSlot> lookup(_configLookup.empty() ? 16 : _configLookup.size() * 2, LookupSlot { 0, 0 });
+  size_t mask = lookup.size() - 1;
+  for (auto &slot : _configLookup) {
+    if (slot.index != 0) {
+      size_t i = firstSlot(slot.hash, mask);
+      while (lookup[i].index != 0) {
+        i = (i + 1) & mask;
+      }
+      lookup[i] = slot;
+    }
+  }
+  _configLookup.swap(lookup);
+}
+
 void ATNConfigSet::InitializeInstanceFields() {
   uniqueAlt = 0;
   hasSemanticContext = false;
@@ -69,7 +69,7 @@ namespace atn {
      * @since 4.3
      */
     antlrcpp::BitSet getAlts();
-    virtual std::vector<Ref<SemanticContext>> getPredicates();
+    virtual std::vector<RefPtr<SemanticContext>> getPredicates();
 
     virtual Ref<ATNConfig> get(size_t i) const;
 
@@ -95,14 +95,23 @@ namespace atn {
     bool _readonly;
 
     virtual size_t getHash(ATNConfig *c); // Hash differs depending on set type.
+    virtual bool equal(ATNConfig *lhs, ATNConfig *rhs); // Must agree with getHash.
 
   private:
+    struct LookupSlot {
+      size_t hash;
+      size_t index; // Index + 1 of the config in configs, 0 for an unused slot.
+    };
+
     size_t _cachedHashCode;
 
     /// All configs but hashed by (s, i, _, pi) not including context. Wiped out
     /// when we go readonly as this set becomes a DFA state.
-    std::unordered_map<size_t, ATNConfig *> _configLookup;
+    /// This is an open addressing table (linear probing, power of 2 size, at most half full) which
+    /// stores the full hash next to the config index, so most probes don't touch the configs at all.
+    std::vector<LookupSlot> _configLookup;
 
+    void growLookup();
     void InitializeInstanceFields();
   };
 
@@ -59,6 +59,10 @@ void ATNDeserializationOptions::throwIfReadOnly() {
 
 void ATNDeserializationOptions::InitializeInstanceFields() {
   readOnly = false;
+#ifdef NDEBUG
+  verifyATN = false;
+#else
   verifyATN = true;
+#endif
   generateRuleBypassTransitions = false;
 }
@@ -31,6 +31,8 @@ namespace atn {
 
     void makeReadOnly();
 
+    /// Verification checks the structure of the deserialized ATN. ATNs produced by the tool are always valid, so it is
+    /// only enabled by default in debug builds (without NDEBUG), where it catches mismatches between tool and runtime.
     bool isVerifyATN();
 
     void setVerifyATN(bool verify);
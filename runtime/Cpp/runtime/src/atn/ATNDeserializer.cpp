@@ -48,6 +48,7 @@
 #include "atn/LexerPushModeAction.h"
 #include "atn/LexerSkipAction.h"
 #include "atn/LexerTypeAction.h"
+#include "atn/LexerCharClasses.h"
 
 #include "atn/ATNDeserializer.h"
 
@@ -98,10 +99,28 @@ void deserializeSets(
       auto b = readUnicode(data, p);
       set.add(a, b);
     }
-    sets.push_back(set);
+    sets.push_back(std::move(set));
   }
 }
 
+// The checks below use the state and transition types instead of RTTI. Deserialization runs at the start of most
+// applications and dynamic_cast was the largest part of its cost.
+bool isBlockStartState(ATNState *state) {
+  switch (state->getStateType()) {
+    case ATNState::BLOCK_START:
+    case ATNState::PLUS_BLOCK_START:
+    case ATNState::STAR_BLOCK_START:
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+bool hasStateType(ATNState *state, size_t type) {
+  return state != nullptr && state->getStateType() == type;
+}
+
 }
 
 ATNDeserializer::ATNDeserializer(): ATNDeserializer(ATNDeserializationOptions::getDefaultOptions()) {
@@ -183,6 +202,7 @@ ATN ATNDeserializer::deserialize(const std::vector<uint16_t>& input) {
 
   bool supportsPrecedencePredicates = isFeatureSupported(ADDED_PRECEDENCE_TRANSITIONS(), uuid);
   bool supportsLexerActions = isFeatureSupported(ADDED_LEXER_ACTIONS(), uuid);
+  bool supportsUnicodeSMP = isFeatureSupported(ADDED_UNICODE_SMP(), uuid);
 
   ATNType grammarType = (ATNType)data[p++];
   size_t maxTokenType = data[p++];
@@ -194,6 +214,7 @@ ATN ATNDeserializer::deserialize(const std::vector<uint16_t>& input) {
   std::vector<std::pair<LoopEndState*, size_t>> loopBackStateNumbers;
   std::vector<std::pair<BlockStartState*, size_t>> endStateNumbers;
   size_t nstates = data[p++];
+  atn.states.reserve(nstates);
   for (size_t i = 0; i < nstates; i++) {
     size_t stype = data[p++];
     // ignore bad type of states
@@ -211,7 +232,7 @@ ATN ATNDeserializer::deserialize(const std::vector<uint16_t>& input) {
     if (stype == ATNState::LOOP_END) { // special case
       int loopBackStateNumber = data[p++];
       loopBackStateNumbers.push_back({ (LoopEndState*)s,  loopBackStateNumber });
-    } else if (is<BlockStartState*>(s)) {
+    } else if (isBlockStartState(s)) {
       int endStateNumber = data[p++];
       endStateNumbers.push_back({ (BlockStartState*)s, endStateNumber });
     }
@@ -247,6 +268,7 @@ ATN ATNDeserializer::deserialize(const std::vector<uint16_t>& input) {
   // RULES
   //
   size_t nrules = data[p++];
+  atn.ruleToStartState.reserve(nrules);
   for (size_t i = 0; i < nrules; i++) {
     size_t s = data[p++];
     // Also here, the serialized atn must ensure to point to the correct class type.
@@ -260,7 +282,7 @@ ATN ATNDeserializer::deserialize(const std::vector<uint16_t>& input) {
 
       atn.ruleToTokenType.push_back(tokenType);
 
-      if (!isFeatureSupported(ADDED_LEXER_ACTIONS(), uuid)) {
+      if (!supportsLexerActions) {
         // this piece of unused metadata was serialized prior to the
         // addition of LexerAction
         //int actionIndexIgnored = data[p++];
@@ -271,7 +293,7 @@ ATN ATNDeserializer::deserialize(const std::vector<uint16_t>& input) {
 
   atn.ruleToStopState.resize(nrules);
   for (ATNState *state : atn.states) {
-    if (!is<RuleStopState*>(state)) {
+    if (!hasStateType(state, ATNState::RULE_STOP)) {
       continue;
     }
 
@@ -299,7 +321,7 @@ ATN ATNDeserializer::deserialize(const std::vector<uint16_t>& input) {
 
   // Next, if the ATN was serialized with the Unicode SMP feature,
   // deserialize sets with 32-bit arguments <= U+10FFFF.
-  if (isFeatureSupported(ADDED_UNICODE_SMP(), uuid)) {
+  if (supportsUnicodeSMP) {
     deserializeSets(data, p, sets, readUnicodeInt32);
   }
 
@@ -307,6 +329,18 @@ ATN ATNDeserializer::deserialize(const std::vector<uint16_t>& input) {
   // EDGES
   //
   int nedges = data[p++];
+
+  // Count the edges of each state first, so that each transition list is allocated only once.
+  std::vector<size_t> edgeCounts(atn.states.size());
+  for (int i = 0; i < nedges; i++) {
+    edgeCounts[data[p + 6 * i]]++;
+  }
+  for (size_t i = 0; i < edgeCounts.size(); i++) {
+    if (edgeCounts[i] > 0) {
+      atn.states[i]->transitions.reserve(edgeCounts[i]);
+    }
+  }
+
   for (int i = 0; i < nedges; i++) {
     size_t src = data[p];
     size_t trg = data[p + 1];
@@ -324,7 +358,7 @@ ATN ATNDeserializer::deserialize(const std::vector<uint16_t>& input) {
   for (ATNState *state : atn.states) {
     for (size_t i = 0; i < state->transitions.size(); i++) {
       Transition *t = state->transitions[i];
-      if (!is<RuleTransition*>(t)) {
+      if (t->getSerializationType() != Transition::RULE) {
         continue;
       }
 
@@ -342,7 +376,7 @@ ATN ATNDeserializer::deserialize(const std::vector<uint16_t>& input) {
   }
 
   for (ATNState *state : atn.states) {
-    if (is<BlockStartState *>(state)) {
+    if (isBlockStartState(state)) {
       BlockStartState *startState = static_cast<BlockStartState *>(state);
 
       // we need to know the end state to set its start state
@@ -358,19 +392,19 @@ ATN ATNDeserializer::deserialize(const std::vector<uint16_t>& input) {
       startState->endState->startState = static_cast<BlockStartState*>(state);
     }
 
-    if (is<PlusLoopbackState*>(state)) {
+    if (state->getStateType() == ATNState::PLUS_LOOP_BACK) {
       PlusLoopbackState *loopbackState = static_cast<PlusLoopbackState *>(state);
       for (size_t i = 0; i < loopbackState->transitions.size(); i++) {
         ATNState *target = loopbackState->transitions[i]->target;
-        if (is<PlusBlockStartState *>(target)) {
+        if (hasStateType(target, ATNState::PLUS_BLOCK_START)) {
           (static_cast<PlusBlockStartState *>(target))->loopBackState = loopbackState;
         }
       }
-    } else if (is<StarLoopbackState *>(state)) {
+    } else if (state->getStateType() == ATNState::STAR_LOOP_BACK) {
       StarLoopbackState *loopbackState = static_cast<StarLoopbackState *>(state);
       for (size_t i = 0; i < loopbackState->transitions.size(); i++) {
         ATNState *target = loopbackState->transitions[i]->target;
-        if (is<StarLoopEntryState *>(target)) {
+        if (hasStateType(target, ATNState::STAR_LOOP_ENTRY)) {
           (static_cast<StarLoopEntryState*>(target))->loopBackState = loopbackState;
         }
       }
@@ -381,12 +415,14 @@ ATN ATNDeserializer::deserialize(const std::vector<uint16_t>& input) {
   // DECISIONS
   //
   size_t ndecisions = data[p++];
+  atn.decisionToState.reserve(ndecisions);
   for (size_t i = 1; i <= ndecisions; i++) {
     size_t s = data[p++];
-    DecisionState *decState = dynamic_cast<DecisionState*>(atn.states[s]);
-    if (decState == nullptr)
+    if (atn.states[s] == nullptr || !atn.states[s]->isDecisionState())
       throw IllegalStateException();
 
+    DecisionState *decState = static_cast<DecisionState*>(atn.states[s]);
+
     atn.decisionToState.push_back(decState);
     decState->decision = (int)i - 1;
   }
@@ -418,7 +454,7 @@ ATN ATNDeserializer::deserialize(const std::vector<uint16_t>& input) {
       for (ATNState *state : atn.states) {
         for (size_t i = 0; i < state->transitions.size(); i++) {
           Transition *transition = state->transitions[i];
-          if (!is<ActionTransition *>(transition)) {
+          if (transition->getSerializationType() != Transition::ACTION) {
             continue;
           }
 
@@ -439,6 +475,10 @@ ATN ATNDeserializer::deserialize(const std::vector<uint16_t>& input) {
     verifyATN(atn);
   }
 
+  if (atn.grammarType == ATNType::LEXER) {
+    atn.charClasses = std::make_shared<LexerCharClasses>(atn);
+  }
+
   if (deserializationOptions.isGenerateRuleBypassTransitions() && atn.grammarType == ATNType::PARSER) {
     atn.ruleToTokenType.resize(atn.ruleToStartState.size());
     for (size_t i = 0; i < atn.ruleToStartState.size(); i++) {
@@ -541,7 +581,7 @@ ATN ATNDeserializer::deserialize(const std::vector<uint16_t>& input) {
  */
 void ATNDeserializer::markPrecedenceDecisions(const ATN &atn) {
   for (ATNState *state : atn.states) {
-    if (!is<StarLoopEntryState *>(state)) {
+    if (!hasStateType(state, ATNState::STAR_LOOP_ENTRY)) {
       continue;
     }
 
@@ -551,8 +591,9 @@ void ATNDeserializer::markPrecedenceDecisions(const ATN &atn) {
      */
     if (atn.ruleToStartState[state->ruleIndex]->isLeftRecursiveRule) {
       ATNState *maybeLoopEndState = state->transitions[state->transitions.size() - 1]->target;
-      if (is<LoopEndState *>(maybeLoopEndState)) {
-        if (maybeLoopEndState->epsilonOnlyTransitions && is<RuleStopState *>(maybeLoopEndState->transitions[0]->target)) {
+      if (hasStateType(maybeLoopEndState, ATNState::LOOP_END)) {
+        if (maybeLoopEndState->epsilonOnlyTransitions &&
+            hasStateType(maybeLoopEndState->transitions[0]->target, ATNState::RULE_STOP)) {
           static_cast<StarLoopEntryState *>(state)->isPrecedenceDecision = true;
         }
       }
@@ -569,20 +610,21 @@ void ATNDeserializer::verifyATN(const ATN &atn) {
 
     checkCondition(state->epsilonOnlyTransitions || state->transitions.size() <= 1);
 
-    if (is<PlusBlockStartState *>(state)) {
+    size_t stateType = state->getStateType();
+    if (stateType == ATNState::PLUS_BLOCK_START) {
       checkCondition((static_cast<PlusBlockStartState *>(state))->loopBackState != nullptr);
     }
 
-    if (is<StarLoopEntryState *>(state)) {
+    if (stateType == ATNState::STAR_LOOP_ENTRY) {
       StarLoopEntryState *starLoopEntryState = static_cast<StarLoopEntryState*>(state);
       checkCondition(starLoopEntryState->loopBackState != nullptr);
       checkCondition(starLoopEntryState->transitions.size() == 2);
 
-      if (is<StarBlockStartState *>(starLoopEntryState->transitions[0]->target)) {
-        checkCondition(static_cast<LoopEndState *>(starLoopEntryState->transitions[1]->target) != nullptr);
+      if (hasStateType(starLoopEntryState->transitions[0]->target, ATNState::STAR_BLOCK_START)) {
+        checkCondition(hasStateType(starLoopEntryState->transitions[1]->target, ATNState::LOOP_END));
         checkCondition(!starLoopEntryState->nonGreedy);
-      } else if (is<LoopEndState *>(starLoopEntryState->transitions[0]->target)) {
-        checkCondition(is<StarBlockStartState *>(starLoopEntryState->transitions[1]->target));
+      } else if (hasStateType(starLoopEntryState->transitions[0]->target, ATNState::LOOP_END)) {
+        checkCondition(hasStateType(starLoopEntryState->transitions[1]->target, ATNState::STAR_BLOCK_START));
         checkCondition(starLoopEntryState->nonGreedy);
       } else {
         throw IllegalStateException();
@@ -590,38 +632,40 @@ void ATNDeserializer::verifyATN(const ATN &atn) {
       }
     }
 
-    if (is<StarLoopbackState *>(state)) {
+    if (stateType == ATNState::STAR_LOOP_BACK) {
       checkCondition(state->transitions.size() == 1);
-      checkCondition(is<StarLoopEntryState *>(state->transitions[0]->target));
+      checkCondition(hasStateType(state->transitions[0]->target, ATNState::STAR_LOOP_ENTRY));
     }
 
-    if (is<LoopEndState *>(state)) {
+    if (stateType == ATNState::LOOP_END) {
       checkCondition((static_cast<LoopEndState *>(state))->loopBackState != nullptr);
     }
 
-    if (is<RuleStartState *>(state)) {
+    if (stateType == ATNState::RULE_START) {
       checkCondition((static_cast<RuleStartState *>(state))->stopState != nullptr);
     }
 
-    if (is<BlockStartState *>(state)) {
+    if (isBlockStartState(state)) {
       checkCondition((static_cast<BlockStartState *>(state))->endState != nullptr);
     }
 
-    if (is<BlockEndState *>(state)) {
+    if (stateType == ATNState::BLOCK_END) {
       checkCondition((static_cast<BlockEndState *>(state))->startState != nullptr);
     }
 
-    if (is<DecisionState *>(state)) {
+    if (state->isDecisionState()) {
       DecisionState *decisionState = static_cast<DecisionState *>(state);
       checkCondition(decisionState->transitions.size() <= 1 || decisionState->decision >= 0);
     } else {
-      checkCondition(state->transitions.size() <= 1 || is<RuleStopState *>(state));
+      checkCondition(state->transitions.size() <= 1 || stateType == ATNState::RULE_STOP);
     }
   }
 }
 
 void ATNDeserializer::checkCondition(bool condition) {
-  checkCondition(condition, "");
+  if (!condition) {
+    throw IllegalStateException();
+  }
 }
 
 void ATNDeserializer::checkCondition(bool condition, const std::string &message) {
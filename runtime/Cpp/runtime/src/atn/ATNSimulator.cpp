@@ -16,8 +16,6 @@ using namespace antlr4::dfa;
 using namespace antlr4::atn;
 
 const Ref<DFAState> ATNSimulator::ERROR = std::make_shared<DFAState>(INT32_MAX);
-antlrcpp::SingleWriteMultipleReadLock ATNSimulator::_stateLock;
-antlrcpp::SingleWriteMultipleReadLock ATNSimulator::_edgeLock;
 
 ATNSimulator::ATNSimulator(const ATN &atn, PredictionContextCache &sharedContextCache)
 : atn(atn), _sharedContextCache(sharedContextCache) {
@@ -34,9 +32,9 @@ PredictionContextCache& ATNSimulator::getSharedContextCache() {
   return _sharedContextCache;
 }
 
-Ref<PredictionContext> ATNSimulator::getCachedContext(Ref<PredictionContext> const& context) {
-  // This function must only be called with an active state lock, as we are going to change a shared structure.
-  std::map<Ref<PredictionContext>, Ref<PredictionContext>> visited;
+RefPtr<PredictionContext> ATNSimulator::getCachedContext(RefPtr<PredictionContext> const& context) {
+  // The context cache does its own locking (it is shared by all DFAs of a recognizer).
+  PredictionContextVisitedMap visited;
   return PredictionContext::getCachedContext(context, _sharedContextCache, visited);
 }
 
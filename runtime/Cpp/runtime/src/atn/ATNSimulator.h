@@ -8,7 +8,7 @@
 #include "atn/ATN.h"
 #include "misc/IntervalSet.h"
 #include "support/CPPUtils.h"
-#include "atn/PredictionContext.h"
+#include "atn/PredictionContextCache.h"
 
 namespace antlr4 {
 namespace atn {
@@ -37,7 +37,7 @@ namespace atn {
      */
     virtual void clearDFA();
     virtual PredictionContextCache& getSharedContextCache();
-    virtual Ref<PredictionContext> getCachedContext(Ref<PredictionContext> const& context);
+    virtual RefPtr<PredictionContext> getCachedContext(RefPtr<PredictionContext> const& context);
 
     /// @deprecated Use <seealso cref="ATNDeserializer#deserialize"/> instead.
     static ATN deserialize(const std::vector<uint16_t> &data);
@@ -56,9 +56,6 @@ namespace atn {
     static ATNState *stateFactory(int type, int ruleIndex);
 
   protected:
-    static antlrcpp::SingleWriteMultipleReadLock _stateLock; // Lock for DFA states.
-    static antlrcpp::SingleWriteMultipleReadLock _edgeLock; // Lock for the sparse edge map in DFA states.
-
     /// <summary>
     /// The context cache maps all PredictionContext objects that are equals()
     ///  to a single cached copy. This cache is shared across all contexts
@@ -40,6 +40,21 @@ bool ATNState::isNonGreedyExitState() {
   return false;
 }
 
+bool ATNState::isDecisionState() {
+  switch (getStateType()) {
+    case BLOCK_START:
+    case PLUS_BLOCK_START:
+    case STAR_BLOCK_START:
+    case TOKEN_START:
+    case STAR_LOOP_ENTRY:
+    case PLUS_LOOP_BACK:
+      return true;
+
+    default:
+      return false;
+  }
+}
+
 std::string ATNState::toString() const {
   return std::to_string(stateNumber);
 }
@@ -112,6 +112,9 @@ namespace atn {
     std::vector<Transition*> transitions;
 
     virtual bool isNonGreedyExitState();
+
+    /// Returns true if this state is a DecisionState (and can be static_cast to it). Uses the state type instead of RTTI.
+    bool isDecisionState();
     virtual std::string toString() const;
     virtual void addTransition(Transition *e);
     virtual void addTransition(size_t index, Transition *e);
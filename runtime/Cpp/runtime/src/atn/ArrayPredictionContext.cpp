@@ -10,13 +10,14 @@
 
 using namespace antlr4::atn;
 
-ArrayPredictionContext::ArrayPredictionContext(Ref<SingletonPredictionContext> const& a)
+ArrayPredictionContext::ArrayPredictionContext(RefPtr<SingletonPredictionContext> const& a)
   : ArrayPredictionContext({ a->parent }, { a->returnState }) {
 }
 
-ArrayPredictionContext::ArrayPredictionContext(std::vector<Ref<PredictionContext>> const& parents_,
+ArrayPredictionContext::ArrayPredictionContext(std::vector<RefPtr<PredictionContext>> const& parents_,
                                                std::vector<size_t> const& returnStates)
-  : PredictionContext(calculateHashCode(parents_, returnStates)), parents(parents_), returnStates(returnStates) {
+  : PredictionContext(calculateHashCode(parents_, returnStates), PredictionContextType::ARRAY), parents(parents_),
+    returnStates(returnStates) {
     assert(parents.size() > 0);
     assert(returnStates.size() > 0);
 }
@@ -33,7 +34,7 @@ size_t ArrayPredictionContext::size() const {
   return returnStates.size();
 }
 
-Ref<PredictionContext> ArrayPredictionContext::getParent(size_t index) const {
+RefPtr<PredictionContext> ArrayPredictionContext::getParent(size_t index) const {
   return parents[index];
 }
 
@@ -46,8 +47,12 @@ bool ArrayPredictionContext::operator == (PredictionContext const& o) const {
     return true;
   }
 
-  const ArrayPredictionContext *other = dynamic_cast<const ArrayPredictionContext*>(&o);
-  if (other == nullptr || hashCode() != other->hashCode()) {
+  if (o.getContextType() != PredictionContextType::ARRAY) {
+    return false;
+  }
+
+  const ArrayPredictionContext *other = static_cast<const ArrayPredictionContext*>(&o);
+  if (hashCode() != other->hashCode()) {
     return false; // can't be same if hash is different
   }
 
@@ -16,16 +16,22 @@
 using namespace antlr4::atn;
 using namespace antlrcpp;
 
-LexerATNConfig::LexerATNConfig(ATNState *state, int alt, Ref<PredictionContext> const& context)
+LexerATNConfig::LexerATNConfig(ATNState *state, int alt, RefPtr<PredictionContext> const& context)
   : ATNConfig(state, alt, context, SemanticContext::NONE), _passedThroughNonGreedyDecision(false) {
 }
 
-LexerATNConfig::LexerATNConfig(ATNState *state, int alt, Ref<PredictionContext> const& context,
+LexerATNConfig::LexerATNConfig(ATNState *state, int alt, RefPtr<PredictionContext> const& context,
                                Ref<LexerActionExecutor> const& lexerActionExecutor)
   : ATNConfig(state, alt, context, SemanticContext::NONE), _lexerActionExecutor(lexerActionExecutor),
     _passedThroughNonGreedyDecision(false) {
 }
 
+LexerATNConfig::LexerATNConfig(ATNState *state, int alt, RefPtr<PredictionContext> const& context,
+                               Ref<LexerActionExecutor> const& lexerActionExecutor, bool passedThroughNonGreedyDecision)
+  : ATNConfig(state, alt, context, SemanticContext::NONE), _lexerActionExecutor(lexerActionExecutor),
+    _passedThroughNonGreedyDecision(passedThroughNonGreedyDecision) {
+}
+
 LexerATNConfig::LexerATNConfig(Ref<LexerATNConfig> const& c, ATNState *state)
   : ATNConfig(c, state, c->context, c->semanticContext), _lexerActionExecutor(c->_lexerActionExecutor),
    _passedThroughNonGreedyDecision(checkNonGreedyDecision(c, state)) {
@@ -36,7 +42,7 @@ LexerATNConfig::LexerATNConfig(Ref<LexerATNConfig> const& c, ATNState *state, Re
     _passedThroughNonGreedyDecision(checkNonGreedyDecision(c, state)) {
 }
 
-LexerATNConfig::LexerATNConfig(Ref<LexerATNConfig> const& c, ATNState *state, Ref<PredictionContext> const& context)
+LexerATNConfig::LexerATNConfig(Ref<LexerATNConfig> const& c, ATNState *state, RefPtr<PredictionContext> const& context)
   : ATNConfig(c, state, context, c->semanticContext), _lexerActionExecutor(c->_lexerActionExecutor),
     _passedThroughNonGreedyDecision(checkNonGreedyDecision(c, state)) {
 }
@@ -80,5 +86,5 @@ bool LexerATNConfig::operator == (const LexerATNConfig& other) const
 
 bool LexerATNConfig::checkNonGreedyDecision(Ref<LexerATNConfig> const& source, ATNState *target) {
   return source->_passedThroughNonGreedyDecision ||
-    (is<DecisionState*>(target) && (static_cast<DecisionState*>(target))->nonGreedy);
+    (target->isDecisionState() && (static_cast<DecisionState*>(target))->nonGreedy);
 }
@@ -12,12 +12,16 @@ namespace atn {
 
   class ANTLR4CPP_PUBLIC LexerATNConfig : public ATNConfig {
   public:
-    LexerATNConfig(ATNState *state, int alt, Ref<PredictionContext> const& context);
-    LexerATNConfig(ATNState *state, int alt, Ref<PredictionContext> const& context, Ref<LexerActionExecutor> const& lexerActionExecutor);
+    LexerATNConfig(ATNState *state, int alt, RefPtr<PredictionContext> const& context);
+    LexerATNConfig(ATNState *state, int alt, RefPtr<PredictionContext> const& context, Ref<LexerActionExecutor> const& lexerActionExecutor);
+
+    /// Restores a config with all of its fields (see DFASnapshot).
+    LexerATNConfig(ATNState *state, int alt, RefPtr<PredictionContext> const& context, Ref<LexerActionExecutor> const& lexerActionExecutor,
+                   bool passedThroughNonGreedyDecision);
 
     LexerATNConfig(Ref<LexerATNConfig> const& c, ATNState *state);
     LexerATNConfig(Ref<LexerATNConfig> const& c, ATNState *state, Ref<LexerActionExecutor> const& lexerActionExecutor);
-    LexerATNConfig(Ref<LexerATNConfig> const& c, ATNState *state, Ref<PredictionContext> const& context);
+    LexerATNConfig(Ref<LexerATNConfig> const& c, ATNState *state, RefPtr<PredictionContext> const& context);
 
     /**
      * Gets the {@link LexerActionExecutor} capable of executing the embedded
@@ -4,6 +4,7 @@
  */
 
 #include "IntStream.h"
+#include "Exceptions.h"
 #include "atn/OrderedATNConfigSet.h"
 #include "Token.h"
 #include "LexerNoViableAltException.h"
@@ -18,9 +19,11 @@
 #include "Lexer.h"
 
 #include "dfa/DFAState.h"
+#include "dfa/LexerDFATable.h"
 #include "atn/LexerATNConfig.h"
 #include "atn/LexerActionExecutor.h"
 #include "atn/EmptyPredictionContext.h"
+#include "atn/LexerCharClasses.h"
 
 #include "atn/LexerATNSimulator.h"
 
@@ -72,18 +75,33 @@ size_t LexerATNSimulator::match(CharStream *input, size_t mode) {
   match_calls++;
   _mode = mode;
   ssize_t mark = input->mark();
+  _startIndex = input->index();
+  _prevAccept.reset();
+
+  if (_table != nullptr) {
+    // This runs once per token, so it avoids the cost of finally() here.
+    size_t result;
+    try {
+      result = matchTable(input);
+    } catch (...) {
+      input->release(mark);
+      throw;
+    }
+    input->release(mark);
+    return result;
+  }
 
   auto onExit = finally([input, mark] {
     input->release(mark);
   });
 
-  _startIndex = input->index();
-  _prevAccept.reset();
-  const dfa::DFA &dfa = _decisionToDFA[mode];
-  if (dfa.s0 == nullptr) {
+  // Keeps the states we walk alive, should the DFA be reset meanwhile.
+  dfa::DFA::EpochGuard epochGuard(_decisionToDFA[mode]);
+  dfa::DFAState *s0 = _decisionToDFA[mode].s0.load();
+  if (s0 == nullptr) {
     return matchATN(input);
   } else {
-    return execATN(input, dfa.s0);
+    return execATN(input, s0);
   }
 }
 
@@ -96,11 +114,28 @@ void LexerATNSimulator::reset() {
 }
 
 void LexerATNSimulator::clearDFA() {
-  size_t size = _decisionToDFA.size();
-  _decisionToDFA.clear();
-  for (size_t d = 0; d < size; ++d) {
-    _decisionToDFA.push_back(dfa::DFA(atn.getDecisionState(d), d));
+  for (auto &dfa : _decisionToDFA) {
+    dfa.reset();
+  }
+}
+
+void LexerATNSimulator::setUnicodeCaching(bool enable) {
+  _unicodeCaching = enable;
+}
+
+bool LexerATNSimulator::getUnicodeCaching() const {
+  return _unicodeCaching;
+}
+
+void LexerATNSimulator::setTable(const dfa::LexerDFATable *table) {
+  if (table != nullptr && &table->getATN() != &atn) {
+    throw IllegalArgumentException("The lexer DFA table was built for a different ATN.");
   }
+  _table = table;
+}
+
+const dfa::LexerDFATable* LexerATNSimulator::getTable() const {
+  return _table;
 }
 
 size_t LexerATNSimulator::matchATN(CharStream *input) {
@@ -113,7 +148,13 @@ size_t LexerATNSimulator::matchATN(CharStream *input) {
 
   dfa::DFAState *next = addDFAState(s0_closure.release());
   if (!suppressEdge) {
-    _decisionToDFA[_mode].s0 = next;
+    dfa::DFA &dfa = _decisionToDFA[_mode];
+    std::lock_guard<std::mutex> lck(dfa.getLock());
+
+    // Don't make a state the start state which was retired by a reset after we added it.
+    if (dfa.findState(next) == next) {
+      dfa.s0 = next;
+    }
   }
 
   size_t predict = execATN(input, next);
@@ -121,6 +162,62 @@ size_t LexerATNSimulator::matchATN(CharStream *input) {
   return predict;
 }
 
+size_t LexerATNSimulator::matchTable(CharStream *input) {
+  // Same as execATN, with the table instead of DFA states.
+  const dfa::LexerDFATable &table = *_table;
+  size_t state = table.getStartState(_mode);
+  size_t acceptState = dfa::LexerDFATable::ERROR_STATE;
+  if (table.isAcceptState(state)) {
+    acceptState = state;
+    _prevAccept.index = input->index();
+    _prevAccept.line = _line;
+    _prevAccept.charPos = _charPositionInLine;
+  }
+
+  size_t t = input->LA(1);
+  while (true) {
+    size_t target = table.getTarget(state, t);
+    if (target == dfa::LexerDFATable::ERROR_STATE) {
+      break;
+    }
+
+    if (t != Token::EOF) {
+      // Same as consume(), without reading the character again.
+      if (t == '\n') {
+        _line++;
+        _charPositionInLine = 0;
+      } else {
+        _charPositionInLine++;
+      }
+      input->consume();
+    }
+
+    if (table.isAcceptState(target)) {
+      acceptState = target;
+      _prevAccept.index = input->index();
+      _prevAccept.line = _line;
+      _prevAccept.charPos = _charPositionInLine;
+      if (t == Token::EOF) {
+        break;
+      }
+    }
+
+    t = input->LA(1);
+    state = target;
+  }
+
+  if (acceptState != dfa::LexerDFATable::ERROR_STATE) {
+    accept(input, table.getLexerActionExecutor(acceptState), _startIndex, _prevAccept.index, _prevAccept.line,
+      _prevAccept.charPos);
+    return table.getPrediction(acceptState);
+  }
+
+  if (t == Token::EOF && input->index() == _startIndex) {
+    return Token::EOF;
+  }
+  throw LexerNoViableAltException(_recog, input, _startIndex, nullptr);
+}
+
 size_t LexerATNSimulator::execATN(CharStream *input, dfa::DFAState *ds0) {
   if (ds0->isAcceptState) {
     // allow zero-length tokens
@@ -181,26 +278,30 @@ size_t LexerATNSimulator::execATN(CharStream *input, dfa::DFAState *ds0) {
 }
 
 dfa::DFAState *LexerATNSimulator::getExistingTargetState(dfa::DFAState *s, size_t t) {
-  if (s->edges.empty()|| /*t < MIN_DFA_EDGE ||*/ t > MAX_DFA_EDGE) { // MIN_DFA_EDGE is 0, hence code gives a warning, if left in.
+  if (/*t < MIN_DFA_EDGE ||*/ t > MAX_DFA_EDGE) { // MIN_DFA_EDGE is 0, hence code gives a warning, if left in.
+    if (_unicodeCaching && t <= Lexer::MAX_CHAR_VALUE) {
+      return s->edges.getRange(t);
+    }
     return nullptr;
   }
 
-  _edgeLock.readLock();
-  auto iterator = s->edges.find(t - MIN_DFA_EDGE);
+  // No lock needed here. Edges are only published once their target state is complete.
+  dfa::DFAState *target = s->edges.get(t - MIN_DFA_EDGE);
 #if DEBUG_ATN == 1
-  if (iterator != s->edges.end()) {
-    std::cout << std::string("reuse state ") << s->stateNumber << std::string(" edge to ") << iterator->second->stateNumber << std::endl;
+  if (target != nullptr) {
+    std::cout << std::string("reuse state ") << s->stateNumber << std::string(" edge to ") << target->stateNumber << std::endl;
   }
 #endif
-  _edgeLock.readUnlock();
-
-  if (iterator == s->edges.end())
-    return nullptr;
 
-  return iterator->second;
+  return target;
 }
 
 dfa::DFAState *LexerATNSimulator::computeTargetState(CharStream *input, dfa::DFAState *s, size_t t) {
+  if (s->configs == nullptr) {
+    // A state of a compact DFA which can't match any further input (see addDFAState()).
+    return ERROR.get();
+  }
+
   OrderedATNConfigSet *reach = new OrderedATNConfigSet(); /* mem-check: deleted on error or managed by new DFA state. */
 
   // if we don't find an existing DFA state
@@ -243,6 +344,10 @@ void LexerATNSimulator::getReachableConfigSet(CharStream *input, ATNConfigSet *c
   // than a config that already reached an accept state for the same rule
   size_t skipAlt = ATN::INVALID_ALT_NUMBER;
 
+  // With character classes each transition is tested with a bit lookup, instead of searching its label.
+  const LexerCharClasses *charClasses = atn.charClasses.get();
+  size_t classId = charClasses != nullptr ? charClasses->getClass(t) : 0;
+
   for (auto c : closure_->configs) {
     bool currentAltReachedAcceptState = c->alt == skipAlt;
     if (currentAltReachedAcceptState && (std::static_pointer_cast<LexerATNConfig>(c))->hasPassedThroughNonGreedyDecision()) {
@@ -256,7 +361,12 @@ void LexerATNSimulator::getReachableConfigSet(CharStream *input, ATNConfigSet *c
     size_t n = c->state->transitions.size();
     for (size_t ti = 0; ti < n; ti++) { // for each transition
       Transition *trans = c->state->transitions[ti];
-      ATNState *target = getReachableTarget(trans, (int)t);
+      ATNState *target;
+      if (charClasses != nullptr) {
+        target = charClasses->matches(c->state->stateNumber, ti, classId) ? trans->target : nullptr;
+      } else {
+        target = getReachableTarget(trans, (int)t);
+      }
       if (target != nullptr) {
         Ref<LexerActionExecutor> lexerActionExecutor = std::static_pointer_cast<LexerATNConfig>(c)->getLexerActionExecutor();
         if (lexerActionExecutor != nullptr) {
@@ -304,7 +414,7 @@ atn::ATNState *LexerATNSimulator::getReachableTarget(Transition *trans, size_t t
 }
 
 std::unique_ptr<ATNConfigSet> LexerATNSimulator::computeStartState(CharStream *input, ATNState *p) {
-  Ref<PredictionContext> initialContext = PredictionContext::EMPTY; // ml: the purpose of this assignment is unclear
+  RefPtr<PredictionContext> initialContext = PredictionContext::EMPTY; // ml: the purpose of this assignment is unclear
   std::unique_ptr<ATNConfigSet> configs(new OrderedATNConfigSet());
   for (size_t i = 0; i < p->transitions.size(); i++) {
     ATNState *target = p->transitions[i]->target;
@@ -321,7 +431,7 @@ bool LexerATNSimulator::closure(CharStream *input, const Ref<LexerATNConfig> &co
     std::cout << "closure(" << config->toString(true) << ")" << std::endl;
 #endif
 
-  if (is<RuleStopState *>(config->state)) {
+  if (config->state->getStateType() == ATNState::RULE_STOP) {
 #if DEBUG_ATN == 1
       if (_recog != nullptr) {
         std::cout << "closure at " << _recog->getRuleNames()[config->state->ruleIndex] << " rule stop " << config << std::endl;
@@ -343,9 +453,9 @@ bool LexerATNSimulator::closure(CharStream *input, const Ref<LexerATNConfig> &co
     if (config->context != nullptr && !config->context->isEmpty()) {
       for (size_t i = 0; i < config->context->size(); i++) {
         if (config->context->getReturnState(i) != PredictionContext::EMPTY_RETURN_STATE) {
-          std::weak_ptr<PredictionContext> newContext = config->context->getParent(i); // "pop" return state
+          RefPtr<PredictionContext> newContext = config->context->getParent(i); // "pop" return state
           ATNState *returnState = atn.states[config->context->getReturnState(i)];
-          Ref<LexerATNConfig> c = std::make_shared<LexerATNConfig>(config, returnState, newContext.lock());
+          Ref<LexerATNConfig> c = std::make_shared<LexerATNConfig>(config, returnState, newContext);
           currentAltReachedAcceptState = closure(input, c, configs, currentAltReachedAcceptState, speculative, treatEofAsEpsilon);
         }
       }
@@ -380,7 +490,7 @@ Ref<LexerATNConfig> LexerATNSimulator::getEpsilonTarget(CharStream *input, const
   switch (t->getSerializationType()) {
     case Transition::RULE: {
       RuleTransition *ruleTransition = static_cast<RuleTransition*>(t);
-      Ref<PredictionContext> newContext = SingletonPredictionContext::create(config->context, ruleTransition->followState->stateNumber);
+      RefPtr<PredictionContext> newContext = SingletonPredictionContext::create(config->context, ruleTransition->followState->stateNumber);
       c = std::make_shared<LexerATNConfig>(config, t->target, newContext);
       break;
     }
@@ -528,13 +638,57 @@ dfa::DFAState *LexerATNSimulator::addDFAEdge(dfa::DFAState *from, size_t t, ATNC
 
 void LexerATNSimulator::addDFAEdge(dfa::DFAState *p, size_t t, dfa::DFAState *q) {
   if (/*t < MIN_DFA_EDGE ||*/ t > MAX_DFA_EDGE) { // MIN_DFA_EDGE is 0
-    // Only track edges within the DFA bounds
+    // Only track edges within the DFA bounds, unless we cache the full Unicode range.
+    if (!_unicodeCaching || t > Lexer::MAX_CHAR_VALUE) {
+      return;
+    }
+
+    misc::Interval range = getUnicodeEdgeRange(p, t);
+    dfa::DFA &dfa = _decisionToDFA[_mode];
+    std::lock_guard<std::mutex> lck(dfa.getLock());
+
+    // Ranges are the character classes of p, so they are either identical or disjoint.
+    // If t is covered already another thread added the same range meanwhile.
+    if (p->edges.getRange(t) == nullptr) {
+      dfa.addRangeEdge(p, range.a, range.b, q);
+    }
     return;
   }
 
-  _edgeLock.writeLock();
-  p->edges[t - MIN_DFA_EDGE] = q; // connect
-  _edgeLock.writeUnlock();
+  dfa::DFA &dfa = _decisionToDFA[_mode];
+  std::lock_guard<std::mutex> lck(dfa.getLock());
+  dfa.addEdge(p, t - MIN_DFA_EDGE, q); // connect
+}
+
+misc::Interval LexerATNSimulator::getUnicodeEdgeRange(dfa::DFAState *s, size_t t) {
+  ssize_t a = MAX_DFA_EDGE + 1;
+  ssize_t b = Lexer::MAX_CHAR_VALUE;
+  ssize_t symbol = (ssize_t)t;
+
+  for (auto &c : s->configs->configs) {
+    for (Transition *transition : c->state->transitions) {
+      if (transition->isEpsilon()) {
+        continue;
+      }
+
+      // Whether a transition matches can only change at the boundaries of its label. Wildcards
+      // have an empty label and match everything, so they don't restrict the range at all.
+      for (auto &interval : transition->label().getIntervals()) {
+        if (interval.b < symbol) {
+          a = std::max(a, interval.b + 1);
+        } else if (interval.a > symbol) {
+          b = std::min(b, interval.a - 1);
+          break;
+        } else {
+          a = std::max(a, interval.a);
+          b = std::min(b, interval.b);
+          break;
+        }
+      }
+    }
+  }
+
+  return misc::Interval(a, b);
 }
 
 dfa::DFAState *LexerATNSimulator::addDFAState(ATNConfigSet *configs) {
@@ -543,10 +697,11 @@ dfa::DFAState *LexerATNSimulator::addDFAState(ATNConfigSet *configs) {
    */
   assert(!configs->hasSemanticContext);
 
-  dfa::DFAState *proposed = new dfa::DFAState(std::unique_ptr<ATNConfigSet>(configs)); /* mem-check: managed by the DFA or deleted below */
+  // All cacheable edges of a lexer state go to the flat edge array, which makes the DFA loop an array lookup per char.
+  dfa::DFAState *proposed = new dfa::DFAState(std::unique_ptr<ATNConfigSet>(configs), MAX_DFA_EDGE - MIN_DFA_EDGE + 1); /* mem-check: managed by the DFA or deleted below */
   Ref<ATNConfig> firstConfigWithRuleStopState = nullptr;
   for (auto &c : configs->configs) {
-    if (is<RuleStopState *>(c->state)) {
+    if (c->state->getStateType() == ATNState::RULE_STOP) {
       firstConfigWithRuleStopState = c;
       break;
     }
@@ -554,27 +709,29 @@ dfa::DFAState *LexerATNSimulator::addDFAState(ATNConfigSet *configs) {
 
   if (firstConfigWithRuleStopState != nullptr) {
     proposed->isAcceptState = true;
-    proposed->lexerActionExecutor = std::dynamic_pointer_cast<LexerATNConfig>(firstConfigWithRuleStopState)->getLexerActionExecutor();
+    proposed->lexerActionExecutor = std::static_pointer_cast<LexerATNConfig>(firstConfigWithRuleStopState)->getLexerActionExecutor();
     proposed->prediction = atn.ruleToTokenType[firstConfigWithRuleStopState->state->ruleIndex];
   }
 
   dfa::DFA &dfa = _decisionToDFA[_mode];
 
-  _stateLock.writeLock();
-  if (!dfa.states.empty()) {
-    auto iterator = dfa.states.find(proposed);
-    if (iterator != dfa.states.end()) {
-      delete proposed;
-      _stateLock.writeUnlock();
-      return *iterator;
-    }
+  std::lock_guard<std::mutex> lck(dfa.getLock());
+  dfa::DFAState *existing = dfa.findState(proposed);
+  if (existing != nullptr) {
+    delete proposed;
+    return existing;
   }
 
-  proposed->stateNumber = (int)dfa.states.size();
   proposed->configs->setReadonly(true);
-
-  dfa.states.insert(proposed);
-  _stateLock.writeUnlock();
+  dfa.addState(proposed);
+
+  // If all configs reached the end of their rule, no further input can be matched from this state.
+  if (dfa.hasCompactStates() && proposed->isAcceptState &&
+      std::all_of(configs->configs.begin(), configs->configs.end(), [](Ref<ATNConfig> const& config) {
+        return config->state->getStateType() == ATNState::RULE_STOP;
+      })) {
+    dfa.releaseConfigs(proposed);
+  }
 
   return proposed;
 }
@@ -627,4 +784,6 @@ void LexerATNSimulator::InitializeInstanceFields() {
   _line = 1;
   _charPositionInLine = 0;
   _mode = antlr4::Lexer::DEFAULT_MODE;
+  _unicodeCaching = false;
+  _table = nullptr;
 }
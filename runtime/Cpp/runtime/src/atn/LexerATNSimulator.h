@@ -81,6 +81,12 @@ namespace atn {
     /// Used during DFA/ATN exec to record the most recent accept configuration info.
     SimState _prevAccept;
 
+    /// Cache transitions on characters beyond MAX_DFA_EDGE (see setUnicodeCaching()).
+    bool _unicodeCaching;
+
+    /// The precomputed DFA used instead of ATN simulation, if any (see setTable()).
+    const dfa::LexerDFATable *_table;
+
   public:
     static int match_calls;
 
@@ -93,8 +99,23 @@ namespace atn {
 
     virtual void clearDFA() override;
 
+    /// By default only transitions on MIN_DFA_EDGE..MAX_DFA_EDGE are cached in the DFA, all other characters go
+    /// through full ATN simulation. When enabled, transitions on any other character are cached too, as range
+    /// edges covering all characters which behave identically in the source state. This keeps non-ASCII input
+    /// on the DFA fast path, with memory bounded by the character classes used in the grammar.
+    /// The DFA can be shared between simulators with different settings.
+    void setUnicodeCaching(bool enable);
+    bool getUnicodeCaching() const;
+
+    /// Matches tokens with the given table (built for the same ATN) instead of ATN simulation and the DFA cache.
+    /// The table is not owned and must stay alive while it's set. Null switches back to ATN simulation.
+    /// @throws IllegalArgumentException if the table was built for another ATN.
+    void setTable(const dfa::LexerDFATable *table);
+    const dfa::LexerDFATable* getTable() const;
+
   protected:
     virtual size_t matchATN(CharStream *input);
+    virtual size_t matchTable(CharStream *input);
     virtual size_t execATN(CharStream *input, dfa::DFAState *ds0);
 
     /// <summary>
@@ -135,6 +156,7 @@ namespace atn {
     virtual void accept(CharStream *input, const Ref<LexerActionExecutor> &lexerActionExecutor, size_t startIndex, size_t index,
                         size_t line, size_t charPos);
 
+    /// Only used for ATNs without character classes (see ATN::charClasses).
     virtual ATNState *getReachableTarget(Transition *trans, size_t t);
 
     virtual std::unique_ptr<ATNConfigSet> computeStartState(CharStream *input, ATNState *p);
@@ -177,6 +199,11 @@ namespace atn {
     /// {@code true}. </returns>
     virtual bool evaluatePredicate(CharStream *input, size_t ruleIndex, size_t predIndex, bool speculative);
 
+    /// Returns the largest range of characters around {@code t} (beyond MAX_DFA_EDGE) for which all
+    /// transitions leaving the configurations of {@code s} match either all or none of the characters,
+    /// i.e. the range in which every character leads to the same target state.
+    virtual misc::Interval getUnicodeEdgeRange(dfa::DFAState *s, size_t t);
+
     virtual void captureSimState(CharStream *input, dfa::DFAState *dfaState);
     virtual dfa::DFAState* addDFAEdge(dfa::DFAState *from, size_t t, ATNConfigSet *q);
     virtual void addDFAEdge(dfa::DFAState *p, size_t t, dfa::DFAState *q);
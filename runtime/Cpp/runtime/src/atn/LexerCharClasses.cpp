@@ -0,0 +1,213 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include "Lexer.h"
+#include "Token.h"
+#include "atn/ATN.h"
+#include "atn/ATNState.h"
+#include "atn/AtomTransition.h"
+#include "atn/RangeTransition.h"
+#include "atn/SetTransition.h"
+#include "misc/IntervalSet.h"
+
+#include "atn/LexerCharClasses.h"
+
+using namespace antlr4;
+using namespace antlr4::atn;
+
+const size_t LexerCharClasses::LOW_CLASSES;
+
+namespace {
+
+  // Appends the characters matched by the label of a transition as ranges (first, last). EOF is left out.
+  void addLabel(Transition *transition, std::vector<std::pair<size_t, size_t>> &ranges) {
+    switch (transition->getSerializationType()) {
+      case Transition::ATOM: {
+        size_t label = static_cast<AtomTransition *>(transition)->_label;
+        if (label <= Lexer::MAX_CHAR_VALUE) {
+          ranges.push_back({ label, label });
+        }
+        break;
+      }
+
+      case Transition::RANGE: {
+        RangeTransition *range = static_cast<RangeTransition *>(transition);
+        ranges.push_back({ range->from, range->to });
+        break;
+      }
+
+      case Transition::SET:
+      case Transition::NOT_SET:
+        for (auto &interval : static_cast<SetTransition *>(transition)->set.getIntervals()) {
+          if (interval.b >= 0) {
+            ranges.push_back({ static_cast<size_t>(std::max(interval.a, static_cast<ssize_t>(0))),
+              static_cast<size_t>(interval.b) });
+          }
+        }
+        break;
+
+      default: // Wildcards have no label, they match everything.
+        break;
+    }
+  }
+
+}
+
+LexerCharClasses::LexerCharClasses(const ATN &atn) {
+  // Whether a transition matches can only change at the boundaries of its label, so these split the characters
+  // into elementary ranges.
+  std::vector<std::pair<size_t, size_t>> ranges;
+  std::vector<size_t> labelStarts;
+  std::vector<size_t> bounds = { 0 };
+  for (ATNState *state : atn.states) {
+    if (state == nullptr || state->epsilonOnlyTransitions) {
+      continue;
+    }
+    for (Transition *transition : state->transitions) {
+      if (transition->isEpsilon()) {
+        continue;
+      }
+
+      labelStarts.push_back(ranges.size());
+      addLabel(transition, ranges);
+    }
+  }
+  labelStarts.push_back(ranges.size());
+  for (auto &range : ranges) {
+    bounds.push_back(range.first);
+    bounds.push_back(range.second + 1);
+  }
+  std::sort(bounds.begin(), bounds.end());
+  bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+  while (bounds.back() > Lexer::MAX_CHAR_VALUE) {
+    bounds.pop_back();
+  }
+
+  // Convert the ranges to the indexes of the first and last elementary range they cover.
+  for (auto &range : ranges) {
+    range.first = static_cast<size_t>(std::lower_bound(bounds.begin(), bounds.end(), range.first) - bounds.begin());
+    range.second = static_cast<size_t>(std::upper_bound(bounds.begin(), bounds.end(), range.second) - bounds.begin()) - 1;
+  }
+
+  // Ranges covered by the same labels form a class. Starting with a single class, each label splits the classes it
+  // covers into a part inside and one outside of the label.
+  std::vector<size_t> rangeClasses(bounds.size(), 0);
+  std::vector<size_t> splitLabels = { INVALID_INDEX };
+  std::vector<size_t> splitClasses = { 0 };
+  for (size_t label = 0; label + 1 < labelStarts.size(); ++label) {
+    for (size_t i = labelStarts[label]; i < labelStarts[label + 1]; ++i) {
+      for (size_t j = ranges[i].first; j <= ranges[i].second; ++j) {
+        size_t &classId = rangeClasses[j];
+        if (splitLabels[classId] != label) {
+          splitLabels[classId] = label;
+          splitClasses[classId] = splitLabels.size();
+          splitLabels.push_back(INVALID_INDEX);
+          splitClasses.push_back(0);
+        }
+        classId = splitClasses[classId];
+      }
+    }
+  }
+
+  // Number the classes in the order of their first characters (classes emptied by splits disappear).
+  std::vector<size_t> ids(splitLabels.size(), INVALID_INDEX);
+  for (size_t j = 0; j < bounds.size(); ++j) {
+    size_t &id = ids[rangeClasses[j]];
+    if (id == INVALID_INDEX) {
+      id = _representatives.size();
+      _representatives.push_back(bounds[j]);
+    }
+    rangeClasses[j] = id;
+
+    if (_classIds.empty() || _classIds.back() != id) {
+      _classStarts.push_back(static_cast<uint32_t>(bounds[j]));
+      _classIds.push_back(static_cast<uint32_t>(id));
+    }
+  }
+
+  _charClassCount = _representatives.size();
+  _representatives.push_back(static_cast<size_t>(Token::EOF));
+  _representatives.push_back(Lexer::MAX_CHAR_VALUE + 1);
+  for (size_t i = 0; i < LOW_CLASSES; ++i) {
+    _lowClasses[i] = static_cast<uint32_t>(getHighClass(i));
+  }
+
+  size_t rowCount = 0;
+  _rowWords = (_charClassCount + 2 + 63) / 64;
+  _firstRows.resize(atn.states.size(), INVALID_INDEX);
+  for (ATNState *state : atn.states) {
+    if (state != nullptr && !state->epsilonOnlyTransitions) {
+      _firstRows[state->stateNumber] = rowCount;
+      rowCount += state->transitions.size();
+    }
+  }
+  _matches.resize(rowCount * _rowWords);
+
+  // A transition matches either all characters in its label or all others (negated sets and wildcards), so one
+  // character from each side decides the match for all classes.
+  auto set = [](uint64_t *row, size_t classId, bool value) {
+    if (value) {
+      row[classId / 64] |= static_cast<uint64_t>(1) << (classId % 64);
+    } else {
+      row[classId / 64] &= ~(static_cast<uint64_t>(1) << (classId % 64));
+    }
+  };
+  size_t label = 0;
+  for (ATNState *state : atn.states) {
+    if (state == nullptr || state->epsilonOnlyTransitions) {
+      continue;
+    }
+    for (size_t i = 0; i < state->transitions.size(); ++i) {
+      Transition *transition = state->transitions[i];
+      if (transition->isEpsilon()) {
+        continue;
+      }
+
+      uint64_t *row = &_matches[(_firstRows[state->stateNumber] + i) * _rowWords];
+      size_t first = labelStarts[label];
+      size_t last = labelStarts[label + 1];
+      ++label;
+
+      // The first elementary range not in the label (ranges of a label are sorted and don't overlap).
+      size_t outside = 0;
+      for (size_t k = first; k < last && ranges[k].first == outside; ++k) {
+        outside = ranges[k].second + 1;
+      }
+      if (outside < bounds.size() &&
+          transition->matches(bounds[outside], Lexer::MIN_CHAR_VALUE, Lexer::MAX_CHAR_VALUE)) {
+        for (size_t classId = 0; classId < _charClassCount; ++classId) {
+          set(row, classId, true);
+        }
+      }
+      if (first < last) {
+        bool value = transition->matches(bounds[ranges[first].first], Lexer::MIN_CHAR_VALUE, Lexer::MAX_CHAR_VALUE);
+        for (size_t k = first; k < last; ++k) {
+          for (size_t j = ranges[k].first; j <= ranges[k].second; ++j) {
+            set(row, rangeClasses[j], value);
+          }
+        }
+      }
+      set(row, getEOFClass(), transition->matches(Token::EOF, Lexer::MIN_CHAR_VALUE, Lexer::MAX_CHAR_VALUE));
+      set(row, getOutOfRangeClass(),
+        transition->matches(Lexer::MAX_CHAR_VALUE + 1, Lexer::MIN_CHAR_VALUE, Lexer::MAX_CHAR_VALUE));
+    }
+  }
+}
+
+size_t LexerCharClasses::getRepresentative(size_t classId) const {
+  return _representatives[classId];
+}
+
+size_t LexerCharClasses::getHighClass(size_t symbol) const {
+  if (symbol == Token::EOF) {
+    return getEOFClass();
+  }
+  if (symbol > Lexer::MAX_CHAR_VALUE) {
+    return getOutOfRangeClass();
+  }
+
+  auto iterator = std::upper_bound(_classStarts.begin(), _classStarts.end(), symbol);
+  return _classIds[static_cast<size_t>(iterator - _classStarts.begin()) - 1];
+}
@@ -0,0 +1,77 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include "antlr4-common.h"
+
+namespace antlr4 {
+namespace atn {
+
+  /// Splits the input symbols of a lexer ATN into character classes: all characters which are matched by exactly the
+  /// same transitions share a class. EOF and characters outside of the Unicode range get a class of their own.
+  ///
+  /// The lexer simulator maps each input character to its class once, and then tests the transitions of all
+  /// configurations with a bit lookup, instead of searching the interval set of every set transition. The classes
+  /// of lexer ATNs are computed by the deserializer (see ATN::charClasses).
+  class ANTLR4CPP_PUBLIC LexerCharClasses {
+  public:
+    LexerCharClasses(const ATN &atn);
+    LexerCharClasses(const LexerCharClasses &other) = delete;
+
+    LexerCharClasses& operator = (const LexerCharClasses &other) = delete;
+
+    /// The number of classes for characters in the Unicode range. Their ids are 0..getCharClassCount() - 1,
+    /// followed by getEOFClass() and getOutOfRangeClass().
+    size_t getCharClassCount() const {
+      return _charClassCount;
+    }
+
+    size_t getEOFClass() const {
+      return _charClassCount;
+    }
+
+    size_t getOutOfRangeClass() const {
+      return _charClassCount + 1;
+    }
+
+    /// Returns the class of an input symbol (a character or EOF).
+    size_t getClass(size_t symbol) const {
+      return symbol < LOW_CLASSES ? _lowClasses[symbol] : getHighClass(symbol);
+    }
+
+    /// Returns some symbol of the given class.
+    size_t getRepresentative(size_t classId) const;
+
+    /// Returns true if the transition with the given index of the state (by number) matches the symbols of a class.
+    /// Epsilon transitions never match.
+    bool matches(size_t stateNumber, size_t transitionIndex, size_t classId) const {
+      size_t row = _firstRows[stateNumber];
+      if (row == INVALID_INDEX) {
+        return false;
+      }
+      return (_matches[(row + transitionIndex) * _rowWords + classId / 64] >> (classId % 64)) & 1;
+    }
+
+  private:
+    // Classes of the first characters are looked up directly, all others with a binary search.
+    static const size_t LOW_CLASSES = 256;
+
+    size_t _charClassCount;
+    uint32_t _lowClasses[LOW_CLASSES];
+    std::vector<uint32_t> _classStarts; // First character of each range of characters with the same class.
+    std::vector<uint32_t> _classIds;
+    std::vector<size_t> _representatives;
+
+    // One row of bits per transition of a state with non-epsilon transitions, one bit per class.
+    size_t _rowWords;
+    std::vector<size_t> _firstRows; // Indexed by state number, INVALID_INDEX for epsilon only states.
+    std::vector<uint64_t> _matches;
+
+    size_t getHighClass(size_t symbol) const;
+  };
+
+} // namespace atn
+} // namespace antlr4
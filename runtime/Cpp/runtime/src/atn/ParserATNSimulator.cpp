@@ -11,6 +11,7 @@
 #include "Parser.h"
 #include "CommonTokenStream.h"
 #include "atn/EmptyPredictionContext.h"
+#include "atn/ArrayPredictionContext.h"
 #include "atn/NotSetTransition.h"
 #include "atn/AtomTransition.h"
 #include "atn/RuleTransition.h"
@@ -44,6 +45,34 @@ using namespace antlr4::atn;
 
 using namespace antlrcpp;
 
+namespace {
+
+  // A singleton context placed in the prediction arena, which returns its memory to the arena when released.
+  class ArenaSingletonPredictionContext final : public SingletonPredictionContext {
+  public:
+    ArenaSingletonPredictionContext(Arena *arena, RefPtr<PredictionContext> const& parent, size_t returnState)
+      : SingletonPredictionContext(parent, returnState), _arena(arena) {
+    }
+
+    static RefPtr<PredictionContext> create(Arena *arena, RefPtr<PredictionContext> const& parent, size_t returnState) {
+      void *memory = arena->allocate(sizeof(ArenaSingletonPredictionContext));
+      return RefPtr<PredictionContext>(new (memory) ArenaSingletonPredictionContext(arena, parent, returnState));
+    }
+
+  protected:
+    virtual void destroy() const override {
+      Arena *arena = _arena;
+      const void *memory = this;
+      this->~ArenaSingletonPredictionContext();
+      arena->deallocate(const_cast<void *>(memory));
+    }
+
+  private:
+    Arena *_arena;
+  };
+
+}
+
 const bool ParserATNSimulator::TURN_OFF_LR_LOOP_ENTRY_BRANCH_OPT = ParserATNSimulator::getLrLoopSetting();
 
 ParserATNSimulator::ParserATNSimulator(const ATN &atn, std::vector<dfa::DFA> &decisionToDFA,
@@ -57,14 +86,16 @@ ParserATNSimulator::ParserATNSimulator(Parser *parser, const ATN &atn, std::vect
   InitializeInstanceFields();
 }
 
+ParserATNSimulator::~ParserATNSimulator() {
+  _arena->release();
+}
+
 void ParserATNSimulator::reset() {
 }
 
 void ParserATNSimulator::clearDFA() {
-  int size = (int)decisionToDFA.size();
-  decisionToDFA.clear();
-  for (int d = 0; d < size; ++d) {
-    decisionToDFA.push_back(dfa::DFA(atn.getDecisionState(d), d));
+  for (auto &dfa : decisionToDFA) {
+    dfa.reset();
   }
 }
 
@@ -81,6 +112,9 @@ size_t ParserATNSimulator::adaptivePredict(TokenStream *input, size_t decision,
   dfa::DFA &dfa = decisionToDFA[decision];
   _dfa = &dfa;
 
+  // Keeps the states we walk alive, should the DFA be reset meanwhile.
+  dfa::DFA::EpochGuard epochGuard(dfa);
+
   ssize_t m = input->mark();
   size_t index = _startIndex;
 
@@ -88,6 +122,15 @@ size_t ParserATNSimulator::adaptivePredict(TokenStream *input, size_t decision,
   // But, do we still need an initial state?
   auto onExit = finally([this, input, index, m] {
     mergeCache.clear(); // wack cache after each prediction
+
+    // All configs and contexts of this prediction should be gone by now. If some escaped (e.g. in an exception)
+    // the arena stays alive until they are released, and we continue with a fresh one.
+    if (_arena->isUnused()) {
+      _arena->rewind();
+    } else {
+      _arena->release();
+      _arena = antlrcpp::Arena::create();
+    }
     _dfa = nullptr;
     input->seek(index);
     input->release(m);
@@ -108,7 +151,7 @@ size_t ParserATNSimulator::adaptivePredict(TokenStream *input, size_t decision,
     std::unique_ptr<ATNConfigSet> s0_closure = computeStartState(dynamic_cast<ATNState *>(dfa.atnStartState),
                                                                  &ParserRuleContext::EMPTY, fullCtx);
 
-    _stateLock.writeLock();
+    std::lock_guard<std::mutex> lck(dfa.getLock());
     if (dfa.isPrecedenceDfa()) {
       /* If this is a precedence DFA, we use applyPrecedenceFilter
        * to convert the computed start state to a precedence start
@@ -116,24 +159,26 @@ size_t ParserATNSimulator::adaptivePredict(TokenStream *input, size_t decision,
        * appropriate start state for the precedence level rather
        * than simply setting DFA.s0.
        */
-      dfa.s0->configs = std::move(s0_closure); // not used for prediction but useful to know start configs anyway
-      dfa::DFAState *newState = new dfa::DFAState(applyPrecedenceFilter(dfa.s0->configs.get())); /* mem-check: managed by the DFA or deleted below */
-      s0 = addDFAState(dfa, newState);
-      dfa.setPrecedenceStartState(parser->getPrecedence(), s0, _edgeLock);
+      dfa::DFAState *start = dfa.s0;
+      promoteConfigs(s0_closure.get());
+      start->configs = std::move(s0_closure); // not used for prediction but useful to know start configs anyway
+      dfa::DFAState *newState = new dfa::DFAState(applyPrecedenceFilter(start->configs.get())); /* mem-check: managed by the DFA or deleted below */
+      s0 = addDFAStartState(dfa, newState);
+      dfa.setPrecedenceStartState(parser->getPrecedence(), s0);
       if (s0 != newState) {
         delete newState; // If there was already a state with this config set we don't need the new one.
       }
     } else {
       dfa::DFAState *newState = new dfa::DFAState(std::move(s0_closure)); /* mem-check: managed by the DFA or deleted below */
-      s0 = addDFAState(dfa, newState);
+      s0 = addDFAStartState(dfa, newState);
 
-      delete dfa.s0; // Delete existing s0 DFA state, if there's any. 
+      // Another thread may have set s0 meanwhile. It's always a state of this DFA (and hence owned by it)
+      // and addDFAState returned exactly that state if the configs are equal.
       dfa.s0 = s0;
       if (s0 != newState) {
         delete newState; // If there was already a state with this config set we don't need the new one.
       }
     }
-    _stateLock.writeUnlock();
   }
 
   // We can start with an existing DFA.
@@ -161,6 +206,13 @@ size_t ParserATNSimulator::execATN(dfa::DFA &dfa, dfa::DFAState *s0, TokenStream
   while (true) { // while more work
     dfa::DFAState *D = getExistingTargetState(previousD, t);
     if (D == nullptr) {
+      if (previousD->configs == nullptr) {
+        // The configs of this state were released (compact DFA, see addDFAState()), so its targets can't be computed.
+        // This can't happen for start states (see addDFAStartState()) and predictions end in all other such states.
+        // Should it happen anyway, fall back to simulating the ATN with full context, which doesn't use the DFA.
+        std::unique_ptr<ATNConfigSet> s0_closure = computeStartState(dfa.atnStartState, outerContext, true);
+        return execATNWithFullContext(dfa, previousD, s0_closure.get(), input, startIndex, outerContext);
+      }
       D = computeTargetState(dfa, previousD, t);
     }
 
@@ -257,14 +309,8 @@ size_t ParserATNSimulator::execATN(dfa::DFA &dfa, dfa::DFAState *s0, TokenStream
 }
 
 dfa::DFAState *ParserATNSimulator::getExistingTargetState(dfa::DFAState *previousD, size_t t) {
-  _edgeLock.readLock();
-  auto iterator = previousD->edges.find(t);
-  _edgeLock.readUnlock();
-  if (iterator == previousD->edges.end()) {
-    return nullptr;
-  }
-
-  return iterator->second;
+  // Lock-free: edges are published only after their target state has been fully constructed.
+  return previousD->edges.get(t);
 }
 
 dfa::DFAState *ParserATNSimulator::computeTargetState(dfa::DFA &dfa, dfa::DFAState *previousD, size_t t) {
@@ -315,7 +361,7 @@ void ParserATNSimulator::predicateDFAState(dfa::DFAState *dfaState, DecisionStat
   // Update DFA so reach becomes accept state with (predicate,alt)
   // pairs if preds found for conflicting alts
   BitSet altsToCollectPredsFrom = getConflictingAltsOrUniqueAlt(dfaState->configs.get());
-  std::vector<Ref<SemanticContext>> altToPred = getPredsForAmbigAlts(altsToCollectPredsFrom, dfaState->configs.get(), nalts);
+  std::vector<RefPtr<SemanticContext>> altToPred = getPredsForAmbigAlts(altsToCollectPredsFrom, dfaState->configs.get(), nalts);
   if (!altToPred.empty()) {
     dfaState->predicates = getPredicatePredictions(altsToCollectPredsFrom, altToPred);
     dfaState->prediction = ATN::INVALID_ALT_NUMBER; // make sure we use preds
@@ -453,7 +499,7 @@ std::unique_ptr<ATNConfigSet> ParserATNSimulator::computeReachSet(ATNConfigSet *
 
   // First figure out where we can reach on input t
   for (auto &c : closure_->configs) {
-    if (is<RuleStopState *>(c->state)) {
+    if (c->state->getStateType() == ATNState::RULE_STOP) {
       assert(c->context->isEmpty());
 
       if (fullCtx || t == Token::EOF) {
@@ -468,7 +514,7 @@ std::unique_ptr<ATNConfigSet> ParserATNSimulator::computeReachSet(ATNConfigSet *
       Transition *trans = c->state->transitions[ti];
       ATNState *target = getReachableTarget(trans, (int)t);
       if (target != nullptr) {
-        intermediate->add(std::make_shared<ATNConfig>(c, target), &mergeCache);
+        intermediate->add(createConfig(c, target), &mergeCache);
       }
     }
   }
@@ -566,7 +612,7 @@ ATNConfigSet* ParserATNSimulator::removeAllConfigsNotInRuleStopState(ATNConfigSe
   ATNConfigSet *result = new ATNConfigSet(configs->fullCtx); /* mem-check: released by caller */
 
   for (auto &config : configs->configs) {
-    if (is<RuleStopState*>(config->state)) {
+    if (config->state->getStateType() == ATNState::RULE_STOP) {
       result->add(config, &mergeCache);
       continue;
     }
@@ -575,7 +621,7 @@ ATNConfigSet* ParserATNSimulator::removeAllConfigsNotInRuleStopState(ATNConfigSe
       misc::IntervalSet nextTokens = atn.nextTokens(config->state);
       if (nextTokens.contains(Token::EPSILON)) {
         ATNState *endOfRuleState = atn.ruleToStopState[config->state->ruleIndex];
-        result->add(std::make_shared<ATNConfig>(config, endOfRuleState), &mergeCache);
+        result->add(createConfig(config, endOfRuleState), &mergeCache);
       }
     }
   }
@@ -585,12 +631,12 @@ ATNConfigSet* ParserATNSimulator::removeAllConfigsNotInRuleStopState(ATNConfigSe
 
 std::unique_ptr<ATNConfigSet> ParserATNSimulator::computeStartState(ATNState *p, RuleContext *ctx, bool fullCtx) {
   // always at least the implicit call to start rule
-  Ref<PredictionContext> initialContext = PredictionContext::fromRuleContext(atn, ctx);
+  RefPtr<PredictionContext> initialContext = PredictionContext::fromRuleContext(atn, ctx);
   std::unique_ptr<ATNConfigSet> configs(new ATNConfigSet(fullCtx));
 
   for (size_t i = 0; i < p->transitions.size(); i++) {
     ATNState *target = p->transitions[i]->target;
-    Ref<ATNConfig> c = std::make_shared<ATNConfig>(target, (int)i + 1, initialContext);
+    Ref<ATNConfig> c = createConfig(target, (int)i + 1, initialContext);
     ATNConfig::Set closureBusy;
     closure(c, configs.get(), closureBusy, true, fullCtx, false);
   }
@@ -599,7 +645,7 @@ std::unique_ptr<ATNConfigSet> ParserATNSimulator::computeStartState(ATNState *p,
 }
 
 std::unique_ptr<ATNConfigSet> ParserATNSimulator::applyPrecedenceFilter(ATNConfigSet *configs) {
-  std::map<size_t, Ref<PredictionContext>> statesFromAlt1;
+  std::map<size_t, RefPtr<PredictionContext>> statesFromAlt1;
   std::unique_ptr<ATNConfigSet> configSet(new ATNConfigSet(configs->fullCtx));
   for (Ref<ATNConfig> &config : configs->configs) {
     // handle alt 1 first
@@ -607,7 +653,7 @@ std::unique_ptr<ATNConfigSet> ParserATNSimulator::applyPrecedenceFilter(ATNConfi
       continue;
     }
 
-    Ref<SemanticContext> updatedContext = config->semanticContext->evalPrecedence(parser, _outerContext);
+    RefPtr<SemanticContext> updatedContext = config->semanticContext->evalPrecedence(parser, _outerContext);
     if (updatedContext == nullptr) {
       // the configuration was eliminated
       continue;
@@ -615,7 +661,7 @@ std::unique_ptr<ATNConfigSet> ParserATNSimulator::applyPrecedenceFilter(ATNConfi
 
     statesFromAlt1[config->state->stateNumber] = config->context;
     if (updatedContext != config->semanticContext) {
-      configSet->add(std::make_shared<ATNConfig>(config, updatedContext), &mergeCache);
+      configSet->add(createConfig(config, updatedContext), &mergeCache);
     }
     else {
       configSet->add(config, &mergeCache);
@@ -655,7 +701,7 @@ atn::ATNState* ParserATNSimulator::getReachableTarget(Transition *trans, size_t
 }
 
 // Note that caller must memory manage the returned value from this function
-std::vector<Ref<SemanticContext>> ParserATNSimulator::getPredsForAmbigAlts(const BitSet &ambigAlts,
+std::vector<RefPtr<SemanticContext>> ParserATNSimulator::getPredsForAmbigAlts(const BitSet &ambigAlts,
   ATNConfigSet *configs, size_t nalts) {
   // REACH=[1|1|[]|0:0, 1|2|[]|0:1]
   /* altToPred starts as an array of all null contexts. The entry at index i
@@ -669,7 +715,7 @@ std::vector<Ref<SemanticContext>> ParserATNSimulator::getPredsForAmbigAlts(const
    *
    * From this, it is clear that NONE||anything==NONE.
    */
-  std::vector<Ref<SemanticContext>> altToPred(nalts + 1);
+  std::vector<RefPtr<SemanticContext>> altToPred(nalts + 1);
 
   for (auto &c : configs->configs) {
     if (ambigAlts.test(c->alt)) {
@@ -698,11 +744,11 @@ std::vector<Ref<SemanticContext>> ParserATNSimulator::getPredsForAmbigAlts(const
 }
 
 std::vector<dfa::DFAState::PredPrediction *> ParserATNSimulator::getPredicatePredictions(const antlrcpp::BitSet &ambigAlts,
-  std::vector<Ref<SemanticContext>> altToPred) {
+  std::vector<RefPtr<SemanticContext>> altToPred) {
   std::vector<dfa::DFAState::PredPrediction*> pairs;
   bool containsPredicate = false;
   for (size_t i = 1; i < altToPred.size(); i++) {
-    Ref<SemanticContext> pred = altToPred[i];
+    RefPtr<SemanticContext> pred = altToPred[i];
 
     // unpredicted is indicated by SemanticContext.NONE
     assert(pred != nullptr);
@@ -745,7 +791,7 @@ size_t ParserATNSimulator::getSynValidOrSemInvalidAltThatFinishedDecisionEntryRu
 size_t ParserATNSimulator::getAltThatFinishedDecisionEntryRule(ATNConfigSet *configs) {
   misc::IntervalSet alts;
   for (auto &c : configs->configs) {
-    if (c->getOuterContextDepth() > 0 || (is<RuleStopState *>(c->state) && c->context->hasEmptyPath())) {
+    if (c->getOuterContextDepth() > 0 || (c->state->getStateType() == ATNState::RULE_STOP && c->context->hasEmptyPath())) {
       alts.add(c->alt);
     }
   }
@@ -809,7 +855,7 @@ BitSet ParserATNSimulator::evalSemanticContext(std::vector<dfa::DFAState::PredPr
   return predictions;
 }
 
-bool ParserATNSimulator::evalSemanticContext(Ref<SemanticContext> const& pred, ParserRuleContext *parserCallStack,
+bool ParserATNSimulator::evalSemanticContext(RefPtr<SemanticContext> const& pred, ParserRuleContext *parserCallStack,
                                              size_t /*alt*/, bool /*fullCtx*/) {
   return pred->eval(parser, parserCallStack);
 }
@@ -829,14 +875,14 @@ void ParserATNSimulator::closureCheckingStopState(Ref<ATNConfig> const& config,
     std::cout << "closure(" << config->toString(true) << ")" << std::endl;
 #endif
 
-  if (is<RuleStopState *>(config->state)) {
+  if (config->state->getStateType() == ATNState::RULE_STOP) {
     // We hit rule end. If we have context info, use it
     // run thru all possible stack tops in ctx
     if (!config->context->isEmpty()) {
       for (size_t i = 0; i < config->context->size(); i++) {
         if (config->context->getReturnState(i) == PredictionContext::EMPTY_RETURN_STATE) {
           if (fullCtx) {
-            configs->add(std::make_shared<ATNConfig>(config, config->state, PredictionContext::EMPTY), &mergeCache);
+            configs->add(createConfig(config, config->state, PredictionContext::EMPTY), &mergeCache);
             continue;
           } else {
             // we have no context info, just chase follow links (if greedy)
@@ -848,8 +894,8 @@ void ParserATNSimulator::closureCheckingStopState(Ref<ATNConfig> const& config,
           continue;
         }
         ATNState *returnState = atn.states[config->context->getReturnState(i)];
-        std::weak_ptr<PredictionContext> newContext = config->context->getParent(i); // "pop" return state
-        Ref<ATNConfig> c = std::make_shared<ATNConfig>(returnState, config->alt, newContext.lock(), config->semanticContext);
+        RefPtr<PredictionContext> newContext = config->context->getParent(i); // "pop" return state
+        Ref<ATNConfig> c = createConfig(returnState, config->alt, newContext, config->semanticContext);
         // While we have context to pop back from, we may have
         // gotten that context AFTER having falling off a rule.
         // Make sure we track that we are now out of context.
@@ -890,7 +936,7 @@ void ParserATNSimulator::closure_(Ref<ATNConfig> const& config, ATNConfigSet *co
       continue;
 
     Transition *t = p->transitions[i];
-    bool continueCollecting = !is<ActionTransition*>(t) && collectPredicates;
+    bool continueCollecting = t->getSerializationType() != Transition::ACTION && collectPredicates;
     Ref<ATNConfig> c = getEpsilonTarget(config, t, continueCollecting, depth == 0, fullCtx, treatEofAsEpsilon);
     if (c != nullptr) {
       if (!t->isEpsilon()) {
@@ -903,7 +949,7 @@ void ParserATNSimulator::closure_(Ref<ATNConfig> const& config, ATNConfigSet *co
       }
 
       int newDepth = depth;
-      if (is<RuleStopState*>(config->state)) {
+      if (config->state->getStateType() == ATNState::RULE_STOP) {
         assert(!fullCtx);
 
         // target fell off end of rule; mark resulting c as having dipped into outer context
@@ -919,7 +965,7 @@ void ParserATNSimulator::closure_(Ref<ATNConfig> const& config, ATNConfigSet *co
         closureBusy.insert(c);
 
         if (_dfa != nullptr && _dfa->isPrecedenceDfa()) {
-          size_t outermostPrecedenceReturn = dynamic_cast<EpsilonTransition *>(t)->outermostPrecedenceReturn();
+          size_t outermostPrecedenceReturn = static_cast<EpsilonTransition *>(t)->outermostPrecedenceReturn();
           if (outermostPrecedenceReturn == _dfa->atnStartState->ruleIndex) {
             c->setPrecedenceFilterSuppressed(true);
           }
@@ -934,7 +980,7 @@ void ParserATNSimulator::closure_(Ref<ATNConfig> const& config, ATNConfigSet *co
           std::cout << "dips into outer ctx: " << c << std::endl;
 #endif
 
-      } else if (is<RuleTransition*>(t)) {
+      } else if (t->getSerializationType() == Transition::RULE) {
         // latch when newDepth goes negative - once we step out of the entry context we can't return
         if (newDepth >= 0) {
           newDepth++;
@@ -1047,7 +1093,7 @@ Ref<ATNConfig> ParserATNSimulator::getEpsilonTarget(Ref<ATNConfig> const& config
       return actionTransition(config, static_cast<ActionTransition*>(t));
 
     case Transition::EPSILON:
-      return std::make_shared<ATNConfig>(config, t->target);
+      return createConfig(config, t->target);
 
     case Transition::ATOM:
     case Transition::RANGE:
@@ -1056,7 +1102,7 @@ Ref<ATNConfig> ParserATNSimulator::getEpsilonTarget(Ref<ATNConfig> const& config
       // transition is traversed
       if (treatEofAsEpsilon) {
         if (t->matches(Token::EOF, 0, 1)) {
-          return std::make_shared<ATNConfig>(config, t->target);
+          return createConfig(config, t->target);
         }
       }
 
@@ -1072,7 +1118,7 @@ Ref<ATNConfig> ParserATNSimulator::actionTransition(Ref<ATNConfig> const& config
     std::cout << "ACTION edge " << t->ruleIndex << ":" << t->actionIndex << std::endl;
 #endif
 
-  return std::make_shared<ATNConfig>(config, t->target);
+  return createConfig(config, t->target);
 }
 
 Ref<ATNConfig> ParserATNSimulator::precedenceTransition(Ref<ATNConfig> const& config, PrecedencePredicateTransition *pt,
@@ -1086,7 +1132,7 @@ Ref<ATNConfig> ParserATNSimulator::precedenceTransition(Ref<ATNConfig> const& co
 
   Ref<ATNConfig> c;
   if (collectPredicates && inContext) {
-    Ref<SemanticContext::PrecedencePredicate> predicate = pt->getPredicate();
+    RefPtr<SemanticContext::PrecedencePredicate> predicate = pt->getPredicate();
 
     if (fullCtx) {
       // In full context mode, we can evaluate predicates on-the-fly
@@ -1098,14 +1144,14 @@ Ref<ATNConfig> ParserATNSimulator::precedenceTransition(Ref<ATNConfig> const& co
       bool predSucceeds = evalSemanticContext(pt->getPredicate(), _outerContext, config->alt, fullCtx);
       _input->seek(currentPosition);
       if (predSucceeds) {
-        c = std::make_shared<ATNConfig>(config, pt->target); // no pred context
+        c = createConfig(config, pt->target); // no pred context
       }
     } else {
-      Ref<SemanticContext> newSemCtx = SemanticContext::And(config->semanticContext, predicate);
-      c = std::make_shared<ATNConfig>(config, pt->target, newSemCtx);
+      RefPtr<SemanticContext> newSemCtx = SemanticContext::And(config->semanticContext, predicate);
+      c = createConfig(config, pt->target, newSemCtx);
     }
   } else {
-    c = std::make_shared<ATNConfig>(config, pt->target);
+    c = createConfig(config, pt->target);
   }
 
 #if DEBUG_DFA == 1
@@ -1126,7 +1172,7 @@ Ref<ATNConfig> ParserATNSimulator::predTransition(Ref<ATNConfig> const& config,
 
   Ref<ATNConfig> c = nullptr;
   if (collectPredicates && (!pt->isCtxDependent || (pt->isCtxDependent && inContext))) {
-    Ref<SemanticContext::Predicate> predicate = pt->getPredicate();
+    RefPtr<SemanticContext::Predicate> predicate = pt->getPredicate();
     if (fullCtx) {
       // In full context mode, we can evaluate predicates on-the-fly
       // during closure, which dramatically reduces the size of
@@ -1137,14 +1183,14 @@ Ref<ATNConfig> ParserATNSimulator::predTransition(Ref<ATNConfig> const& config,
       bool predSucceeds = evalSemanticContext(pt->getPredicate(), _outerContext, config->alt, fullCtx);
       _input->seek(currentPosition);
       if (predSucceeds) {
-        c = std::make_shared<ATNConfig>(config, pt->target); // no pred context
+        c = createConfig(config, pt->target); // no pred context
       }
     } else {
-      Ref<SemanticContext> newSemCtx = SemanticContext::And(config->semanticContext, predicate);
-      c = std::make_shared<ATNConfig>(config, pt->target, newSemCtx);
+      RefPtr<SemanticContext> newSemCtx = SemanticContext::And(config->semanticContext, predicate);
+      c = createConfig(config, pt->target, newSemCtx);
     }
   } else {
-    c = std::make_shared<ATNConfig>(config, pt->target);
+    c = createConfig(config, pt->target);
   }
 
 #if DEBUG_DFA == 1
@@ -1160,8 +1206,9 @@ Ref<ATNConfig> ParserATNSimulator::ruleTransition(Ref<ATNConfig> const& config,
 #endif
 
   atn::ATNState *returnState = t->followState;
-  Ref<PredictionContext> newContext = SingletonPredictionContext::create(config->context, returnState->stateNumber);
-  return std::make_shared<ATNConfig>(config, t->target, newContext);
+  RefPtr<PredictionContext> newContext = ArenaSingletonPredictionContext::create(_arena, config->context,
+    returnState->stateNumber);
+  return createConfig(config, t->target, newContext);
 }
 
 BitSet ParserATNSimulator::getConflictingAlts(ATNConfigSet *configs) {
@@ -1203,12 +1250,12 @@ void ParserATNSimulator::dumpDeadEndConfigs(NoViableAltException &nvae) {
     std::string trans = "no edges";
     if (c->state->transitions.size() > 0) {
       Transition *t = c->state->transitions[0];
-      if (is<AtomTransition*>(t)) {
+      if (t->getSerializationType() == Transition::ATOM) {
         AtomTransition *at = static_cast<AtomTransition*>(t);
         trans = "Atom " + getTokenName(at->_label);
-      } else if (is<SetTransition*>(t)) {
+      } else if (t->getSerializationType() == Transition::SET || t->getSerializationType() == Transition::NOT_SET) {
         SetTransition *st = static_cast<SetTransition*>(t);
-        bool is_not = is<NotSetTransition*>(st);
+        bool is_not = st->getSerializationType() == Transition::NOT_SET;
         trans = (is_not ? "~" : "");
         trans += "Set ";
         trans += st->set.toString();
@@ -1244,18 +1291,13 @@ dfa::DFAState *ParserATNSimulator::addDFAEdge(dfa::DFA &dfa, dfa::DFAState *from
     return nullptr;
   }
 
-  _stateLock.writeLock();
+  std::lock_guard<std::mutex> lck(dfa.getLock());
   to = addDFAState(dfa, to); // used existing if possible not incoming
-  _stateLock.writeUnlock();
   if (from == nullptr || t > (int)atn.maxTokenType) {
     return to;
   }
 
-  {
-    _edgeLock.writeLock();
-    from->edges[t] = to; // connect
-    _edgeLock.writeUnlock();
-  }
+  dfa.addEdge(from, t, to); // connect
 
 #if DEBUG_DFA == 1
     std::string dfaText;
@@ -1275,18 +1317,24 @@ dfa::DFAState *ParserATNSimulator::addDFAState(dfa::DFA &dfa, dfa::DFAState *D)
     return D;
   }
 
-  auto existing = dfa.states.find(D);
-  if (existing != dfa.states.end()) {
-    return *existing;
+  dfa::DFAState *existing = dfa.findState(D);
+  if (existing != nullptr) {
+    return existing;
   }
 
-  D->stateNumber = (int)dfa.states.size();
   if (!D->configs->isReadonly()) {
+    promoteConfigs(D->configs.get());
     D->configs->optimizeConfigs(this);
     D->configs->setReadonly(true);
   }
 
-  dfa.states.insert(D);
+  dfa.addState(D);
+
+  // Predictions end in accept states, so their configs are only used again for full context prediction or when
+  // evaluating predicates.
+  if (dfa.hasCompactStates() && D->isAcceptState && !D->requiresFullContext && D->predicates.empty()) {
+    dfa.releaseConfigs(D);
+  }
 
 #if DEBUG_DFA == 1
   std::cout << "adding new DFA state: " << D << std::endl;
@@ -1295,6 +1343,63 @@ dfa::DFAState *ParserATNSimulator::addDFAState(dfa::DFA &dfa, dfa::DFAState *D)
   return D;
 }
 
+dfa::DFAState *ParserATNSimulator::addDFAStartState(dfa::DFA &dfa, dfa::DFAState *D) {
+  dfa::DFAState *state = addDFAState(dfa, D);
+  if (state->configs == nullptr) {
+    promoteConfigs(D->configs.get());
+    D->configs->optimizeConfigs(this);
+    D->configs->setReadonly(true);
+    dfa.restoreConfigs(state, std::move(D->configs));
+  }
+  return state;
+}
+
+void ParserATNSimulator::promoteConfigs(ATNConfigSet *configs) {
+  PredictionContextVisitedMap visited;
+  for (auto &config : configs->configs) {
+    if (_arena->owns(config.get())) {
+      config = std::make_shared<ATNConfig>(*config);
+    }
+    RefPtr<PredictionContext> context = promoteContext(config->context, visited);
+    if (context != config->context) {
+      config->context = context;
+    }
+  }
+}
+
+RefPtr<PredictionContext> ParserATNSimulator::promoteContext(RefPtr<PredictionContext> const& context,
+  PredictionContextVisitedMap &visited) {
+  if (context->isEmpty()) {
+    return context;
+  }
+
+  auto iterator = visited.find(context);
+  if (iterator != visited.end()) {
+    return iterator->second;
+  }
+
+  // Heap allocated contexts (e.g. merge results) can still have parents in the arena.
+  bool changed = _arena->owns(context.get());
+  std::vector<RefPtr<PredictionContext>> parents;
+  for (size_t i = 0; i < context->size(); ++i) {
+    parents.push_back(promoteContext(context->getParent(i), visited));
+    changed |= parents.back() != context->getParent(i);
+  }
+
+  RefPtr<PredictionContext> result = context;
+  if (changed) {
+    if (parents.size() == 1) {
+      result = SingletonPredictionContext::create(parents[0], context->getReturnState(0));
+    } else {
+      result = antlrcpp::makeRefPtr<ArrayPredictionContext>(parents,
+        antlrcpp::static_pointer_cast<ArrayPredictionContext>(context)->returnStates);
+    }
+  }
+
+  visited[context] = result;
+  return result;
+}
+
 void ParserATNSimulator::reportAttemptingFullContext(dfa::DFA &dfa, const antlrcpp::BitSet &conflictingAlts,
   ATNConfigSet *configs, size_t startIndex, size_t stopIndex) {
 #if DEBUG_DFA == 1 || RETRY_DEBUG == 1
@@ -1354,4 +1459,5 @@ bool ParserATNSimulator::getLrLoopSetting() {
 void ParserATNSimulator::InitializeInstanceFields() {
   _mode = PredictionMode::LL;
   _startIndex = 0;
+  _arena = antlrcpp::Arena::create();
 }
@@ -11,6 +11,7 @@
 #include "atn/PredictionContext.h"
 #include "SemanticContext.h"
 #include "atn/ATNConfig.h"
+#include "support/Arena.h"
 
 namespace antlr4 {
 namespace atn {
@@ -250,6 +251,7 @@ namespace atn {
 
     ParserATNSimulator(Parser *parser, const ATN &atn, std::vector<dfa::DFA> &decisionToDFA,
                        PredictionContextCache &sharedContextCache);
+    virtual ~ParserATNSimulator();
 
     virtual void reset() override;
     virtual void clearDFA() override;
@@ -648,11 +650,11 @@ namespace atn {
 
     virtual ATNState *getReachableTarget(Transition *trans, size_t ttype);
 
-    virtual std::vector<Ref<SemanticContext>> getPredsForAmbigAlts(const antlrcpp::BitSet &ambigAlts,
+    virtual std::vector<RefPtr<SemanticContext>> getPredsForAmbigAlts(const antlrcpp::BitSet &ambigAlts,
                                                                    ATNConfigSet *configs, size_t nalts);
 
     virtual std::vector<dfa::DFAState::PredPrediction*> getPredicatePredictions(const antlrcpp::BitSet &ambigAlts,
-                                                                                std::vector<Ref<SemanticContext>> altToPred);
+                                                                                std::vector<RefPtr<SemanticContext>> altToPred);
 
     /**
      * This method is used to improve the localization of error messages by
@@ -757,7 +759,7 @@ namespace atn {
      *
      * @since 4.3
      */
-    virtual bool evalSemanticContext(Ref<SemanticContext> const& pred, ParserRuleContext *parserCallStack,
+    virtual bool evalSemanticContext(RefPtr<SemanticContext> const& pred, ParserRuleContext *parserCallStack,
                                      size_t alt, bool fullCtx);
 
     /* TO_DO: If we are doing predicates, there is no point in pursuing
@@ -877,6 +879,11 @@ namespace atn {
     /// state was not already present. </returns>
     virtual dfa::DFAState *addDFAState(dfa::DFA &dfa, dfa::DFAState *D);
 
+    /// Like addDFAState(), for a state which becomes a start state (s0 or a precedence start state). Predictions
+    /// compute the targets of start states from their configs, so if the existing state of a compact DFA had its
+    /// configs released, it gets those of {@code D} back.
+    dfa::DFAState *addDFAStartState(dfa::DFA &dfa, dfa::DFAState *D);
+
     virtual void reportAttemptingFullContext(dfa::DFA &dfa, const antlrcpp::BitSet &conflictingAlts,
       ATNConfigSet *configs, size_t startIndex, size_t stopIndex);
 
@@ -891,10 +898,26 @@ namespace atn {
                                  const antlrcpp::BitSet &ambigAlts,
                                  ATNConfigSet *configs); // configs that LL not SLL considered conflicting
 
+    /// Creates a config in the prediction arena. Most configs only live for a single prediction, so this avoids
+    /// the system allocator for them. Configs which end up in a DFA state are copied out by promoteConfigs().
+    template <typename... Args>
+    Ref<ATNConfig> createConfig(Args&&... args) {
+      return std::allocate_shared<ATNConfig>(antlrcpp::ArenaAllocator<ATNConfig>(_arena), std::forward<Args>(args)...);
+    }
+
+    /// Replaces all arena allocated configs (and prediction contexts) in the given set by heap allocated copies,
+    /// before the set is stored in the DFA and hence outlives the current prediction.
+    void promoteConfigs(ATNConfigSet *configs);
+    RefPtr<PredictionContext> promoteContext(RefPtr<PredictionContext> const& context,
+                                          PredictionContextVisitedMap &visited);
+
   private:
     // SLL, LL, or LL + exact ambig detection?
     PredictionMode _mode;
 
+    // Bump allocator for the transient configs and contexts of a prediction. Rewound after each prediction.
+    antlrcpp::Arena *_arena;
+
     static bool getLrLoopSetting();
     void InitializeInstanceFields();
   };
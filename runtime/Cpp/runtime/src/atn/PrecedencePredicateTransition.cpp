@@ -23,8 +23,8 @@ bool PrecedencePredicateTransition::matches(size_t /*symbol*/, size_t /*minVocab
   return false;
 }
 
-Ref<SemanticContext::PrecedencePredicate> PrecedencePredicateTransition::getPredicate() const {
-  return std::make_shared<SemanticContext::PrecedencePredicate>(precedence);
+RefPtr<SemanticContext::PrecedencePredicate> PrecedencePredicateTransition::getPredicate() const {
+  return antlrcpp::makeRefPtr<SemanticContext::PrecedencePredicate>(precedence);
 }
 
 std::string PrecedencePredicateTransition::toString() const {
@@ -20,7 +20,7 @@ namespace atn {
     virtual SerializationType getSerializationType() const override;
     virtual bool isEpsilon() const override;
     virtual bool matches(size_t symbol, size_t minVocabSymbol, size_t maxVocabSymbol) const override;
-    Ref<SemanticContext::PrecedencePredicate> getPredicate() const;
+    RefPtr<SemanticContext::PrecedencePredicate> getPredicate() const;
     virtual std::string toString() const override;
 
   };
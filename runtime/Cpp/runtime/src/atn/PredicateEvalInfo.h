@@ -6,6 +6,7 @@
 #pragma once
 
 #include "atn/DecisionEventInfo.h"
+#include "atn/SemanticContext.h"
 
 namespace antlr4 {
 namespace atn {
@@ -20,7 +21,7 @@ namespace atn {
   class ANTLR4CPP_PUBLIC PredicateEvalInfo : public DecisionEventInfo {
   public:
     /// The semantic context which was evaluated.
-    const Ref<SemanticContext> semctx;
+    const RefPtr<SemanticContext> semctx;
 
     /// <summary>
     /// The alternative number for the decision which is guarded by the semantic
@@ -55,7 +56,7 @@ namespace atn {
     /// <seealso cref= ParserATNSimulator#evalSemanticContext(SemanticContext, ParserRuleContext, int, boolean) </seealso>
     /// <seealso cref= SemanticContext#eval(Recognizer, RuleContext) </seealso>
     PredicateEvalInfo(size_t decision, TokenStream *input, size_t startIndex, size_t stopIndex,
-                      Ref<SemanticContext> const& semctx, bool evalResult, size_t predictedAlt, bool fullCtx);
+                      RefPtr<SemanticContext> const& semctx, bool evalResult, size_t predictedAlt, bool fullCtx);
   };
 
 } // namespace atn
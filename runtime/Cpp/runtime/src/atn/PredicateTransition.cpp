@@ -22,8 +22,8 @@ bool PredicateTransition::matches(size_t /*symbol*/, size_t /*minVocabSymbol*/,
   return false;
 }
 
-Ref<SemanticContext::Predicate> PredicateTransition::getPredicate() const {
-  return std::make_shared<SemanticContext::Predicate>(ruleIndex, predIndex, isCtxDependent);
+RefPtr<SemanticContext::Predicate> PredicateTransition::getPredicate() const {
+  return antlrcpp::makeRefPtr<SemanticContext::Predicate>(ruleIndex, predIndex, isCtxDependent);
 }
 
 std::string PredicateTransition::toString() const {
@@ -29,7 +29,7 @@ namespace atn {
     virtual bool isEpsilon() const override;
     virtual bool matches(size_t symbol, size_t minVocabSymbol, size_t maxVocabSymbol) const override;
 
-    Ref<SemanticContext::Predicate> getPredicate() const;
+    RefPtr<SemanticContext::Predicate> getPredicate() const;
 
     virtual std::string toString() const override;
 
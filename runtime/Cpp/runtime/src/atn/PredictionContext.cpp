@@ -11,6 +11,7 @@
 #include "atn/RuleTransition.h"
 #include "support/Arrays.h"
 #include "support/CPPUtils.h"
+#include "atn/PredictionContextCache.h"
 
 #include "atn/PredictionContext.h"
 
@@ -21,17 +22,18 @@ using namespace antlr4::atn;
 using namespace antlrcpp;
 
 size_t PredictionContext::globalNodeCount = 0;
-const Ref<PredictionContext> PredictionContext::EMPTY = std::make_shared<EmptyPredictionContext>();
+const RefPtr<PredictionContext> PredictionContext::EMPTY = antlrcpp::makeRefPtr<EmptyPredictionContext>();
 
 //----------------- PredictionContext ----------------------------------------------------------------------------------
 
-PredictionContext::PredictionContext(size_t cachedHashCode) : id(globalNodeCount++), cachedHashCode(cachedHashCode)  {
+PredictionContext::PredictionContext(size_t cachedHashCode, PredictionContextType contextType)
+  : id(globalNodeCount++), cachedHashCode(cachedHashCode), _contextType(contextType) {
 }
 
 PredictionContext::~PredictionContext() {
 }
 
-Ref<PredictionContext> PredictionContext::fromRuleContext(const ATN &atn, RuleContext *outerContext) {
+RefPtr<PredictionContext> PredictionContext::fromRuleContext(const ATN &atn, RuleContext *outerContext) {
   if (outerContext == nullptr) {
     return PredictionContext::EMPTY;
   }
@@ -43,7 +45,7 @@ Ref<PredictionContext> PredictionContext::fromRuleContext(const ATN &atn, RuleCo
   }
 
   // If we have a parent, convert it to a PredictionContext graph
-  Ref<PredictionContext> parent = PredictionContext::fromRuleContext(atn, dynamic_cast<RuleContext *>(outerContext->parent));
+  RefPtr<PredictionContext> parent = PredictionContext::fromRuleContext(atn, static_cast<RuleContext *>(outerContext->parent));
 
   ATNState *state = atn.states.at(outerContext->invokingState);
   RuleTransition *transition = (RuleTransition *)state->transitions[0];
@@ -69,7 +71,7 @@ size_t PredictionContext::calculateEmptyHashCode() {
   return hash;
 }
 
-size_t PredictionContext::calculateHashCode(Ref<PredictionContext> parent, size_t returnState) {
+size_t PredictionContext::calculateHashCode(RefPtr<PredictionContext> const& parent, size_t returnState) {
   size_t hash = MurmurHash::initialize(INITIAL_HASH);
   hash = MurmurHash::update(hash, parent);
   hash = MurmurHash::update(hash, returnState);
@@ -77,11 +79,11 @@ size_t PredictionContext::calculateHashCode(Ref<PredictionContext> parent, size_
   return hash;
 }
 
-size_t PredictionContext::calculateHashCode(const std::vector<Ref<PredictionContext>> &parents,
+size_t PredictionContext::calculateHashCode(const std::vector<RefPtr<PredictionContext>> &parents,
                                             const std::vector<size_t> &returnStates) {
   size_t hash = MurmurHash::initialize(INITIAL_HASH);
 
-  for (auto parent : parents) {
+  for (auto &parent : parents) {
     hash = MurmurHash::update(hash, parent);
   }
 
@@ -92,8 +94,8 @@ size_t PredictionContext::calculateHashCode(const std::vector<Ref<PredictionCont
   return MurmurHash::finish(hash, parents.size() + returnStates.size());
 }
 
-Ref<PredictionContext> PredictionContext::merge(const Ref<PredictionContext> &a,
-  const Ref<PredictionContext> &b, bool rootIsWildcard, PredictionContextMergeCache *mergeCache) {
+RefPtr<PredictionContext> PredictionContext::merge(const RefPtr<PredictionContext> &a,
+  const RefPtr<PredictionContext> &b, bool rootIsWildcard, PredictionContextMergeCache *mergeCache) {
   assert(a && b);
 
   // share same graph if both same
@@ -101,40 +103,40 @@ Ref<PredictionContext> PredictionContext::merge(const Ref<PredictionContext> &a,
     return a;
   }
 
-  if (is<SingletonPredictionContext>(a) && is<SingletonPredictionContext>(b)) {
-    return mergeSingletons(std::dynamic_pointer_cast<SingletonPredictionContext>(a),
-                           std::dynamic_pointer_cast<SingletonPredictionContext>(b), rootIsWildcard, mergeCache);
+  if (a->isSingleton() && b->isSingleton()) {
+    return mergeSingletons(antlrcpp::static_pointer_cast<SingletonPredictionContext>(a),
+                           antlrcpp::static_pointer_cast<SingletonPredictionContext>(b), rootIsWildcard, mergeCache);
   }
 
   // At least one of a or b is array.
   // If one is $ and rootIsWildcard, return $ as * wildcard.
   if (rootIsWildcard) {
-    if (is<EmptyPredictionContext>(a)) {
+    if (a->getContextType() == PredictionContextType::EMPTY) {
       return a;
     }
-    if (is<EmptyPredictionContext>(b)) {
+    if (b->getContextType() == PredictionContextType::EMPTY) {
       return b;
     }
   }
 
   // convert singleton so both are arrays to normalize
-  Ref<ArrayPredictionContext> left;
-  if (is<SingletonPredictionContext>(a)) {
-    left = std::make_shared<ArrayPredictionContext>(std::dynamic_pointer_cast<SingletonPredictionContext>(a));
+  RefPtr<ArrayPredictionContext> left;
+  if (a->isSingleton()) {
+    left = antlrcpp::makeRefPtr<ArrayPredictionContext>(antlrcpp::static_pointer_cast<SingletonPredictionContext>(a));
   } else {
-    left = std::dynamic_pointer_cast<ArrayPredictionContext>(a);
+    left = antlrcpp::static_pointer_cast<ArrayPredictionContext>(a);
   }
-  Ref<ArrayPredictionContext> right;
-  if (is<SingletonPredictionContext>(b)) {
-    right = std::make_shared<ArrayPredictionContext>(std::dynamic_pointer_cast<SingletonPredictionContext>(b));
+  RefPtr<ArrayPredictionContext> right;
+  if (b->isSingleton()) {
+    right = antlrcpp::makeRefPtr<ArrayPredictionContext>(antlrcpp::static_pointer_cast<SingletonPredictionContext>(b));
   } else {
-    right = std::dynamic_pointer_cast<ArrayPredictionContext>(b);
+    right = antlrcpp::static_pointer_cast<ArrayPredictionContext>(b);
   }
   return mergeArrays(left, right, rootIsWildcard, mergeCache);
 }
 
-Ref<PredictionContext> PredictionContext::mergeSingletons(const Ref<SingletonPredictionContext> &a,
-  const Ref<SingletonPredictionContext> &b, bool rootIsWildcard, PredictionContextMergeCache *mergeCache) {
+RefPtr<PredictionContext> PredictionContext::mergeSingletons(const RefPtr<SingletonPredictionContext> &a,
+  const RefPtr<SingletonPredictionContext> &b, bool rootIsWildcard, PredictionContextMergeCache *mergeCache) {
 
   if (mergeCache != nullptr) { // Can be null if not given to the ATNState from which this call originates.
     auto existing = mergeCache->get(a, b);
@@ -147,7 +149,7 @@ Ref<PredictionContext> PredictionContext::mergeSingletons(const Ref<SingletonPre
     }
   }
 
-  Ref<PredictionContext> rootMerge = mergeRoot(a, b, rootIsWildcard);
+  RefPtr<PredictionContext> rootMerge = mergeRoot(a, b, rootIsWildcard);
   if (rootMerge) {
     if (mergeCache != nullptr) {
       mergeCache->put(a, b, rootMerge);
@@ -155,10 +157,10 @@ Ref<PredictionContext> PredictionContext::mergeSingletons(const Ref<SingletonPre
     return rootMerge;
   }
 
-  Ref<PredictionContext> parentA = a->parent;
-  Ref<PredictionContext> parentB = b->parent;
+  RefPtr<PredictionContext> parentA = a->parent;
+  RefPtr<PredictionContext> parentB = b->parent;
   if (a->returnState == b->returnState) { // a == b
-    Ref<PredictionContext> parent = merge(parentA, parentB, rootIsWildcard, mergeCache);
+    RefPtr<PredictionContext> parent = merge(parentA, parentB, rootIsWildcard, mergeCache);
 
     // If parent is same as existing a or b parent or reduced to a parent, return it.
     if (parent == parentA) { // ax + bx = ax, if a=b
@@ -172,7 +174,7 @@ Ref<PredictionContext> PredictionContext::mergeSingletons(const Ref<SingletonPre
     // merge parents x and y, giving array node with x,y then remainders
     // of those graphs.  dup a, a' points at merged array
     // new joined parent so create new singleton pointing to it, a'
-    Ref<PredictionContext> a_ = SingletonPredictionContext::create(parent, a->returnState);
+    RefPtr<PredictionContext> a_ = SingletonPredictionContext::create(parent, a->returnState);
     if (mergeCache != nullptr) {
       mergeCache->put(a, b, a_);
     }
@@ -180,7 +182,7 @@ Ref<PredictionContext> PredictionContext::mergeSingletons(const Ref<SingletonPre
   } else {
     // a != b payloads differ
     // see if we can collapse parents due to $+x parents if local ctx
-    Ref<PredictionContext> singleParent;
+    RefPtr<PredictionContext> singleParent;
     if (a == b || (*parentA == *parentB)) { // ax + bx = [a,b]x
       singleParent = parentA;
     }
@@ -190,8 +192,8 @@ Ref<PredictionContext> PredictionContext::mergeSingletons(const Ref<SingletonPre
         payloads[0] = b->returnState;
         payloads[1] = a->returnState;
       }
-      std::vector<Ref<PredictionContext>> parents = { singleParent, singleParent };
-      Ref<PredictionContext> a_ = std::make_shared<ArrayPredictionContext>(parents, payloads);
+      std::vector<RefPtr<PredictionContext>> parents = { singleParent, singleParent };
+      RefPtr<PredictionContext> a_ = antlrcpp::makeRefPtr<ArrayPredictionContext>(parents, payloads);
       if (mergeCache != nullptr) {
         mergeCache->put(a, b, a_);
       }
@@ -201,15 +203,15 @@ Ref<PredictionContext> PredictionContext::mergeSingletons(const Ref<SingletonPre
     // parents differ and can't merge them. Just pack together
     // into array; can't merge.
     // ax + by = [ax,by]
-    Ref<PredictionContext> a_;
+    RefPtr<PredictionContext> a_;
     if (a->returnState > b->returnState) { // sort by payload
       std::vector<size_t> payloads = { b->returnState, a->returnState };
-      std::vector<Ref<PredictionContext>> parents = { b->parent, a->parent };
-      a_ = std::make_shared<ArrayPredictionContext>(parents, payloads);
+      std::vector<RefPtr<PredictionContext>> parents = { b->parent, a->parent };
+      a_ = antlrcpp::makeRefPtr<ArrayPredictionContext>(parents, payloads);
     } else {
       std::vector<size_t> payloads = {a->returnState, b->returnState};
-      std::vector<Ref<PredictionContext>> parents = { a->parent, b->parent };
-      a_ = std::make_shared<ArrayPredictionContext>(parents, payloads);
+      std::vector<RefPtr<PredictionContext>> parents = { a->parent, b->parent };
+      a_ = antlrcpp::makeRefPtr<ArrayPredictionContext>(parents, payloads);
     }
 
     if (mergeCache != nullptr) {
@@ -219,8 +221,8 @@ Ref<PredictionContext> PredictionContext::mergeSingletons(const Ref<SingletonPre
   }
 }
 
-Ref<PredictionContext> PredictionContext::mergeRoot(const Ref<SingletonPredictionContext> &a,
-  const Ref<SingletonPredictionContext> &b, bool rootIsWildcard) {
+RefPtr<PredictionContext> PredictionContext::mergeRoot(const RefPtr<SingletonPredictionContext> &a,
+  const RefPtr<SingletonPredictionContext> &b, bool rootIsWildcard) {
   if (rootIsWildcard) {
     if (a == EMPTY) { // * + b = *
       return EMPTY;
@@ -234,22 +236,22 @@ Ref<PredictionContext> PredictionContext::mergeRoot(const Ref<SingletonPredictio
     }
     if (a == EMPTY) { // $ + x = [$,x]
       std::vector<size_t> payloads = { b->returnState, EMPTY_RETURN_STATE };
-      std::vector<Ref<PredictionContext>> parents = { b->parent, nullptr };
-      Ref<PredictionContext> joined = std::make_shared<ArrayPredictionContext>(parents, payloads);
+      std::vector<RefPtr<PredictionContext>> parents = { b->parent, nullptr };
+      RefPtr<PredictionContext> joined = antlrcpp::makeRefPtr<ArrayPredictionContext>(parents, payloads);
       return joined;
     }
     if (b == EMPTY) { // x + $ = [$,x] ($ is always first if present)
       std::vector<size_t> payloads = { a->returnState, EMPTY_RETURN_STATE };
-      std::vector<Ref<PredictionContext>> parents = { a->parent, nullptr };
-      Ref<PredictionContext> joined = std::make_shared<ArrayPredictionContext>(parents, payloads);
+      std::vector<RefPtr<PredictionContext>> parents = { a->parent, nullptr };
+      RefPtr<PredictionContext> joined = antlrcpp::makeRefPtr<ArrayPredictionContext>(parents, payloads);
       return joined;
     }
   }
   return nullptr;
 }
 
-Ref<PredictionContext> PredictionContext::mergeArrays(const Ref<ArrayPredictionContext> &a,
-  const Ref<ArrayPredictionContext> &b, bool rootIsWildcard, PredictionContextMergeCache *mergeCache) {
+RefPtr<PredictionContext> PredictionContext::mergeArrays(const RefPtr<ArrayPredictionContext> &a,
+  const RefPtr<ArrayPredictionContext> &b, bool rootIsWildcard, PredictionContextMergeCache *mergeCache) {
 
   if (mergeCache != nullptr) {
     auto existing = mergeCache->get(a, b);
@@ -268,12 +270,12 @@ Ref<PredictionContext> PredictionContext::mergeArrays(const Ref<ArrayPredictionC
   size_t k = 0; // walks target M array
 
   std::vector<size_t> mergedReturnStates(a->returnStates.size() + b->returnStates.size());
-  std::vector<Ref<PredictionContext>> mergedParents(a->returnStates.size() + b->returnStates.size());
+  std::vector<RefPtr<PredictionContext>> mergedParents(a->returnStates.size() + b->returnStates.size());
 
   // walk and merge to yield mergedParents, mergedReturnStates
   while (i < a->returnStates.size() && j < b->returnStates.size()) {
-    Ref<PredictionContext> a_parent = a->parents[i];
-    Ref<PredictionContext> b_parent = b->parents[j];
+    RefPtr<PredictionContext> a_parent = a->parents[i];
+    RefPtr<PredictionContext> b_parent = b->parents[j];
     if (a->returnStates[i] == b->returnStates[j]) {
       // same payload (stack tops are equal), must yield merged singleton
       size_t payload = a->returnStates[i];
@@ -285,7 +287,7 @@ Ref<PredictionContext> PredictionContext::mergeArrays(const Ref<ArrayPredictionC
         mergedReturnStates[k] = payload;
       }
       else { // ax+ay -> a'[x,y]
-        Ref<PredictionContext> mergedParent = merge(a_parent, b_parent, rootIsWildcard, mergeCache);
+        RefPtr<PredictionContext> mergedParent = merge(a_parent, b_parent, rootIsWildcard, mergeCache);
         mergedParents[k] = mergedParent;
         mergedReturnStates[k] = payload;
       }
@@ -322,7 +324,7 @@ Ref<PredictionContext> PredictionContext::mergeArrays(const Ref<ArrayPredictionC
   // trim merged if we combined a few that had same stack tops
   if (k < mergedParents.size()) { // write index < last position; trim
     if (k == 1) { // for just one merged element, return singleton top
-      Ref<PredictionContext> a_ = SingletonPredictionContext::create(mergedParents[0], mergedReturnStates[0]);
+      RefPtr<PredictionContext> a_ = SingletonPredictionContext::create(mergedParents[0], mergedReturnStates[0]);
       if (mergeCache != nullptr) {
         mergeCache->put(a, b, a_);
       }
@@ -332,7 +334,7 @@ Ref<PredictionContext> PredictionContext::mergeArrays(const Ref<ArrayPredictionC
     mergedReturnStates.resize(k);
   }
 
-  Ref<ArrayPredictionContext> M = std::make_shared<ArrayPredictionContext>(mergedParents, mergedReturnStates);
+  RefPtr<ArrayPredictionContext> M = antlrcpp::makeRefPtr<ArrayPredictionContext>(mergedParents, mergedReturnStates);
 
   // if we created same array as a or b, return that instead
   // TO_DO: track whether this is possible above during merge sort for speed
@@ -352,7 +354,7 @@ Ref<PredictionContext> PredictionContext::mergeArrays(const Ref<ArrayPredictionC
   // ml: this part differs from Java code. We have to recreate the context as the parents array is copied on creation.
   if (combineCommonParents(mergedParents)) {
     mergedReturnStates.resize(mergedParents.size());
-    M = std::make_shared<ArrayPredictionContext>(mergedParents, mergedReturnStates);
+    M = antlrcpp::makeRefPtr<ArrayPredictionContext>(mergedParents, mergedReturnStates);
   }
 
   if (mergeCache != nullptr) {
@@ -361,11 +363,11 @@ Ref<PredictionContext> PredictionContext::mergeArrays(const Ref<ArrayPredictionC
   return M;
 }
 
-bool PredictionContext::combineCommonParents(std::vector<Ref<PredictionContext>> &parents) {
+bool PredictionContext::combineCommonParents(std::vector<RefPtr<PredictionContext>> &parents) {
 
-  std::set<Ref<PredictionContext>> uniqueParents;
+  std::set<RefPtr<PredictionContext>> uniqueParents;
   for (size_t p = 0; p < parents.size(); ++p) {
-    Ref<PredictionContext> parent = parents[p];
+    RefPtr<PredictionContext> parent = parents[p];
     if (uniqueParents.find(parent) == uniqueParents.end()) { // don't replace
       uniqueParents.insert(parent);
     }
@@ -378,7 +380,7 @@ bool PredictionContext::combineCommonParents(std::vector<Ref<PredictionContext>>
   return true;
 }
 
-std::string PredictionContext::toDOTString(const Ref<PredictionContext> &context) {
+std::string PredictionContext::toDOTString(const RefPtr<PredictionContext> &context) {
   if (context == nullptr) {
     return "";
   }
@@ -386,23 +388,23 @@ std::string PredictionContext::toDOTString(const Ref<PredictionContext> &context
   std::stringstream ss;
   ss << "digraph G {\n" << "rankdir=LR;\n";
 
-  std::vector<Ref<PredictionContext>> nodes = getAllContextNodes(context);
-  std::sort(nodes.begin(), nodes.end(), [](const Ref<PredictionContext> &o1, const Ref<PredictionContext> &o2) {
+  std::vector<RefPtr<PredictionContext>> nodes = getAllContextNodes(context);
+  std::sort(nodes.begin(), nodes.end(), [](const RefPtr<PredictionContext> &o1, const RefPtr<PredictionContext> &o2) {
     return o1->id - o2->id;
   });
 
   for (auto current : nodes) {
-    if (is<SingletonPredictionContext>(current)) {
+    if (current->isSingleton()) {
       std::string s = std::to_string(current->id);
       ss << "  s" << s;
       std::string returnState = std::to_string(current->getReturnState(0));
-      if (is<EmptyPredictionContext>(current)) {
+      if (current->getContextType() == PredictionContextType::EMPTY) {
         returnState = "$";
       }
       ss << " [label=\"" << returnState << "\"];\n";
       continue;
     }
-    Ref<ArrayPredictionContext> arr = std::static_pointer_cast<ArrayPredictionContext>(current);
+    RefPtr<ArrayPredictionContext> arr = antlrcpp::static_pointer_cast<ArrayPredictionContext>(current);
     ss << "  s" << arr->id << " [shape=box, label=\"" << "[";
     bool first = true;
     for (auto inv : arr->returnStates) {
@@ -442,8 +444,8 @@ std::string PredictionContext::toDOTString(const Ref<PredictionContext> &context
 }
 
 // The "visited" map is just a temporary structure to control the retrieval process (which is recursive).
-Ref<PredictionContext> PredictionContext::getCachedContext(const Ref<PredictionContext> &context,
-  PredictionContextCache &contextCache, std::map<Ref<PredictionContext>, Ref<PredictionContext>> &visited) {
+RefPtr<PredictionContext> PredictionContext::getCachedContext(const RefPtr<PredictionContext> &context,
+  PredictionContextCache &contextCache, PredictionContextVisitedMap &visited) {
   if (context->isEmpty()) {
     return context;
   }
@@ -454,18 +456,18 @@ Ref<PredictionContext> PredictionContext::getCachedContext(const Ref<PredictionC
       return iterator->second; // Not necessarly the same as context.
   }
 
-  auto iterator = contextCache.find(context);
-  if (iterator != contextCache.end()) {
-    visited[context] = *iterator;
+  RefPtr<PredictionContext> existing = contextCache.get(context);
+  if (existing) {
+    visited[context] = existing;
 
-    return *iterator;
+    return existing;
   }
 
   bool changed = false;
 
-  std::vector<Ref<PredictionContext>> parents(context->size());
+  std::vector<RefPtr<PredictionContext>> parents(context->size());
   for (size_t i = 0; i < parents.size(); i++) {
-    Ref<PredictionContext> parent = getCachedContext(context->getParent(i), contextCache, visited);
+    RefPtr<PredictionContext> parent = getCachedContext(context->getParent(i), contextCache, visited);
     if (changed || parent != context->getParent(i)) {
       if (!changed) {
         parents.clear();
@@ -481,21 +483,21 @@ Ref<PredictionContext> PredictionContext::getCachedContext(const Ref<PredictionC
   }
 
   if (!changed) {
-    contextCache.insert(context);
-    visited[context] = context;
+    // Another thread may have added an equal context in the meantime, so use what the cache returns.
+    RefPtr<PredictionContext> cached = contextCache.add(context);
+    visited[context] = cached;
 
-    return context;
+    return cached;
   }
 
-  Ref<PredictionContext> updated;
+  RefPtr<PredictionContext> updated;
   if (parents.empty()) {
     updated = EMPTY;
   } else if (parents.size() == 1) {
-    updated = SingletonPredictionContext::create(parents[0], context->getReturnState(0));
-    contextCache.insert(updated);
+    updated = contextCache.add(SingletonPredictionContext::create(parents[0], context->getReturnState(0)));
   } else {
-    updated = std::make_shared<ArrayPredictionContext>(parents, std::dynamic_pointer_cast<ArrayPredictionContext>(context)->returnStates);
-    contextCache.insert(updated);
+    updated = contextCache.add(antlrcpp::makeRefPtr<ArrayPredictionContext>(parents,
+      antlrcpp::static_pointer_cast<ArrayPredictionContext>(context)->returnStates));
   }
 
   visited[updated] = updated;
@@ -504,15 +506,15 @@ Ref<PredictionContext> PredictionContext::getCachedContext(const Ref<PredictionC
   return updated;
 }
 
-std::vector<Ref<PredictionContext>> PredictionContext::getAllContextNodes(const Ref<PredictionContext> &context) {
-  std::vector<Ref<PredictionContext>> nodes;
+std::vector<RefPtr<PredictionContext>> PredictionContext::getAllContextNodes(const RefPtr<PredictionContext> &context) {
+  std::vector<RefPtr<PredictionContext>> nodes;
   std::set<PredictionContext *> visited;
   getAllContextNodes_(context, nodes, visited);
   return nodes;
 }
 
 
-void PredictionContext::getAllContextNodes_(const Ref<PredictionContext> &context, std::vector<Ref<PredictionContext>> &nodes,
+void PredictionContext::getAllContextNodes_(const RefPtr<PredictionContext> &context, std::vector<RefPtr<PredictionContext>> &nodes,
   std::set<PredictionContext *> &visited) {
 
   if (visited.find(context.get()) != visited.end()) {
@@ -540,7 +542,7 @@ std::vector<std::string> PredictionContext::toStrings(Recognizer *recognizer, in
   return toStrings(recognizer, EMPTY, currentState);
 }
 
-std::vector<std::string> PredictionContext::toStrings(Recognizer *recognizer, const Ref<PredictionContext> &stop, int currentState) {
+std::vector<std::string> PredictionContext::toStrings(Recognizer *recognizer, const RefPtr<PredictionContext> &stop, int currentState) {
 
   std::vector<std::string> result;
 
@@ -611,9 +613,9 @@ std::vector<std::string> PredictionContext::toStrings(Recognizer *recognizer, co
 
 //----------------- PredictionContextMergeCache ------------------------------------------------------------------------
 
-Ref<PredictionContext> PredictionContextMergeCache::put(Ref<PredictionContext> const& key1, Ref<PredictionContext> const& key2,
-                                                        Ref<PredictionContext> const& value) {
-  Ref<PredictionContext> previous;
+RefPtr<PredictionContext> PredictionContextMergeCache::put(RefPtr<PredictionContext> const& key1, RefPtr<PredictionContext> const& key2,
+                                                        RefPtr<PredictionContext> const& value) {
+  RefPtr<PredictionContext> previous;
 
   auto iterator = _data.find(key1);
   if (iterator == _data.end())
@@ -628,7 +630,7 @@ Ref<PredictionContext> PredictionContextMergeCache::put(Ref<PredictionContext> c
   return previous;
 }
 
-Ref<PredictionContext> PredictionContextMergeCache::get(Ref<PredictionContext> const& key1, Ref<PredictionContext> const& key2) {
+RefPtr<PredictionContext> PredictionContextMergeCache::get(RefPtr<PredictionContext> const& key1, RefPtr<PredictionContext> const& key2) {
   auto iterator = _data.find(key1);
   if (iterator == _data.end())
     return nullptr;
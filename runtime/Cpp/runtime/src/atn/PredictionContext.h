@@ -15,14 +15,24 @@ namespace atn {
   struct PredictionContextHasher;
   struct PredictionContextComparer;
   class PredictionContextMergeCache;
+  class PredictionContextCache;
 
-  typedef std::unordered_set<Ref<PredictionContext>, PredictionContextHasher, PredictionContextComparer> PredictionContextCache;
+  /// Maps contexts by identity (the hash of a RefPtr is the address of its object), as used for the visited nodes when
+  /// rebuilding context graphs.
+  typedef std::unordered_map<RefPtr<PredictionContext>, RefPtr<PredictionContext>> PredictionContextVisitedMap;
 
-  class ANTLR4CPP_PUBLIC PredictionContext {
+  /// The concrete type of a prediction context. Used instead of RTTI in the prediction hot paths.
+  enum class PredictionContextType : size_t {
+    SINGLETON, // SingletonPredictionContext
+    EMPTY,     // EmptyPredictionContext (which is also a SingletonPredictionContext)
+    ARRAY      // ArrayPredictionContext
+  };
+
+  class ANTLR4CPP_PUBLIC PredictionContext : public antlrcpp::RefCounted {
   public:
     /// Represents $ in local context prediction, which means wildcard.
     /// *+x = *.
-    static const Ref<PredictionContext> EMPTY;
+    static const RefPtr<PredictionContext> EMPTY;
 
     /// Represents $ in an array in full context mode, when $
     /// doesn't mean wildcard: $ + x = [$,x]. Here,
@@ -63,34 +73,41 @@ namespace atn {
     const size_t cachedHashCode;
 
   protected:
-    PredictionContext(size_t cachedHashCode);
-    ~PredictionContext();
+    PredictionContext(size_t cachedHashCode, PredictionContextType contextType);
+    virtual ~PredictionContext();
 
   public:
     /// Convert a RuleContext tree to a PredictionContext graph.
     /// Return EMPTY if outerContext is empty.
-    static Ref<PredictionContext> fromRuleContext(const ATN &atn, RuleContext *outerContext);
+    static RefPtr<PredictionContext> fromRuleContext(const ATN &atn, RuleContext *outerContext);
 
     virtual size_t size() const = 0;
-    virtual Ref<PredictionContext> getParent(size_t index) const = 0;
+    virtual RefPtr<PredictionContext> getParent(size_t index) const = 0;
     virtual size_t getReturnState(size_t index) const = 0;
 
     virtual bool operator == (const PredictionContext &o) const = 0;
 
+    PredictionContextType getContextType() const { return _contextType; }
+
+    /// True for SingletonPredictionContext and EmptyPredictionContext instances, which can then be static_cast.
+    bool isSingleton() const { return _contextType != PredictionContextType::ARRAY; }
+
     /// This means only the EMPTY (wildcard? not sure) context is in set.
     virtual bool isEmpty() const;
     virtual bool hasEmptyPath() const;
     virtual size_t hashCode() const;
 
   protected:
+    const PredictionContextType _contextType;
+
     static size_t calculateEmptyHashCode();
-    static size_t calculateHashCode(Ref<PredictionContext> parent, size_t returnState);
-    static size_t calculateHashCode(const std::vector<Ref<PredictionContext>> &parents,
+    static size_t calculateHashCode(RefPtr<PredictionContext> const& parent, size_t returnState);
+    static size_t calculateHashCode(const std::vector<RefPtr<PredictionContext>> &parents,
                                     const std::vector<size_t> &returnStates);
 
   public:
     // dispatch
-    static Ref<PredictionContext> merge(const Ref<PredictionContext> &a, const Ref<PredictionContext> &b,
+    static RefPtr<PredictionContext> merge(const RefPtr<PredictionContext> &a, const RefPtr<PredictionContext> &b,
                                         bool rootIsWildcard, PredictionContextMergeCache *mergeCache);
 
     /// <summary>
@@ -127,8 +144,8 @@ namespace atn {
     /// <param name="rootIsWildcard"> {@code true} if this is a local-context merge,
     /// otherwise false to indicate a full-context merge </param>
     /// <param name="mergeCache"> </param>
-    static Ref<PredictionContext> mergeSingletons(const Ref<SingletonPredictionContext> &a,
-      const Ref<SingletonPredictionContext> &b, bool rootIsWildcard, PredictionContextMergeCache *mergeCache);
+    static RefPtr<PredictionContext> mergeSingletons(const RefPtr<SingletonPredictionContext> &a,
+      const RefPtr<SingletonPredictionContext> &b, bool rootIsWildcard, PredictionContextMergeCache *mergeCache);
 
     /**
      * Handle case where at least one of {@code a} or {@code b} is
@@ -168,8 +185,8 @@ namespace atn {
      * @param rootIsWildcard {@code true} if this is a local-context merge,
      * otherwise false to indicate a full-context merge
      */
-    static Ref<PredictionContext> mergeRoot(const Ref<SingletonPredictionContext> &a,
-      const Ref<SingletonPredictionContext> &b, bool rootIsWildcard);
+    static RefPtr<PredictionContext> mergeRoot(const RefPtr<SingletonPredictionContext> &a,
+      const RefPtr<SingletonPredictionContext> &b, bool rootIsWildcard);
 
     /**
      * Merge two {@link ArrayPredictionContext} instances.
@@ -190,41 +207,40 @@ namespace atn {
      * {@link SingletonPredictionContext}.<br>
      * <embed src="images/ArrayMerge_EqualTop.svg" type="image/svg+xml"/></p>
      */
-    static Ref<PredictionContext> mergeArrays(const Ref<ArrayPredictionContext> &a,
-      const Ref<ArrayPredictionContext> &b, bool rootIsWildcard, PredictionContextMergeCache *mergeCache);
+    static RefPtr<PredictionContext> mergeArrays(const RefPtr<ArrayPredictionContext> &a,
+      const RefPtr<ArrayPredictionContext> &b, bool rootIsWildcard, PredictionContextMergeCache *mergeCache);
 
   protected:
     /// Make pass over all M parents; merge any equal() ones.
     /// @returns true if the list has been changed (i.e. duplicates where found).
-    static bool combineCommonParents(std::vector<Ref<PredictionContext>> &parents);
+    static bool combineCommonParents(std::vector<RefPtr<PredictionContext>> &parents);
 
   public:
-    static std::string toDOTString(const Ref<PredictionContext> &context);
+    static std::string toDOTString(const RefPtr<PredictionContext> &context);
 
-    static Ref<PredictionContext> getCachedContext(const Ref<PredictionContext> &context,
-      PredictionContextCache &contextCache,
-      std::map<Ref<PredictionContext>, Ref<PredictionContext>> &visited);
+    static RefPtr<PredictionContext> getCachedContext(const RefPtr<PredictionContext> &context,
+      PredictionContextCache &contextCache, PredictionContextVisitedMap &visited);
 
     // ter's recursive version of Sam's getAllNodes()
-    static std::vector<Ref<PredictionContext>> getAllContextNodes(const Ref<PredictionContext> &context);
-    static void getAllContextNodes_(const Ref<PredictionContext> &context,
-      std::vector<Ref<PredictionContext>> &nodes, std::set<PredictionContext *> &visited);
+    static std::vector<RefPtr<PredictionContext>> getAllContextNodes(const RefPtr<PredictionContext> &context);
+    static void getAllContextNodes_(const RefPtr<PredictionContext> &context,
+      std::vector<RefPtr<PredictionContext>> &nodes, std::set<PredictionContext *> &visited);
 
     virtual std::string toString() const;
     virtual std::string toString(Recognizer *recog) const;
 
     std::vector<std::string> toStrings(Recognizer *recognizer, int currentState);
-    std::vector<std::string> toStrings(Recognizer *recognizer, const Ref<PredictionContext> &stop, int currentState);
+    std::vector<std::string> toStrings(Recognizer *recognizer, const RefPtr<PredictionContext> &stop, int currentState);
   };
 
   struct PredictionContextHasher {
-    size_t operator () (const Ref<PredictionContext> &k) const {
+    size_t operator () (const RefPtr<PredictionContext> &k) const {
       return k->hashCode();
     }
   };
 
   struct PredictionContextComparer {
-    bool operator () (const Ref<PredictionContext> &lhs, const Ref<PredictionContext> &rhs) const
+    bool operator () (const RefPtr<PredictionContext> &lhs, const RefPtr<PredictionContext> &rhs) const
     {
       if (lhs == rhs) // Object identity.
         return true;
@@ -234,17 +250,17 @@ namespace atn {
 
   class PredictionContextMergeCache {
   public:
-    Ref<PredictionContext> put(Ref<PredictionContext> const& key1, Ref<PredictionContext> const& key2,
-                               Ref<PredictionContext> const& value);
-    Ref<PredictionContext> get(Ref<PredictionContext> const& key1, Ref<PredictionContext> const& key2);
+    RefPtr<PredictionContext> put(RefPtr<PredictionContext> const& key1, RefPtr<PredictionContext> const& key2,
+                               RefPtr<PredictionContext> const& value);
+    RefPtr<PredictionContext> get(RefPtr<PredictionContext> const& key1, RefPtr<PredictionContext> const& key2);
 
     void clear();
     std::string toString() const;
     size_t count() const;
 
   private:
-    std::unordered_map<Ref<PredictionContext>,
-      std::unordered_map<Ref<PredictionContext>, Ref<PredictionContext>, PredictionContextHasher, PredictionContextComparer>,
+    std::unordered_map<RefPtr<PredictionContext>,
+      std::unordered_map<RefPtr<PredictionContext>, RefPtr<PredictionContext>, PredictionContextHasher, PredictionContextComparer>,
       PredictionContextHasher, PredictionContextComparer> _data;
 
   };
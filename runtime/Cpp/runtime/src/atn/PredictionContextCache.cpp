@@ -0,0 +1,119 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include "atn/PredictionContextCache.h"
+
+using namespace antlr4::atn;
+
+const size_t PredictionContextCache::DEFAULT_MAX_SIZE;
+
+PredictionContextCache::PredictionContextCache(size_t maxSize) : _maxSize(maxSize) {
+}
+
+RefPtr<PredictionContext> PredictionContextCache::add(RefPtr<PredictionContext> const& context) {
+  if (context == PredictionContext::EMPTY) {
+    return PredictionContext::EMPTY;
+  }
+
+  std::lock_guard<std::mutex> lck(_lock);
+  ++_statistics.lookups;
+  RefPtr<PredictionContext> existing = lookup(context);
+  if (existing) {
+    ++_statistics.hits;
+    return existing;
+  }
+
+  store(context);
+  ++_statistics.insertions;
+  return context;
+}
+
+RefPtr<PredictionContext> PredictionContextCache::get(RefPtr<PredictionContext> const& context) {
+  std::lock_guard<std::mutex> lck(_lock);
+  ++_statistics.lookups;
+  RefPtr<PredictionContext> existing = lookup(context);
+  if (existing) {
+    ++_statistics.hits;
+  }
+  return existing;
+}
+
+void PredictionContextCache::newGeneration() {
+  std::lock_guard<std::mutex> lck(_lock);
+  rotate();
+}
+
+void PredictionContextCache::clear() {
+  std::lock_guard<std::mutex> lck(_lock);
+  _current.clear();
+  _previous.clear();
+}
+
+size_t PredictionContextCache::size() const {
+  std::lock_guard<std::mutex> lck(_lock);
+  return _current.size() + _previous.size();
+}
+
+size_t PredictionContextCache::getMaxSize() const {
+  std::lock_guard<std::mutex> lck(_lock);
+  return _maxSize;
+}
+
+void PredictionContextCache::setMaxSize(size_t maxSize) {
+  std::lock_guard<std::mutex> lck(_lock);
+  _maxSize = maxSize;
+  if (_maxSize == 0 || _current.size() + _previous.size() <= _maxSize) {
+    return;
+  }
+
+  _statistics.evictions += _previous.size();
+  _previous.clear();
+  if (_current.size() > _maxSize / 2) {
+    rotate();
+  }
+  if (_previous.size() > _maxSize) {
+    _statistics.evictions += _previous.size();
+    _previous.clear();
+  }
+}
+
+PredictionContextCache::Statistics PredictionContextCache::getStatistics() const {
+  std::lock_guard<std::mutex> lck(_lock);
+  Statistics result = _statistics;
+  result.size = _current.size() + _previous.size();
+  return result;
+}
+
+RefPtr<PredictionContext> PredictionContextCache::lookup(RefPtr<PredictionContext> const& context) {
+  auto iterator = _current.find(context);
+  if (iterator != _current.end()) {
+    return *iterator;
+  }
+
+  iterator = _previous.find(context);
+  if (iterator == _previous.end()) {
+    return nullptr;
+  }
+
+  // Still in use, so keep it for another generation.
+  RefPtr<PredictionContext> result = *iterator;
+  _previous.erase(iterator);
+  store(result);
+  return result;
+}
+
+void PredictionContextCache::store(RefPtr<PredictionContext> const& context) {
+  if (_maxSize > 0 && _current.size() >= std::max(_maxSize / 2, static_cast<size_t>(1))) {
+    rotate();
+  }
+  _current.insert(context);
+}
+
+void PredictionContextCache::rotate() {
+  _statistics.evictions += _previous.size();
+  _previous.clear();
+  _previous.swap(_current);
+  ++_statistics.generation;
+}
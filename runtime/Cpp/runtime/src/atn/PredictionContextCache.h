@@ -0,0 +1,79 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include "atn/PredictionContext.h"
+
+namespace antlr4 {
+namespace atn {
+
+  /// Used to cache PredictionContext objects. It's used for the shared context cache associated with contexts in DFA
+  /// states. This cache can be used for both lexers and parsers.
+  ///
+  /// The cache interns contexts: add() returns the one instance stored for all contexts which are equal to the given
+  /// one. To keep the footprint bounded when the input keeps producing new contexts, the entries are kept in two
+  /// generations. New entries go to the current generation. When it holds half of the maximum size, it becomes the
+  /// previous generation and the old previous generation is dropped. Entries from the previous generation which are
+  /// used again are moved to the current generation, so only contexts not used for a whole generation get evicted.
+  /// Evicting a context is always safe: contexts are immutable and the cache only serves to share equal graphs.
+  ///
+  /// All methods are thread safe.
+  class ANTLR4CPP_PUBLIC PredictionContextCache {
+  public:
+    static const size_t DEFAULT_MAX_SIZE = 1 << 18;
+
+    struct Statistics {
+      size_t lookups = 0;    // Calls of add() and get().
+      size_t hits = 0;       // Lookups which found an equal context.
+      size_t insertions = 0; // New contexts added.
+      size_t evictions = 0;  // Entries dropped because of the size cap.
+      size_t generation = 0; // Number of generation changes so far.
+      size_t size = 0;       // Current number of entries.
+    };
+
+    /// Creates a cache holding at most maxSize entries (0 means unbounded, the smallest cap is 2 entries).
+    PredictionContextCache(size_t maxSize = DEFAULT_MAX_SIZE);
+
+    PredictionContextCache(const PredictionContextCache& other) = delete;
+    PredictionContextCache& operator = (const PredictionContextCache& other) = delete;
+
+    /// Adds a context to the cache and returns it. If an equal context is already stored, that one is returned
+    /// instead.
+    RefPtr<PredictionContext> add(RefPtr<PredictionContext> const& context);
+
+    /// Returns the cached context which is equal to the given one or null if there is none.
+    RefPtr<PredictionContext> get(RefPtr<PredictionContext> const& context);
+
+    /// Starts a new generation, e.g. between unrelated inputs. Entries not used in the current generation are
+    /// evicted when the next generation starts.
+    void newGeneration();
+
+    void clear();
+    size_t size() const;
+
+    size_t getMaxSize() const;
+
+    /// Changes the size cap (0 means unbounded). Entries are evicted right away if the cache is larger than that.
+    void setMaxSize(size_t maxSize);
+
+    Statistics getStatistics() const;
+
+  private:
+    typedef std::unordered_set<RefPtr<PredictionContext>, PredictionContextHasher, PredictionContextComparer> Generation;
+
+    mutable std::mutex _lock;
+    Generation _current;
+    Generation _previous;
+    size_t _maxSize;
+    Statistics _statistics;
+
+    RefPtr<PredictionContext> lookup(RefPtr<PredictionContext> const& context);
+    void store(RefPtr<PredictionContext> const& context);
+    void rotate();
+  };
+
+} // namespace atn
+} // namespace antlr4
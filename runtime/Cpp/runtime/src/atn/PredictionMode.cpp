@@ -74,7 +74,7 @@ bool PredictionModeClass::hasSLLConflictTerminatingPrediction(PredictionMode mod
 
 bool PredictionModeClass::hasConfigInRuleStopState(ATNConfigSet *configs) {
   for (auto &c : configs->configs) {
-    if (is<RuleStopState *>(c->state)) {
+    if (c->state->getStateType() == ATNState::RULE_STOP) {
       return true;
     }
   }
@@ -84,7 +84,7 @@ bool PredictionModeClass::hasConfigInRuleStopState(ATNConfigSet *configs) {
 
 bool PredictionModeClass::allConfigsInRuleStopStates(ATNConfigSet *configs) {
   for (auto &config : configs->configs) {
-    if (!is<RuleStopState*>(config->state)) {
+    if (config->state->getStateType() != ATNState::RULE_STOP) {
       return false;
     }
   }
@@ -101,7 +101,7 @@ bool PredictionModeClass::allSubsetsConflict(const std::vector<antlrcpp::BitSet>
 }
 
 bool PredictionModeClass::hasNonConflictingAltSet(const std::vector<antlrcpp::BitSet>& altsets) {
-  for (antlrcpp::BitSet alts : altsets) {
+  for (const antlrcpp::BitSet &alts : altsets) {
     if (alts.count() == 1) {
       return true;
     }
@@ -110,7 +110,7 @@ bool PredictionModeClass::hasNonConflictingAltSet(const std::vector<antlrcpp::Bi
 }
 
 bool PredictionModeClass::hasConflictingAltSet(const std::vector<antlrcpp::BitSet>& altsets) {
-  for (antlrcpp::BitSet alts : altsets) {
+  for (const antlrcpp::BitSet &alts : altsets) {
     if (alts.count() > 1) {
       return true;
     }
@@ -142,7 +142,7 @@ size_t PredictionModeClass::getUniqueAlt(const std::vector<antlrcpp::BitSet>& al
 
 antlrcpp::BitSet PredictionModeClass::getAlts(const std::vector<antlrcpp::BitSet>& altsets) {
   antlrcpp::BitSet all;
-  for (antlrcpp::BitSet alts : altsets) {
+  for (const antlrcpp::BitSet &alts : altsets) {
     all |= alts;
   }
 
@@ -163,7 +163,8 @@ std::vector<antlrcpp::BitSet> PredictionModeClass::getConflictingAltSubsets(ATNC
     configToAlts[config.get()].set(config->alt);
   }
   std::vector<antlrcpp::BitSet> values;
-  for (auto it : configToAlts) {
+  values.reserve(configToAlts.size());
+  for (auto &it : configToAlts) {
     values.push_back(it.second);
   }
   return values;
@@ -187,7 +188,7 @@ bool PredictionModeClass::hasStateAssociatedWithOneAlt(ATNConfigSet *configs) {
 
 size_t PredictionModeClass::getSingleViableAlt(const std::vector<antlrcpp::BitSet>& altsets) {
   antlrcpp::BitSet viableAlts;
-  for (antlrcpp::BitSet alts : altsets) {
+  for (const antlrcpp::BitSet &alts : altsets) {
     size_t minAlt = alts.nextSetBit(0);
 
     viableAlts.set(minAlt);
@@ -66,7 +66,7 @@ bool SemanticContext::PrecedencePredicate::eval(Recognizer *parser, RuleContext
   return parser->precpred(parserCallStack, precedence);
 }
 
-Ref<SemanticContext> SemanticContext::PrecedencePredicate::evalPrecedence(Recognizer *parser,
+RefPtr<SemanticContext> SemanticContext::PrecedencePredicate::evalPrecedence(Recognizer *parser,
   RuleContext *parserCallStack) {
   if (parser->precpred(parserCallStack, precedence)) {
     return SemanticContext::NONE;
@@ -103,11 +103,11 @@ std::string SemanticContext::PrecedencePredicate::toString() const {
 
 //------------------ AND -----------------------------------------------------------------------------------------------
 
-SemanticContext::AND::AND(Ref<SemanticContext> const& a, Ref<SemanticContext> const& b) {
+SemanticContext::AND::AND(RefPtr<SemanticContext> const& a, RefPtr<SemanticContext> const& b) {
   Set operands;
 
   if (is<AND>(a)) {
-    for (auto operand : std::dynamic_pointer_cast<AND>(a)->opnds) {
+    for (auto &operand : static_cast<AND *>(a.get())->opnds) {
       operands.insert(operand);
     }
   } else {
@@ -115,18 +115,18 @@ SemanticContext::AND::AND(Ref<SemanticContext> const& a, Ref<SemanticContext> co
   }
 
   if (is<AND>(b)) {
-    for (auto operand : std::dynamic_pointer_cast<AND>(b)->opnds) {
+    for (auto &operand : static_cast<AND *>(b.get())->opnds) {
       operands.insert(operand);
     }
   } else {
     operands.insert(b);
   }
 
-  std::vector<Ref<PrecedencePredicate>> precedencePredicates = filterPrecedencePredicates(operands);
+  std::vector<RefPtr<PrecedencePredicate>> precedencePredicates = filterPrecedencePredicates(operands);
 
   if (!precedencePredicates.empty()) {
     // interested in the transition with the lowest precedence
-    auto predicate = [](Ref<PrecedencePredicate> const& a, Ref<PrecedencePredicate> const& b) {
+    auto predicate = [](RefPtr<PrecedencePredicate> const& a, RefPtr<PrecedencePredicate> const& b) {
       return a->precedence < b->precedence;
     };
 
@@ -137,7 +137,7 @@ SemanticContext::AND::AND(Ref<SemanticContext> const& a, Ref<SemanticContext> co
   std::copy(operands.begin(), operands.end(), std::back_inserter(opnds));
 }
 
-std::vector<Ref<SemanticContext>> SemanticContext::AND::getOperands() const {
+std::vector<RefPtr<SemanticContext>> SemanticContext::AND::getOperands() const {
   return opnds;
 }
 
@@ -157,7 +157,7 @@ size_t SemanticContext::AND::hashCode() const {
 }
 
 bool SemanticContext::AND::eval(Recognizer *parser, RuleContext *parserCallStack) {
-  for (auto opnd : opnds) {
+  for (auto &opnd : opnds) {
     if (!opnd->eval(parser, parserCallStack)) {
       return false;
     }
@@ -165,11 +165,11 @@ bool SemanticContext::AND::eval(Recognizer *parser, RuleContext *parserCallStack
   return true;
 }
 
-Ref<SemanticContext> SemanticContext::AND::evalPrecedence(Recognizer *parser, RuleContext *parserCallStack) {
+RefPtr<SemanticContext> SemanticContext::AND::evalPrecedence(Recognizer *parser, RuleContext *parserCallStack) {
   bool differs = false;
-  std::vector<Ref<SemanticContext>> operands;
-  for (auto context : opnds) {
-    Ref<SemanticContext> evaluated = context->evalPrecedence(parser, parserCallStack);
+  std::vector<RefPtr<SemanticContext>> operands;
+  for (auto &context : opnds) {
+    RefPtr<SemanticContext> evaluated = context->evalPrecedence(parser, parserCallStack);
     differs |= (evaluated != context);
     if (evaluated == nullptr) {
       // The AND context is false if any element is false.
@@ -181,7 +181,7 @@ Ref<SemanticContext> SemanticContext::AND::evalPrecedence(Recognizer *parser, Ru
   }
 
   if (!differs) {
-    return shared_from_this();
+    return RefPtr<SemanticContext>(this);
   }
 
   if (operands.empty()) {
@@ -189,7 +189,7 @@ Ref<SemanticContext> SemanticContext::AND::evalPrecedence(Recognizer *parser, Ru
     return NONE;
   }
 
-  Ref<SemanticContext> result = operands[0];
+  RefPtr<SemanticContext> result = operands[0];
   for (size_t i = 1; i < operands.size(); ++i) {
     result = SemanticContext::And(result, operands[i]);
   }
@@ -207,11 +207,11 @@ std::string SemanticContext::AND::toString() const {
 
 //------------------ OR ------------------------------------------------------------------------------------------------
 
-SemanticContext::OR::OR(Ref<SemanticContext> const& a, Ref<SemanticContext> const& b) {
+SemanticContext::OR::OR(RefPtr<SemanticContext> const& a, RefPtr<SemanticContext> const& b) {
   Set operands;
 
   if (is<OR>(a)) {
-    for (auto operand : std::dynamic_pointer_cast<OR>(a)->opnds) {
+    for (auto &operand : static_cast<OR *>(a.get())->opnds) {
       operands.insert(operand);
     }
   } else {
@@ -219,17 +219,17 @@ SemanticContext::OR::OR(Ref<SemanticContext> const& a, Ref<SemanticContext> cons
   }
 
   if (is<OR>(b)) {
-    for (auto operand : std::dynamic_pointer_cast<OR>(b)->opnds) {
+    for (auto &operand : static_cast<OR *>(b.get())->opnds) {
       operands.insert(operand);
     }
   } else {
     operands.insert(b);
   }
 
-  std::vector<Ref<PrecedencePredicate>> precedencePredicates = filterPrecedencePredicates(operands);
+  std::vector<RefPtr<PrecedencePredicate>> precedencePredicates = filterPrecedencePredicates(operands);
   if (!precedencePredicates.empty()) {
     // interested in the transition with the highest precedence
-    auto predicate = [](Ref<PrecedencePredicate> const& a, Ref<PrecedencePredicate> const& b) {
+    auto predicate = [](RefPtr<PrecedencePredicate> const& a, RefPtr<PrecedencePredicate> const& b) {
       return a->precedence < b->precedence;
     };
     auto reduced = std::max_element(precedencePredicates.begin(), precedencePredicates.end(), predicate);
@@ -239,7 +239,7 @@ SemanticContext::OR::OR(Ref<SemanticContext> const& a, Ref<SemanticContext> cons
   std::copy(operands.begin(), operands.end(), std::back_inserter(opnds));
 }
 
-std::vector<Ref<SemanticContext>> SemanticContext::OR::getOperands() const {
+std::vector<RefPtr<SemanticContext>> SemanticContext::OR::getOperands() const {
   return opnds;
 }
 
@@ -259,7 +259,7 @@ size_t SemanticContext::OR::hashCode() const {
 }
 
 bool SemanticContext::OR::eval(Recognizer *parser, RuleContext *parserCallStack) {
-  for (auto opnd : opnds) {
+  for (auto &opnd : opnds) {
     if (opnd->eval(parser, parserCallStack)) {
       return true;
     }
@@ -267,11 +267,11 @@ bool SemanticContext::OR::eval(Recognizer *parser, RuleContext *parserCallStack)
   return false;
 }
 
-Ref<SemanticContext> SemanticContext::OR::evalPrecedence(Recognizer *parser, RuleContext *parserCallStack) {
+RefPtr<SemanticContext> SemanticContext::OR::evalPrecedence(Recognizer *parser, RuleContext *parserCallStack) {
   bool differs = false;
-  std::vector<Ref<SemanticContext>> operands;
-  for (auto context : opnds) {
-    Ref<SemanticContext> evaluated = context->evalPrecedence(parser, parserCallStack);
+  std::vector<RefPtr<SemanticContext>> operands;
+  for (auto &context : opnds) {
+    RefPtr<SemanticContext> evaluated = context->evalPrecedence(parser, parserCallStack);
     differs |= (evaluated != context);
     if (evaluated == NONE) {
       // The OR context is true if any element is true.
@@ -283,7 +283,7 @@ Ref<SemanticContext> SemanticContext::OR::evalPrecedence(Recognizer *parser, Rul
   }
 
   if (!differs) {
-    return shared_from_this();
+    return RefPtr<SemanticContext>(this);
   }
 
   if (operands.empty()) {
@@ -291,7 +291,7 @@ Ref<SemanticContext> SemanticContext::OR::evalPrecedence(Recognizer *parser, Rul
     return nullptr;
   }
 
-  Ref<SemanticContext> result = operands[0];
+  RefPtr<SemanticContext> result = operands[0];
   for (size_t i = 1; i < operands.size(); ++i) {
     result = SemanticContext::Or(result, operands[i]);
   }
@@ -309,7 +309,7 @@ std::string SemanticContext::OR::toString() const {
 
 //------------------ SemanticContext -----------------------------------------------------------------------------------
 
-const Ref<SemanticContext> SemanticContext::NONE = std::make_shared<Predicate>(INVALID_INDEX, INVALID_INDEX, false);
+const RefPtr<SemanticContext> SemanticContext::NONE = antlrcpp::makeRefPtr<Predicate>(INVALID_INDEX, INVALID_INDEX, false);
 
 SemanticContext::~SemanticContext() {
 }
@@ -318,11 +318,11 @@ bool SemanticContext::operator != (const SemanticContext &other) const {
   return !(*this == other);
 }
 
-Ref<SemanticContext> SemanticContext::evalPrecedence(Recognizer * /*parser*/, RuleContext * /*parserCallStack*/) {
-  return shared_from_this();
+RefPtr<SemanticContext> SemanticContext::evalPrecedence(Recognizer * /*parser*/, RuleContext * /*parserCallStack*/) {
+  return RefPtr<SemanticContext>(this);
 }
 
-Ref<SemanticContext> SemanticContext::And(Ref<SemanticContext> const& a, Ref<SemanticContext> const& b) {
+RefPtr<SemanticContext> SemanticContext::And(RefPtr<SemanticContext> const& a, RefPtr<SemanticContext> const& b) {
   if (!a || a == NONE) {
     return b;
   }
@@ -331,7 +331,7 @@ Ref<SemanticContext> SemanticContext::And(Ref<SemanticContext> const& a, Ref<Sem
     return a;
   }
 
-  Ref<AND> result = std::make_shared<AND>(a, b);
+  RefPtr<AND> result = antlrcpp::makeRefPtr<AND>(a, b);
   if (result->opnds.size() == 1) {
     return result->opnds[0];
   }
@@ -339,7 +339,7 @@ Ref<SemanticContext> SemanticContext::And(Ref<SemanticContext> const& a, Ref<Sem
   return result;
 }
 
-Ref<SemanticContext> SemanticContext::Or(Ref<SemanticContext> const& a, Ref<SemanticContext> const& b) {
+RefPtr<SemanticContext> SemanticContext::Or(RefPtr<SemanticContext> const& a, RefPtr<SemanticContext> const& b) {
   if (!a) {
     return b;
   }
@@ -351,7 +351,7 @@ Ref<SemanticContext> SemanticContext::Or(Ref<SemanticContext> const& a, Ref<Sema
     return NONE;
   }
 
-  Ref<OR> result = std::make_shared<OR>(a, b);
+  RefPtr<OR> result = antlrcpp::makeRefPtr<OR>(a, b);
   if (result->opnds.size() == 1) {
     return result->opnds[0];
   }
@@ -359,11 +359,11 @@ Ref<SemanticContext> SemanticContext::Or(Ref<SemanticContext> const& a, Ref<Sema
   return result;
 }
 
-std::vector<Ref<SemanticContext::PrecedencePredicate>> SemanticContext::filterPrecedencePredicates(const Set &collection) {
-  std::vector<Ref<SemanticContext::PrecedencePredicate>> result;
-  for (auto context : collection) {
+std::vector<RefPtr<SemanticContext::PrecedencePredicate>> SemanticContext::filterPrecedencePredicates(const Set &collection) {
+  std::vector<RefPtr<SemanticContext::PrecedencePredicate>> result;
+  for (auto &context : collection) {
     if (antlrcpp::is<PrecedencePredicate>(context)) {
-      result.push_back(std::dynamic_pointer_cast<PrecedencePredicate>(context));
+      result.push_back(antlrcpp::dynamic_pointer_cast<PrecedencePredicate>(context));
     }
   }
 
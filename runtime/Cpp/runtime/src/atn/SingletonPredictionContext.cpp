@@ -9,8 +9,9 @@
 
 using namespace antlr4::atn;
 
-SingletonPredictionContext::SingletonPredictionContext(Ref<PredictionContext> const& parent, size_t returnState)
-  : PredictionContext(parent ? calculateHashCode(parent, returnState) : calculateEmptyHashCode()),
+SingletonPredictionContext::SingletonPredictionContext(RefPtr<PredictionContext> const& parent, size_t returnState)
+  : PredictionContext(parent ? calculateHashCode(parent, returnState) : calculateEmptyHashCode(),
+                      parent ? PredictionContextType::SINGLETON : PredictionContextType::EMPTY),
     parent(parent), returnState(returnState) {
   assert(returnState != ATNState::INVALID_STATE_NUMBER);
 }
@@ -18,20 +19,20 @@ SingletonPredictionContext::SingletonPredictionContext(Ref<PredictionContext> co
 SingletonPredictionContext::~SingletonPredictionContext() {
 }
 
-Ref<SingletonPredictionContext> SingletonPredictionContext::create(Ref<PredictionContext> const& parent, size_t returnState) {
+RefPtr<SingletonPredictionContext> SingletonPredictionContext::create(RefPtr<PredictionContext> const& parent, size_t returnState) {
 
   if (returnState == EMPTY_RETURN_STATE && parent) {
     // someone can pass in the bits of an array ctx that mean $
-    return std::dynamic_pointer_cast<SingletonPredictionContext>(EMPTY);
+    return antlrcpp::static_pointer_cast<SingletonPredictionContext>(EMPTY);
   }
-  return std::make_shared<SingletonPredictionContext>(parent, returnState);
+  return antlrcpp::makeRefPtr<SingletonPredictionContext>(parent, returnState);
 }
 
 size_t SingletonPredictionContext::size() const {
   return 1;
 }
 
-Ref<PredictionContext> SingletonPredictionContext::getParent(size_t index) const {
+RefPtr<PredictionContext> SingletonPredictionContext::getParent(size_t index) const {
   assert(index == 0);
   ((void)(index)); // Make Release build happy.
   return parent;
@@ -48,11 +49,12 @@ bool SingletonPredictionContext::operator == (const PredictionContext &o) const
     return true;
   }
 
-  const SingletonPredictionContext *other = dynamic_cast<const SingletonPredictionContext*>(&o);
-  if (other == nullptr) {
+  if (!o.isSingleton()) {
     return false;
   }
 
+  const SingletonPredictionContext *other = static_cast<const SingletonPredictionContext*>(&o);
+
   if (this->hashCode() != other->hashCode()) {
     return false; // can't be same if hash is different
   }
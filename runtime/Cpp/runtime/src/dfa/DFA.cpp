@@ -8,6 +8,7 @@
 #include "support/CPPUtils.h"
 #include "atn/StarLoopEntryState.h"
 #include "atn/ATNConfigSet.h"
+#include "atn/ATNConfig.h"
 
 #include "dfa/DFA.h"
 
@@ -15,45 +16,92 @@ using namespace antlr4;
 using namespace antlr4::dfa;
 using namespace antlrcpp;
 
+// An estimate of the memory taken by a state, without its edges (they are accounted when added). Prediction contexts
+// are shared between states (see PredictionContextCache) and hence not counted.
+static size_t estimateStateSize(const DFAState *state) {
+  size_t result = sizeof(DFAState) + state->predicates.size() * sizeof(DFAState::PredPrediction);
+  if (state->configs != nullptr) {
+    // Each config is held by a shared pointer (with its control block) in the config list and the lookup table.
+    result += sizeof(atn::ATNConfigSet) + state->configs->size() * (sizeof(atn::ATNConfig) + 6 * sizeof(void *));
+  }
+  return result;
+}
+
+DFA::EpochGuard::EpochGuard(DFA &dfa) : _dfa(dfa) {
+  if (dfa._maintenancePending.load(std::memory_order_relaxed)) {
+    dfa.maintain();
+  }
+
+  // If the epoch changes while we register, the reclamation may not have seen us, so register again.
+  while (true) {
+    size_t epoch = dfa._epoch.load(std::memory_order_seq_cst);
+    _slot = epoch & 1;
+    dfa._readers[_slot].fetch_add(1, std::memory_order_seq_cst);
+    if (dfa._epoch.load(std::memory_order_seq_cst) == epoch) {
+      break;
+    }
+    dfa._readers[_slot].fetch_sub(1, std::memory_order_release);
+  }
+}
+
+DFA::EpochGuard::~EpochGuard() {
+  _dfa._readers[_slot].fetch_sub(1, std::memory_order_release);
+}
+
 DFA::DFA(atn::DecisionState *atnStartState) : DFA(atnStartState, 0) {
 }
 
 DFA::DFA(atn::DecisionState *atnStartState, size_t decision)
-  : atnStartState(atnStartState), s0(nullptr), decision(decision) {
+  : atnStartState(atnStartState), s0(nullptr), decision(decision), _compactStates(false), _memoryBudget(0), _memoryUsage(0),
+    _peakMemoryUsage(0), _resets(0), _epoch(0), _maintenancePending(false) {
+  _readers[0] = 0;
+  _readers[1] = 0;
 
   _precedenceDfa = false;
   if (is<atn::StarLoopEntryState *>(atnStartState)) {
     if (static_cast<atn::StarLoopEntryState *>(atnStartState)->isPrecedenceDecision) {
       _precedenceDfa = true;
-      s0 = new DFAState(std::unique_ptr<atn::ATNConfigSet>(new atn::ATNConfigSet()));
-      s0->isAcceptState = false;
-      s0->requiresFullContext = false;
+      s0 = createPrecedenceStartState();
     }
   }
 }
 
-DFA::DFA(DFA &&other) : atnStartState(other.atnStartState), decision(other.decision) {
-  // Source states are implicitly cleared by the move.
+DFA::DFA(DFA &&other) : atnStartState(other.atnStartState), s0(other.s0.load()), decision(other.decision),
+  _compactStates(other._compactStates), _memoryBudget(other._memoryBudget), _memoryUsage(other._memoryUsage), _peakMemoryUsage(other._peakMemoryUsage),
+  _resets(other._resets), _epoch(other._epoch.load()), _maintenancePending(other._maintenancePending.load()) {
+  // Source states are implicitly cleared by the move. A DFA must not be in use while it is moved.
   states = std::move(other.states);
+  _retired[0] = std::move(other._retired[0]);
+  _retired[1] = std::move(other._retired[1]);
+  _readers[0] = 0;
+  _readers[1] = 0;
 
   other.atnStartState = nullptr;
   other.decision = 0;
-  s0 = other.s0;
   other.s0 = nullptr;
+  other._memoryUsage = 0;
+  other._maintenancePending = false;
   _precedenceDfa = other._precedenceDfa;
   other._precedenceDfa = false;
 }
 
 DFA::~DFA() {
-  bool s0InList = (s0 == nullptr);
+  DFAState *start = s0.load();
+  bool s0InList = (start == nullptr);
   for (auto state : states) {
-    if (state == s0)
+    if (state == start)
       s0InList = true;
     delete state;
   }
 
   if (!s0InList)
-    delete s0;
+    delete start;
+
+  for (auto &retired : _retired) {
+    for (auto state : retired) {
+      delete state;
+    }
+  }
 }
 
 bool DFA::isPrecedenceDfa() const {
@@ -63,14 +111,10 @@ bool DFA::isPrecedenceDfa() const {
 DFAState* DFA::getPrecedenceStartState(int precedence) const {
   assert(_precedenceDfa); // Only precedence DFAs may contain a precedence start state.
 
-  auto iterator = s0->edges.find(precedence);
-  if (iterator == s0->edges.end())
-    return nullptr;
-
-  return iterator->second;
+  return s0.load()->edges.get(precedence);
 }
 
-void DFA::setPrecedenceStartState(int precedence, DFAState *startState, SingleWriteMultipleReadLock &lock) {
+void DFA::setPrecedenceStartState(int precedence, DFAState *startState) {
   if (!isPrecedenceDfa()) {
     throw IllegalStateException("Only precedence DFAs may contain a precedence start state.");
   }
@@ -79,11 +123,169 @@ void DFA::setPrecedenceStartState(int precedence, DFAState *startState, SingleWr
     return;
   }
 
-  {
-    lock.writeLock();
-    s0->edges[precedence] = startState;
-    lock.writeUnlock();
+  addEdge(s0.load(), precedence, startState);
+}
+
+std::mutex& DFA::getLock() {
+  return _lock;
+}
+
+DFAState* DFA::findState(DFAState *state) {
+  if (_compactStates && !state->hasFingerprint()) {
+    state->computeFingerprint();
+  }
+
+  auto iterator = states.find(state);
+  return iterator == states.end() ? nullptr : *iterator;
+}
+
+void DFA::addState(DFAState *state) {
+  state->stateNumber = (int)states.size();
+  states.insert(state);
+  accountMemory(estimateStateSize(state));
+}
+
+void DFA::releaseConfigs(DFAState *state) {
+  assert(state->hasFingerprint());
+
+  size_t before = estimateStateSize(state);
+  state->configs.reset();
+  _memoryUsage -= before - estimateStateSize(state);
+}
+
+void DFA::restoreConfigs(DFAState *state, std::unique_ptr<atn::ATNConfigSet> configs) {
+  assert(state->configs == nullptr && configs != nullptr);
+
+  size_t before = estimateStateSize(state);
+  state->configs = std::move(configs);
+  accountMemory(estimateStateSize(state) - before);
+}
+
+void DFA::addEdge(DFAState *from, size_t symbol, DFAState *to) {
+  size_t before = from->edges.getMemoryUsage();
+  from->edges.put(symbol, to);
+  accountMemory(from->edges.getMemoryUsage() - before);
+}
+
+void DFA::addRangeEdge(DFAState *from, size_t a, size_t b, DFAState *to) {
+  size_t before = from->edges.getMemoryUsage();
+  from->edges.putRange(a, b, to);
+  accountMemory(from->edges.getMemoryUsage() - before);
+}
+
+void DFA::reset() {
+  std::lock_guard<std::mutex> lck(_lock);
+  resetLocked();
+  reclaim();
+}
+
+void DFA::setMemoryBudget(size_t budget) {
+  std::lock_guard<std::mutex> lck(_lock);
+  _memoryBudget = budget;
+  if (_memoryBudget > 0 && _memoryUsage > _memoryBudget) {
+    _maintenancePending.store(true, std::memory_order_relaxed);
+  }
+}
+
+size_t DFA::getMemoryBudget() const {
+  std::lock_guard<std::mutex> lck(_lock);
+  return _memoryBudget;
+}
+
+void DFA::setCompactStates(bool compact) {
+  std::lock_guard<std::mutex> lck(_lock);
+  if (compact != _compactStates) {
+    // States with and without fingerprint can't be mixed (they hash differently).
+    if (!states.empty()) {
+      resetLocked();
+      reclaim();
+    }
+    _compactStates = compact;
+  }
+}
+
+bool DFA::hasCompactStates() const {
+  return _compactStates;
+}
+
+DFA::Statistics DFA::getStatistics() const {
+  std::lock_guard<std::mutex> lck(_lock);
+  Statistics result;
+  result.states = states.size();
+  result.memoryUsage = _memoryUsage;
+  result.peakMemoryUsage = _peakMemoryUsage;
+  result.memoryBudget = _memoryBudget;
+  result.resets = _resets;
+  result.retiredStates = _retired[0].size() + _retired[1].size();
+  return result;
+}
+
+DFAState* DFA::createPrecedenceStartState() const {
+  DFAState *start = new DFAState(std::unique_ptr<atn::ATNConfigSet>(new atn::ATNConfigSet())); /* mem-check: managed by the DFA */
+  start->isAcceptState = false;
+  start->requiresFullContext = false;
+  return start;
+}
+
+void DFA::accountMemory(size_t bytes) {
+  _memoryUsage += bytes;
+  _peakMemoryUsage = std::max(_peakMemoryUsage, _memoryUsage);
+  if (_memoryBudget > 0 && _memoryUsage > _memoryBudget) {
+    // Not reset right away, as the caller may still work with states of the current set.
+    _maintenancePending.store(true, std::memory_order_relaxed);
+  }
+}
+
+void DFA::resetLocked() {
+  // The states (and the special start state of a precedence DFA) may still be walked by other threads.
+  std::vector<DFAState *> &retired = _retired[_epoch.load(std::memory_order_relaxed) & 1];
+  DFAState *start = s0.load(std::memory_order_relaxed);
+  retired.insert(retired.end(), states.begin(), states.end());
+  if (_precedenceDfa) {
+    retired.push_back(start);
+  }
+  states.clear();
+
+  s0.store(_precedenceDfa ? createPrecedenceStartState() : nullptr, std::memory_order_release);
+  _memoryUsage = 0;
+  ++_resets;
+}
+
+void DFA::reclaim() {
+  // States retired during the previous epoch can be freed when no reader of that epoch is left. Then the next epoch
+  // can begin (which reuses that reader slot). Two rounds free everything if there are no readers at all.
+  for (size_t i = 0; i < 2; ++i) {
+    size_t epoch = _epoch.load(std::memory_order_relaxed);
+    std::vector<DFAState *> &previous = _retired[(epoch + 1) & 1];
+    if (previous.empty() && _retired[epoch & 1].empty()) {
+      break;
+    }
+    if (_readers[(epoch + 1) & 1].load(std::memory_order_seq_cst) != 0) {
+      break;
+    }
+
+    for (auto state : previous) {
+      delete state;
+    }
+    previous.clear();
+    _epoch.store(epoch + 1, std::memory_order_seq_cst);
+  }
+
+  bool pending = !_retired[0].empty() || !_retired[1].empty() || (_memoryBudget > 0 && _memoryUsage > _memoryBudget);
+  _maintenancePending.store(pending, std::memory_order_relaxed);
+}
+
+void DFA::maintain() {
+  // Readers never wait. If another thread is modifying the DFA we try again with the next prediction.
+  std::unique_lock<std::mutex> lck(_lock, std::try_to_lock);
+  if (!lck.owns_lock()) {
+    return;
+  }
+
+  if (_memoryBudget > 0 && _memoryUsage > _memoryBudget) {
+    resetLocked();
   }
+  reclaim();
 }
 
 std::vector<DFAState *> DFA::getStates() const {
@@ -7,22 +7,52 @@
 
 #include "dfa/DFAState.h"
 
-namespace antlrcpp {
-  class SingleWriteMultipleReadLock;
-}
-
 namespace antlr4 {
 namespace dfa {
 
+  /// A DFA caches the predictions of a decision (or the tokens of a lexer mode).
+  ///
+  /// States are only added while holding the DFA lock (see getLock()), but read without any locking. To bound the
+  /// memory a DFA can take, it keeps an estimate of the memory used by its states and is reset when it exceeds its
+  /// memory budget (see setMemoryBudget()). A reset can also be requested explicitly at any time (see reset()), even
+  /// while other threads use the DFA. The old states are retired and freed only when all threads which might still
+  /// be walking them are done (epoch based reclamation, see EpochGuard).
   class ANTLR4CPP_PUBLIC DFA {
   public:
+    /// Memory statistics of a DFA, e.g. to find a suitable memory budget.
+    struct Statistics {
+      size_t states = 0;          // Number of states.
+      size_t memoryUsage = 0;     // Estimated size of the states, their configurations and edges, in bytes.
+      size_t peakMemoryUsage = 0; // The highest memory usage so far.
+      size_t memoryBudget = 0;    // The configured budget (0 means unbounded).
+      size_t resets = 0;          // Number of resets (explicitly or because the budget was exceeded).
+      size_t retiredStates = 0;   // States of earlier resets which may still be in use by other threads.
+    };
+
+    /// Marks a thread as using the states of a DFA. The simulators hold one while they walk the DFA (i.e. for each
+    /// prediction), so states retired by a reset stay alive until the walk is done. Creating a guard never blocks.
+    class ANTLR4CPP_PUBLIC EpochGuard {
+    public:
+      EpochGuard(DFA &dfa);
+      EpochGuard(const EpochGuard &other) = delete;
+      ~EpochGuard();
+
+      EpochGuard& operator = (const EpochGuard &other) = delete;
+
+    private:
+      DFA &_dfa;
+      size_t _slot;
+    };
+
     /// A set of all DFA states. Use a map so we can get old state back.
     /// Set only allows you to see if it's there.
 
     /// From which ATN state did we create this DFA?
     atn::DecisionState *atnStartState;
     std::unordered_set<DFAState *, DFAState::Hasher, DFAState::Comparer> states; // States are owned by this class.
-    DFAState *s0;
+
+    /// The start state. Like edges it is published atomically, so the DFA can be entered without locking.
+    std::atomic<DFAState *> s0;
     size_t decision;
 
     DFA(atn::DecisionState *atnStartState);
@@ -63,14 +93,64 @@ namespace dfa {
      * @param startState The start state corresponding to the specified
      * precedence.
      *
+     * The caller must hold the lock returned by {@link #getLock()}.
+     *
      * @throws IllegalStateException if this is not a precedence DFA.
      * @see #isPrecedenceDfa()
      */
-    void setPrecedenceStartState(int precedence, DFAState *startState, antlrcpp::SingleWriteMultipleReadLock &lock);
+    void setPrecedenceStartState(int precedence, DFAState *startState);
+
+    /// The lock which serializes all modifications of this DFA (new states, new edges, start states).
+    /// Readers walking the DFA don't need it. Each DFA has its own lock, so threads working on different
+    /// decisions never contend with each other.
+    std::mutex& getLock();
 
     /// Return a list of all states in this DFA, ordered by state number.
     virtual std::vector<DFAState *> getStates() const;
 
+    /// Returns the state of this DFA which is equal to the given (new) state, or null if there is none.
+    /// The caller must hold the lock returned by {@link #getLock()}.
+    DFAState* findState(DFAState *state);
+
+    /// Adds a new state (which must not be in the DFA yet, see findState()), numbers it and accounts its memory.
+    /// The caller must hold the lock returned by {@link #getLock()}.
+    void addState(DFAState *state);
+
+    /// Frees the configurations of a state of a compact DFA, which the simulator won't need anymore.
+    /// The caller must hold the lock returned by {@link #getLock()} and the state must not be published yet.
+    void releaseConfigs(DFAState *state);
+
+    /// Gives a state whose configurations were released configurations equal to its former ones again (they must
+    /// have the same fingerprint). This is needed when such a state becomes a start state.
+    /// The caller must hold the lock returned by {@link #getLock()}.
+    void restoreConfigs(DFAState *state, std::unique_ptr<atn::ATNConfigSet> configs);
+
+    /// Adds an edge for the given symbol (or all symbols in a..b) to a state of this DFA and accounts its memory.
+    /// The caller must hold the lock returned by {@link #getLock()}.
+    void addEdge(DFAState *from, size_t symbol, DFAState *to);
+    void addRangeEdge(DFAState *from, size_t a, size_t b, DFAState *to);
+
+    /// Removes all states, which gives the same DFA as a newly created one. This is safe while other threads
+    /// use the DFA: the old states are freed once no thread walks them anymore.
+    void reset();
+
+    /// Sets the memory (in bytes, see Statistics::memoryUsage) this DFA may use. When a new state or edge makes the
+    /// DFA exceed the budget, it is reset before its next use. 0 (the default) means unbounded.
+    void setMemoryBudget(size_t budget);
+    size_t getMemoryBudget() const;
+
+    /// In a compact DFA states are identified by a fingerprint of their configurations (see
+    /// DFAState::computeFingerprint()) instead of the configurations themselves. This allows the simulators to free
+    /// the configurations of states which never need them again: parser states which end a prediction (unless full
+    /// context prediction or predicates need them) and lexer states from which no further input can be matched.
+    /// The configurations of such states are no longer available for debugging output.
+    ///
+    /// Changing the mode resets the DFA. Off by default.
+    void setCompactStates(bool compact);
+    bool hasCompactStates() const;
+
+    Statistics getStatistics() const;
+
     /**
      * @deprecated Use {@link #toString(Vocabulary)} instead.
      */
@@ -80,11 +160,38 @@ namespace dfa {
     virtual std::string toLexerString();
 
   private:
+    friend class DFASnapshot;
+
     /**
      * {@code true} if this DFA is for a precedence decision; otherwise,
      * {@code false}. This is the backing field for {@link #isPrecedenceDfa}.
      */
     bool _precedenceDfa;
+
+    mutable std::mutex _lock;
+
+    bool _compactStates;
+
+    // Memory accounting, guarded by the lock.
+    size_t _memoryBudget;
+    size_t _memoryUsage;
+    size_t _peakMemoryUsage;
+    size_t _resets;
+
+    // Epoch based reclamation: readers register in the slot of the current epoch (see EpochGuard). States retired
+    // during an epoch are freed when the epoch after it is left behind, at which point none of their readers remain.
+    std::atomic<size_t> _epoch;
+    std::atomic<size_t> _readers[2];
+    std::vector<DFAState *> _retired[2]; // Guarded by the lock.
+
+    // Set when the DFA is over budget or has retired states, so readers know they should call maintain().
+    std::atomic<bool> _maintenancePending;
+
+    DFAState* createPrecedenceStartState() const;
+    void accountMemory(size_t bytes);
+    void resetLocked();
+    void reclaim();
+    void maintain();
   };
 
 } // namespace atn
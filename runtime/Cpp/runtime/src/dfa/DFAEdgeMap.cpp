@@ -0,0 +1,236 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include "dfa/DFAEdgeMap.h"
+
+using namespace antlr4::dfa;
+
+static const size_t INITIAL_CAPACITY = 8; // Must be a power of 2.
+
+DFAEdgeMap::Table::Table(size_t capacity) : mask(capacity - 1), count(0) {
+  slots = new Slot[capacity];
+}
+
+DFAEdgeMap::Table::~Table() {
+  delete [] slots;
+}
+
+DFAEdgeMap::Slot* DFAEdgeMap::Table::find(size_t symbol) const {
+  // Symbols are mostly small dense integers (token types, characters), so the identity hash spreads them well.
+  // The load factor is kept below 1, hence there's always an unused slot which ends the probe sequence.
+  for (size_t i = symbol & mask; ; i = (i + 1) & mask) {
+    Slot *slot = &slots[i];
+    if (slot->target.load(std::memory_order_acquire) == nullptr ||
+        slot->symbol.load(std::memory_order_relaxed) == symbol) {
+      return slot;
+    }
+  }
+}
+
+DFAEdgeMap::RangeTable::RangeTable(size_t capacity) : count(0), capacity(capacity) {
+  ranges = new Range[capacity];
+}
+
+DFAEdgeMap::RangeTable::~RangeTable() {
+  delete [] ranges;
+}
+
+DFAEdgeMap::DFAEdgeMap(size_t denseSize)
+  : _denseSize(denseSize), _dense(nullptr), _denseCount(0), _table(nullptr), _ranges(nullptr) {
+}
+
+DFAEdgeMap::~DFAEdgeMap() {
+  delete [] _dense.load();
+  delete _table.load();
+  for (auto table : _retired) {
+    delete table;
+  }
+  delete _ranges.load();
+  for (auto table : _retiredRanges) {
+    delete table;
+  }
+}
+
+DFAState* DFAEdgeMap::getSparse(size_t symbol) const {
+  Table *table = _table.load(std::memory_order_acquire);
+  if (table == nullptr) {
+    return nullptr;
+  }
+
+  // The target is loaded first (acquire) and written last by put (release), so the symbol is valid once we see a target.
+  return table->find(symbol)->target.load(std::memory_order_acquire);
+}
+
+void DFAEdgeMap::put(size_t symbol, DFAState *target) {
+  if (symbol < _denseSize) {
+    std::atomic<DFAState *> *dense = _dense.load(std::memory_order_relaxed);
+    if (dense == nullptr) {
+      dense = new std::atomic<DFAState *>[_denseSize];
+      for (size_t i = 0; i < _denseSize; ++i) {
+        dense[i].store(nullptr, std::memory_order_relaxed);
+      }
+      _dense.store(dense, std::memory_order_release);
+    }
+
+    if (dense[symbol].load(std::memory_order_relaxed) == nullptr) {
+      _denseCount.store(_denseCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    dense[symbol].store(target, std::memory_order_release);
+    return;
+  }
+
+  Table *table = _table.load(std::memory_order_relaxed);
+  if (table == nullptr) {
+    table = new Table(INITIAL_CAPACITY);
+    _table.store(table, std::memory_order_release);
+  }
+
+  Slot *slot = table->find(symbol);
+  if (slot->target.load(std::memory_order_relaxed) == nullptr) {
+    // New entry. Keep the load factor at or below 3/4.
+    size_t count = table->count.load(std::memory_order_relaxed);
+    if ((count + 1) * 4 > (table->mask + 1) * 3) {
+      grow(table);
+      table = _table.load(std::memory_order_relaxed);
+      slot = table->find(symbol);
+    }
+    table->count.store(count + 1, std::memory_order_relaxed);
+    slot->symbol.store(symbol, std::memory_order_relaxed);
+  }
+  slot->target.store(target, std::memory_order_release);
+}
+
+DFAState* DFAEdgeMap::getRange(size_t symbol) const {
+  RangeTable *table = _ranges.load(std::memory_order_acquire);
+  if (table == nullptr) {
+    return nullptr;
+  }
+
+  // A state has only a handful of distinct character classes, so a linear scan is fine.
+  size_t count = table->count.load(std::memory_order_acquire);
+  for (size_t i = 0; i < count; ++i) {
+    const Range &range = table->ranges[i];
+    if (symbol >= range.a && symbol <= range.b) {
+      return range.target;
+    }
+  }
+  return nullptr;
+}
+
+void DFAEdgeMap::putRange(size_t a, size_t b, DFAState *target) {
+  RangeTable *table = _ranges.load(std::memory_order_relaxed);
+  size_t count = table == nullptr ? 0 : table->count.load(std::memory_order_relaxed);
+  if (table == nullptr || count == table->capacity) {
+    RangeTable *newTable = new RangeTable(table == nullptr ? INITIAL_CAPACITY : table->capacity * 2);
+    if (table != nullptr) {
+      std::copy(table->ranges, table->ranges + count, newTable->ranges);
+      newTable->count.store(count, std::memory_order_relaxed);
+      _retiredRanges.push_back(table);
+    }
+    _ranges.store(newTable, std::memory_order_release);
+    table = newTable;
+  }
+
+  table->ranges[count] = { a, b, target };
+  table->count.store(count + 1, std::memory_order_release);
+}
+
+bool DFAEdgeMap::empty() const {
+  return size() == 0;
+}
+
+size_t DFAEdgeMap::size() const {
+  size_t count = _denseCount.load(std::memory_order_relaxed);
+  Table *table = _table.load(std::memory_order_acquire);
+  if (table != nullptr) {
+    count += table->count.load(std::memory_order_relaxed);
+  }
+  RangeTable *ranges = _ranges.load(std::memory_order_acquire);
+  if (ranges != nullptr) {
+    count += ranges->count.load(std::memory_order_relaxed);
+  }
+  return count;
+}
+
+size_t DFAEdgeMap::getMemoryUsage() const {
+  size_t result = 0;
+  if (_dense.load(std::memory_order_relaxed) != nullptr) {
+    result += _denseSize * sizeof(std::atomic<DFAState *>);
+  }
+
+  Table *table = _table.load(std::memory_order_relaxed);
+  if (table != nullptr) {
+    result += sizeof(Table) + (table->mask + 1) * sizeof(Slot);
+  }
+  for (auto retired : _retired) {
+    result += sizeof(Table) + (retired->mask + 1) * sizeof(Slot);
+  }
+
+  RangeTable *ranges = _ranges.load(std::memory_order_relaxed);
+  if (ranges != nullptr) {
+    result += sizeof(RangeTable) + ranges->capacity * sizeof(Range);
+  }
+  for (auto retired : _retiredRanges) {
+    result += sizeof(RangeTable) + retired->capacity * sizeof(Range);
+  }
+  return result;
+}
+
+std::vector<std::pair<size_t, DFAState *>> DFAEdgeMap::getEdges() const {
+  std::vector<std::pair<size_t, DFAState *>> result;
+  std::atomic<DFAState *> *dense = _dense.load(std::memory_order_acquire);
+  if (dense != nullptr) {
+    for (size_t i = 0; i < _denseSize; ++i) {
+      DFAState *target = dense[i].load(std::memory_order_acquire);
+      if (target != nullptr) {
+        result.push_back({ i, target });
+      }
+    }
+  }
+
+  Table *table = _table.load(std::memory_order_acquire);
+  if (table != nullptr) {
+    for (size_t i = 0; i <= table->mask; ++i) {
+      DFAState *target = table->slots[i].target.load(std::memory_order_acquire);
+      if (target != nullptr) {
+        result.push_back({ table->slots[i].symbol.load(std::memory_order_relaxed), target });
+      }
+    }
+  }
+
+  std::sort(result.begin(), result.end(), [](const std::pair<size_t, DFAState *> &lhs,
+                                             const std::pair<size_t, DFAState *> &rhs) {
+    return lhs.first < rhs.first;
+  });
+  return result;
+}
+
+std::vector<DFAEdgeMap::Range> DFAEdgeMap::getRanges() const {
+  std::vector<Range> result;
+  RangeTable *table = _ranges.load(std::memory_order_acquire);
+  if (table != nullptr) {
+    size_t count = table->count.load(std::memory_order_acquire);
+    result.assign(table->ranges, table->ranges + count);
+  }
+  return result;
+}
+
+void DFAEdgeMap::grow(Table *table) {
+  Table *newTable = new Table((table->mask + 1) * 2);
+  for (size_t i = 0; i <= table->mask; ++i) {
+    DFAState *target = table->slots[i].target.load(std::memory_order_relaxed);
+    if (target != nullptr) {
+      size_t symbol = table->slots[i].symbol.load(std::memory_order_relaxed);
+      Slot *slot = newTable->find(symbol);
+      slot->symbol.store(symbol, std::memory_order_relaxed);
+      slot->target.store(target, std::memory_order_relaxed);
+      newTable->count.store(newTable->count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+  }
+
+  // Readers may still be looking at the old table, so it stays alive until the map goes away.
+  _table.store(newTable, std::memory_order_release);
+  _retired.push_back(table);
+}
@@ -0,0 +1,119 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include "antlr4-common.h"
+
+namespace antlr4 {
+namespace dfa {
+
+  class DFAState;
+
+  /// The outgoing edges of a DFA state, keyed by input symbol.
+  ///
+  /// Lookups never lock. Edges are published with release semantics after their target state is fully
+  /// constructed, so a reader which finds an edge also sees a complete target state. Writers must be
+  /// serialized by the caller (see DFA::getLock()).
+  ///
+  /// Symbols below the dense size given at construction time go to a flat array indexed by the symbol
+  /// (lexer states use this for the ASCII range, which makes the DFA loop a simple array access).
+  /// All other symbols are kept in an open addressing hash table which grows by publishing a new copy.
+  /// Replaced tables are kept until the map is destroyed, as concurrent readers may still be walking
+  /// them (RCU style reclamation tied to the lifetime of the owning DFA).
+  ///
+  /// Additionally edges can cover a whole range of symbols (see putRange), which the lexer uses to cache
+  /// transitions for the full Unicode range with a memory footprint bounded by the number of distinct
+  /// character classes leaving a state, rather than by the number of distinct characters seen.
+  class ANTLR4CPP_PUBLIC DFAEdgeMap {
+  public:
+    struct Range {
+      size_t a;
+      size_t b;
+      DFAState *target;
+    };
+
+    DFAEdgeMap(size_t denseSize = 0);
+    DFAEdgeMap(const DFAEdgeMap &other) = delete;
+    ~DFAEdgeMap();
+
+    DFAEdgeMap& operator = (const DFAEdgeMap &other) = delete;
+
+    /// Returns the target state for the given symbol or null if no edge has been published for it yet.
+    DFAState* get(size_t symbol) const {
+      if (symbol < _denseSize) {
+        std::atomic<DFAState *> *dense = _dense.load(std::memory_order_acquire);
+        return dense == nullptr ? nullptr : dense[symbol].load(std::memory_order_acquire);
+      }
+      return getSparse(symbol);
+    }
+
+    /// Adds or replaces the edge for the given symbol. Must only be called while holding the write lock of the DFA.
+    void put(size_t symbol, DFAState *target);
+
+    /// Returns the target state of the range edge which contains the given symbol, or null if there is none.
+    DFAState* getRange(size_t symbol) const;
+
+    /// Adds an edge for all symbols in a..b (inclusive). The range must not overlap any existing range edge.
+    /// Must only be called while holding the write lock of the DFA.
+    void putRange(size_t a, size_t b, DFAState *target);
+
+    bool empty() const;
+    size_t size() const;
+
+    /// Returns the number of bytes allocated for the edges (including replaced tables).
+    /// Must only be called while holding the write lock of the DFA.
+    size_t getMemoryUsage() const;
+
+    /// Returns a snapshot of all edges, ordered by symbol.
+    std::vector<std::pair<size_t, DFAState *>> getEdges() const;
+
+    /// Returns a snapshot of all range edges, in the order they were added.
+    std::vector<Range> getRanges() const;
+
+  private:
+    struct Slot {
+      std::atomic<size_t> symbol;
+      std::atomic<DFAState *> target; // Null marks an unused slot.
+
+      Slot() : symbol(0), target(nullptr) {}
+    };
+
+    struct Table {
+      size_t mask;
+      std::atomic<size_t> count;
+      Slot *slots;
+
+      Table(size_t capacity);
+      ~Table();
+
+      Slot* find(size_t symbol) const;
+    };
+
+    const size_t _denseSize;
+    std::atomic<std::atomic<DFAState *> *> _dense; // Allocated with the first dense edge.
+    std::atomic<size_t> _denseCount;
+
+    // Append only. Entries below count never change, so readers can scan them once they've seen count.
+    struct RangeTable {
+      std::atomic<size_t> count;
+      size_t capacity;
+      Range *ranges;
+
+      RangeTable(size_t capacity);
+      ~RangeTable();
+    };
+
+    std::atomic<Table *> _table;
+    std::atomic<RangeTable *> _ranges;
+    std::vector<Table *> _retired;
+    std::vector<RangeTable *> _retiredRanges;
+
+    DFAState* getSparse(size_t symbol) const;
+    void grow(Table *table);
+  };
+
+} // namespace dfa
+} // namespace antlr4
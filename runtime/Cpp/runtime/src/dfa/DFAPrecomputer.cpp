@@ -0,0 +1,135 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include "Exceptions.h"
+#include "ANTLRInputStream.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "atn/LexerATNSimulator.h"
+#include "atn/ParserATNSimulator.h"
+#include "support/StringUtils.h"
+#include "dfa/DFA.h"
+#include "dfa/DFASnapshot.h"
+
+#include <thread>
+
+#include "dfa/DFAPrecomputer.h"
+
+using namespace antlr4;
+using namespace antlr4::dfa;
+using namespace antlrcpp;
+
+DFAPrecomputer::DFAPrecomputer(ParseFunction parse) : _parse(parse) {
+}
+
+void DFAPrecomputer::addDFAs(const std::string &name, const atn::ATN &atn, std::vector<DFA> &decisionToDFA) {
+  _entries.push_back({ name, &atn, &decisionToDFA });
+}
+
+void DFAPrecomputer::addRecognizer(const std::string &name, Recognizer *recognizer) {
+  if (is<Lexer *>(recognizer)) {
+    addDFAs(name, recognizer->getATN(), recognizer->getInterpreter<atn::LexerATNSimulator>()->_decisionToDFA);
+  } else if (is<Parser *>(recognizer)) {
+    addDFAs(name, recognizer->getATN(), recognizer->getInterpreter<atn::ParserATNSimulator>()->decisionToDFA);
+  } else {
+    throw IllegalArgumentException("Only lexers and parsers have DFAs to precompute.");
+  }
+}
+
+void DFAPrecomputer::addInput(const std::string &input, const std::string &sourceName) {
+  _inputs.push_back({ input, sourceName });
+}
+
+void DFAPrecomputer::addFile(const std::string &fileName) {
+#ifdef _MSC_VER
+  std::ifstream stream(antlrcpp::s2ws(fileName), std::ios::binary);
+#else
+  std::ifstream stream(fileName, std::ios::binary);
+#endif
+  if (!stream) {
+    throw IOException("Cannot read " + fileName);
+  }
+
+  std::stringstream buffer;
+  buffer << stream.rdbuf();
+  addInput(buffer.str(), fileName);
+}
+
+DFAPrecomputer::Statistics DFAPrecomputer::run(size_t threadCount) {
+  if (threadCount == 0) {
+    threadCount = std::max(std::thread::hardware_concurrency(), 1U);
+  }
+  threadCount = std::min(threadCount, std::max(_inputs.size(), static_cast<size_t>(1)));
+
+  // Each thread takes the next input until all are done.
+  std::atomic<size_t> next(0);
+  std::atomic<size_t> failures(0);
+  auto work = [this, &next, &failures]() {
+    for (size_t i = next++; i < _inputs.size(); i = next++) {
+      ANTLRInputStream input(_inputs[i].text);
+      input.name = _inputs[i].sourceName;
+      try {
+        _parse(&input);
+      } catch (std::exception &) {
+        ++failures;
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < threadCount; ++i) {
+    threads.emplace_back(work);
+  }
+  work();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  Statistics result;
+  result.inputs = _inputs.size();
+  result.failures = failures;
+  for (auto &entry : _entries) {
+    for (auto &dfa : *entry.decisionToDFA) {
+      result.states += dfa.getStatistics().states;
+    }
+  }
+  _inputs.clear();
+  return result;
+}
+
+std::vector<std::string> DFAPrecomputer::getSnapshots() {
+  std::vector<std::string> result;
+  for (auto &entry : _entries) {
+    result.push_back(DFASnapshot::save(*entry.atn, *entry.decisionToDFA));
+  }
+  return result;
+}
+
+std::string DFAPrecomputer::generateSource() {
+  static const char digits[] = "0123456789abcdef";
+
+  std::string result = "// Precomputed DFAs, generated by antlr4::dfa::DFAPrecomputer. Load them with\n"
+    "// antlr4::dfa::DFASnapshot::load() before the first parse.\n\n"
+    "#include <stddef.h>\n";
+
+  std::vector<std::string> snapshots = getSnapshots();
+  for (size_t i = 0; i < _entries.size(); ++i) {
+    const std::string &name = _entries[i].name;
+    const std::string &snapshot = snapshots[i];
+
+    result += "\nextern const unsigned char " + name + "[] = {";
+    for (size_t j = 0; j < snapshot.size(); ++j) {
+      unsigned char value = static_cast<unsigned char>(snapshot[j]);
+      result += j % 16 == 0 ? "\n  " : " ";
+      result += "0x";
+      result += digits[value >> 4];
+      result += digits[value & 0xF];
+      result += ",";
+    }
+    result += "\n};\n";
+    result += "extern const size_t " + name + "Size = sizeof(" + name + ");\n";
+  }
+  return result;
+}
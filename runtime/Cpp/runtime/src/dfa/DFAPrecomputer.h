@@ -0,0 +1,91 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include "antlr4-common.h"
+
+namespace antlr4 {
+namespace dfa {
+
+  /// Builds the DFAs of a grammar ahead of time by parsing a set of sample inputs, and writes them as C++ source which
+  /// can be compiled into the application (next to the generated recognizers). Loading that image at startup (see
+  /// DFASnapshot::load()) saves applications which only parse small inputs most of the DFA construction.
+  ///
+  /// The inputs are parsed in parallel. All threads work on the same DFAs (the generated recognizers share them), so
+  /// the result is a single merged DFA per decision, without duplicate states.
+  ///
+  /// Typical use, with the lexer and parser generated for a grammar T:
+  ///
+  ///   DFAPrecomputer precomputer([](CharStream *input) {
+  ///     TLexer lexer(input);
+  ///     CommonTokenStream tokens(&lexer);
+  ///     TParser parser(&tokens);
+  ///     parser.removeErrorListeners();
+  ///     parser.main();
+  ///   });
+  ///   ANTLRInputStream empty;
+  ///   TLexer lexer(&empty);
+  ///   CommonTokenStream tokens(&lexer);
+  ///   TParser parser(&tokens);
+  ///   precomputer.addRecognizer("TLexerDFA", &lexer);
+  ///   precomputer.addRecognizer("TParserDFA", &parser);
+  ///   for (auto &fileName : sampleFiles)
+  ///     precomputer.addFile(fileName);
+  ///   precomputer.run();
+  ///   std::ofstream("TDFA.cpp") << precomputer.generateSource();
+  class ANTLR4CPP_PUBLIC DFAPrecomputer {
+  public:
+    /// Parses one input. Must create its own lexer and parser, as it runs in several threads at the same time.
+    typedef std::function<void (CharStream *input)> ParseFunction;
+
+    struct Statistics {
+      size_t inputs = 0;   // Number of parsed inputs.
+      size_t failures = 0; // Inputs for which the parse function threw an exception.
+      size_t states = 0;   // Number of states in all DFAs after the run.
+    };
+
+    DFAPrecomputer(ParseFunction parse);
+
+    /// Adds DFAs to precompute. The name is used for the array holding their image in the generated source.
+    void addDFAs(const std::string &name, const atn::ATN &atn, std::vector<DFA> &decisionToDFA);
+
+    /// Adds the DFAs used by the given lexer or parser (for generated recognizers these are shared by all instances).
+    void addRecognizer(const std::string &name, Recognizer *recognizer);
+
+    void addInput(const std::string &input, const std::string &sourceName);
+
+    /// @throws IOException if the file can't be read.
+    void addFile(const std::string &fileName);
+
+    /// Parses all inputs which were added since the last run. 0 threads means one per hardware thread.
+    Statistics run(size_t threadCount = 0);
+
+    /// Returns the snapshots (see DFASnapshot) of the added DFAs, in the order they were added.
+    std::vector<std::string> getSnapshots();
+
+    /// Generates a C++ source file with one array per added set of DFAs, defined as
+    /// {@code extern const unsigned char <name>[]} with its size in {@code extern const size_t <name>Size}.
+    std::string generateSource();
+
+  private:
+    struct Entry {
+      std::string name;
+      const atn::ATN *atn;
+      std::vector<DFA> *decisionToDFA;
+    };
+
+    struct Input {
+      std::string text;
+      std::string sourceName;
+    };
+
+    ParseFunction _parse;
+    std::vector<Entry> _entries;
+    std::vector<Input> _inputs;
+  };
+
+} // namespace dfa
+} // namespace antlr4
@@ -0,0 +1,856 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include "Exceptions.h"
+#include "misc/MurmurHash.h"
+#include "atn/ATN.h"
+#include "atn/ATNDeserializer.h"
+#include "atn/ATNSerializer.h"
+#include "atn/ATNSimulator.h"
+#include "atn/ATNType.h"
+#include "atn/ATNConfigSet.h"
+#include "atn/OrderedATNConfigSet.h"
+#include "atn/LexerATNConfig.h"
+#include "atn/LexerATNSimulator.h"
+#include "atn/LexerActionExecutor.h"
+#include "atn/LexerIndexedCustomAction.h"
+#include "atn/SemanticContext.h"
+#include "atn/SingletonPredictionContext.h"
+#include "atn/ArrayPredictionContext.h"
+#include "support/CPPUtils.h"
+#include "dfa/DFA.h"
+
+#include "dfa/DFASnapshot.h"
+
+using namespace antlr4;
+using namespace antlr4::atn;
+using namespace antlr4::dfa;
+using namespace antlrcpp;
+
+const uint32_t DFASnapshot::VERSION;
+
+namespace {
+
+  const char MAGIC[] = "ANTLRDFA";
+  const size_t MAGIC_SIZE = 8;
+
+  // Special ids for missing table entries and edges to the error state (which is not owned by the DFA).
+  const uint32_t NO_ID = 0xFFFFFFFF;
+  const uint32_t ERROR_ID = 0xFFFFFFFE;
+
+  enum ContextKind : uint8_t {
+    EMPTY_CONTEXT,
+    SINGLETON_CONTEXT,
+    ARRAY_CONTEXT
+  };
+
+  enum SemanticContextKind : uint8_t {
+    NONE_PREDICATE,
+    PREDICATE,
+    PRECEDENCE_PREDICATE,
+    AND_OPERATOR,
+    OR_OPERATOR
+  };
+
+  enum DFAFlags : uint8_t {
+    PRECEDENCE_DFA = 1,
+    COMPACT_STATES = 2
+  };
+
+  enum StateFlags : uint8_t {
+    ACCEPT_STATE = 1,
+    REQUIRES_FULL_CONTEXT = 2,
+    HAS_CONFIGS = 4,
+    HAS_FINGERPRINT = 8
+  };
+
+  enum ConfigSetFlags : uint8_t {
+    FULL_CONTEXT = 1,
+    HAS_SEMANTIC_CONTEXT = 2,
+    DIPS_INTO_OUTER_CONTEXT = 4,
+    READONLY = 8
+  };
+
+  void fail(const std::string &message) {
+    throw IllegalArgumentException("Invalid DFA snapshot: " + message);
+  }
+
+  // All values are stored little endian, independent of the platform.
+  class Writer {
+  public:
+    std::string data;
+
+    void write8(uint8_t value) {
+      data.push_back(static_cast<char>(value));
+    }
+
+    void write32(uint32_t value) {
+      for (size_t i = 0; i < 4; ++i) {
+        data.push_back(static_cast<char>(value >> (8 * i)));
+      }
+    }
+
+    void write64(uint64_t value) {
+      for (size_t i = 0; i < 8; ++i) {
+        data.push_back(static_cast<char>(value >> (8 * i)));
+      }
+    }
+
+    void writeCount(size_t count) {
+      if (count >= NO_ID) {
+        throw IllegalStateException("Too many entries for a DFA snapshot.");
+      }
+      write32(static_cast<uint32_t>(count));
+    }
+
+    void writeString(const std::string &value) {
+      writeCount(value.size());
+      data += value;
+    }
+  };
+
+  class Reader {
+  public:
+    Reader(const void *data, size_t size) : _data(static_cast<const uint8_t *>(data)), _size(size), _offset(0) {
+    }
+
+    uint8_t read8() {
+      need(1);
+      return _data[_offset++];
+    }
+
+    uint32_t read32() {
+      need(4);
+      uint32_t result = 0;
+      for (size_t i = 0; i < 4; ++i) {
+        result |= static_cast<uint32_t>(_data[_offset++]) << (8 * i);
+      }
+      return result;
+    }
+
+    uint64_t read64() {
+      need(8);
+      uint64_t result = 0;
+      for (size_t i = 0; i < 8; ++i) {
+        result |= static_cast<uint64_t>(_data[_offset++]) << (8 * i);
+      }
+      return result;
+    }
+
+    size_t readSize() {
+      uint64_t result = read64();
+      if (result > std::numeric_limits<size_t>::max()) {
+        fail("value out of range");
+      }
+      return static_cast<size_t>(result);
+    }
+
+    // Reads a count of entries which take at least entrySize bytes each, so a damaged count is detected before
+    // anything is allocated for it.
+    size_t readCount(size_t entrySize) {
+      size_t result = read32();
+      if (result > (_size - _offset) / std::max(entrySize, static_cast<size_t>(1))) {
+        fail("unexpected end of data");
+      }
+      return result;
+    }
+
+    // Reads the id of an entry in a table with the given size. NO_ID is accepted if optional is true.
+    uint32_t readId(size_t tableSize, bool optional = false) {
+      uint32_t result = read32();
+      if ((result != NO_ID || !optional) && result >= tableSize) {
+        fail("reference out of range");
+      }
+      return result;
+    }
+
+    std::string readString() {
+      size_t length = readCount(1);
+      std::string result(reinterpret_cast<const char *>(_data + _offset), length);
+      _offset += length;
+      return result;
+    }
+
+    bool atEnd() const {
+      return _offset == _size;
+    }
+
+  private:
+    const uint8_t *_data;
+    const size_t _size;
+    size_t _offset;
+
+    void need(size_t bytes) {
+      if (_size - _offset < bytes) {
+        fail("unexpected end of data");
+      }
+    }
+  };
+
+  void writeHeader(Writer &writer, const ATN &atn, size_t dfaCount) {
+    writer.data.append(MAGIC, MAGIC_SIZE);
+    writer.write32(DFASnapshot::VERSION);
+    writer.write8(static_cast<uint8_t>(sizeof(size_t)));
+    writer.writeString(ATNDeserializer::SERIALIZED_UUID().toString());
+    writer.write64(DFASnapshot::getChecksum(atn));
+    writer.write32(static_cast<uint32_t>(atn.grammarType));
+    writer.writeCount(dfaCount);
+  }
+
+  // Returns the number of DFAs in the snapshot.
+  size_t readHeader(Reader &reader, const ATN &atn) {
+    for (size_t i = 0; i < MAGIC_SIZE; ++i) {
+      if (reader.read8() != static_cast<uint8_t>(MAGIC[i])) {
+        fail("not a DFA snapshot");
+      }
+    }
+    if (reader.read32() != DFASnapshot::VERSION) {
+      fail("unsupported version");
+    }
+    if (reader.read8() != sizeof(size_t)) {
+      fail("taken on a platform with a different word size");
+    }
+    if (reader.readString() != ATNDeserializer::SERIALIZED_UUID().toString()) {
+      fail("taken with a different ATN serialization format");
+    }
+    if (reader.read64() != DFASnapshot::getChecksum(atn) || reader.read32() != static_cast<uint32_t>(atn.grammarType)) {
+      fail("taken from a different ATN");
+    }
+    return reader.readCount(0);
+  }
+
+  class SnapshotWriter {
+  public:
+    SnapshotWriter(const ATN &atn) : _atn(atn), _contextCount(0), _semanticContextCount(0), _executorCount(0) {
+    }
+
+    void writeDFA(DFA &dfa) {
+      std::lock_guard<std::mutex> lck(dfa.getLock());
+
+      // States are numbered consecutively when added (see DFA::addState()), so their number is their id.
+      std::vector<DFAState *> states = dfa.getStates();
+      for (size_t i = 0; i < states.size(); ++i) {
+        if (states[i]->stateNumber != static_cast<int>(i)) {
+          throw IllegalStateException("DFA states are not numbered consecutively.");
+        }
+      }
+
+      _body.writeCount(dfa.decision);
+      _body.write8((dfa.isPrecedenceDfa() ? PRECEDENCE_DFA : 0) | (dfa.hasCompactStates() ? COMPACT_STATES : 0));
+      _body.writeCount(states.size());
+      for (DFAState *state : states) {
+        writeState(state);
+      }
+
+      for (DFAState *state : states) {
+        std::vector<std::pair<size_t, DFAState *>> edges = state->edges.getEdges();
+        _body.writeCount(edges.size());
+        for (auto &edge : edges) {
+          _body.write64(edge.first);
+          _body.write32(getStateId(dfa, edge.second));
+        }
+
+        std::vector<DFAEdgeMap::Range> ranges = state->edges.getRanges();
+        _body.writeCount(ranges.size());
+        for (auto &range : ranges) {
+          _body.write64(range.a);
+          _body.write64(range.b);
+          _body.write32(getStateId(dfa, range.target));
+        }
+      }
+
+      DFAState *s0 = dfa.s0.load();
+      if (dfa.isPrecedenceDfa()) {
+        // The start states for the individual precedence levels are the edges of the special start state.
+        std::vector<std::pair<size_t, DFAState *>> edges = s0->edges.getEdges();
+        _body.writeCount(edges.size());
+        for (auto &edge : edges) {
+          _body.write64(edge.first);
+          _body.write32(getStateId(dfa, edge.second));
+        }
+      } else {
+        _body.write32(s0 == nullptr ? NO_ID : getStateId(dfa, s0));
+      }
+    }
+
+    std::string finish(size_t dfaCount) {
+      Writer result;
+      writeHeader(result, _atn, dfaCount);
+      result.writeCount(_contextCount);
+      result.data += _contexts.data;
+      result.writeCount(_semanticContextCount);
+      result.data += _semanticContexts.data;
+      result.writeCount(_executorCount);
+      result.data += _executors.data;
+      result.data += _body.data;
+      return result.data;
+    }
+
+  private:
+    const ATN &_atn;
+
+    // The shared tables. Entries only refer to entries written before them.
+    Writer _contexts;
+    size_t _contextCount;
+    std::unordered_map<const PredictionContext *, uint32_t> _contextIds;
+    Writer _semanticContexts;
+    size_t _semanticContextCount;
+    std::unordered_map<const SemanticContext *, uint32_t> _semanticContextIds;
+    Writer _executors;
+    size_t _executorCount;
+    std::unordered_map<const LexerActionExecutor *, uint32_t> _executorIds;
+
+    Writer _body;
+
+    uint32_t getStateId(DFA &dfa, DFAState *state) {
+      if (state == ATNSimulator::ERROR.get()) {
+        return ERROR_ID;
+      }
+      auto iterator = dfa.states.find(state);
+      if (iterator == dfa.states.end() || *iterator != state) {
+        throw IllegalStateException("DFA edge to a state not owned by the DFA.");
+      }
+      return static_cast<uint32_t>(state->stateNumber);
+    }
+
+    uint32_t getContextId(RefPtr<PredictionContext> const& context) {
+      if (!context) {
+        return NO_ID;
+      }
+
+      auto iterator = _contextIds.find(context.get());
+      if (iterator != _contextIds.end()) {
+        return iterator->second;
+      }
+
+      Writer entry;
+      switch (context->getContextType()) {
+        case PredictionContextType::EMPTY:
+          entry.write8(EMPTY_CONTEXT);
+          break;
+
+        case PredictionContextType::SINGLETON: {
+          const SingletonPredictionContext *singleton = static_cast<const SingletonPredictionContext *>(context.get());
+          entry.write8(SINGLETON_CONTEXT);
+          entry.write32(getContextId(singleton->parent));
+          entry.write64(singleton->returnState);
+          break;
+        }
+
+        case PredictionContextType::ARRAY: {
+          const ArrayPredictionContext *array = static_cast<const ArrayPredictionContext *>(context.get());
+          entry.write8(ARRAY_CONTEXT);
+          entry.writeCount(array->parents.size());
+          for (size_t i = 0; i < array->parents.size(); ++i) {
+            entry.write32(getContextId(array->parents[i]));
+            entry.write64(array->returnStates[i]);
+          }
+          break;
+        }
+      }
+
+      _contexts.data += entry.data;
+      return _contextIds[context.get()] = static_cast<uint32_t>(_contextCount++);
+    }
+
+    uint32_t getSemanticContextId(RefPtr<SemanticContext> const& context) {
+      auto iterator = _semanticContextIds.find(context.get());
+      if (iterator != _semanticContextIds.end()) {
+        return iterator->second;
+      }
+
+      Writer entry;
+      if (context == SemanticContext::NONE) {
+        entry.write8(NONE_PREDICATE);
+      } else if (is<SemanticContext::Predicate>(context)) {
+        const SemanticContext::Predicate *predicate = static_cast<const SemanticContext::Predicate *>(context.get());
+        entry.write8(PREDICATE);
+        entry.write64(predicate->ruleIndex);
+        entry.write64(predicate->predIndex);
+        entry.write8(predicate->isCtxDependent ? 1 : 0);
+      } else if (is<SemanticContext::PrecedencePredicate>(context)) {
+        const SemanticContext::PrecedencePredicate *predicate =
+          static_cast<const SemanticContext::PrecedencePredicate *>(context.get());
+        entry.write8(PRECEDENCE_PREDICATE);
+        entry.write32(static_cast<uint32_t>(predicate->precedence));
+      } else {
+        bool isAnd = is<SemanticContext::AND>(context);
+        std::vector<RefPtr<SemanticContext>> operands = static_cast<SemanticContext::Operator *>(context.get())->getOperands();
+        entry.write8(isAnd ? AND_OPERATOR : OR_OPERATOR);
+        entry.writeCount(operands.size());
+        for (auto &operand : operands) {
+          entry.write32(getSemanticContextId(operand));
+        }
+      }
+
+      _semanticContexts.data += entry.data;
+      return _semanticContextIds[context.get()] = static_cast<uint32_t>(_semanticContextCount++);
+    }
+
+    uint32_t getActionIndex(Ref<LexerAction> const& action) {
+      for (size_t i = 0; i < _atn.lexerActions.size(); ++i) {
+        if (_atn.lexerActions[i] == action || *_atn.lexerActions[i] == *action) {
+          return static_cast<uint32_t>(i);
+        }
+      }
+      throw IllegalStateException("Lexer action not found in the ATN.");
+    }
+
+    uint32_t getExecutorId(Ref<LexerActionExecutor> const& executor) {
+      if (executor == nullptr) {
+        return NO_ID;
+      }
+
+      auto iterator = _executorIds.find(executor.get());
+      if (iterator != _executorIds.end()) {
+        return iterator->second;
+      }
+
+      // Actions are stored by their index in the ATN. Position dependent actions can be wrapped with their offset.
+      std::vector<Ref<LexerAction>> actions = executor->getLexerActions();
+      _executors.writeCount(actions.size());
+      for (auto &action : actions) {
+        if (is<LexerIndexedCustomAction>(action)) {
+          Ref<LexerIndexedCustomAction> indexed = std::static_pointer_cast<LexerIndexedCustomAction>(action);
+          _executors.write8(1);
+          _executors.write32(static_cast<uint32_t>(indexed->getOffset()));
+          _executors.write32(getActionIndex(indexed->getAction()));
+        } else {
+          _executors.write8(0);
+          _executors.write32(getActionIndex(action));
+        }
+      }
+
+      return _executorIds[executor.get()] = static_cast<uint32_t>(_executorCount++);
+    }
+
+    void writeState(DFAState *state) {
+      uint8_t flags = (state->isAcceptState ? ACCEPT_STATE : 0) | (state->requiresFullContext ? REQUIRES_FULL_CONTEXT : 0)
+        | (state->configs != nullptr ? HAS_CONFIGS : 0) | (state->hasFingerprint() ? HAS_FINGERPRINT : 0);
+      _body.write8(flags);
+      _body.write64(state->prediction);
+      _body.write32(getExecutorId(state->lexerActionExecutor));
+
+      _body.writeCount(state->predicates.size());
+      for (auto *predicate : state->predicates) {
+        _body.write32(getSemanticContextId(predicate->pred));
+        _body.write32(static_cast<uint32_t>(predicate->alt));
+      }
+
+      if (state->hasFingerprint()) {
+        std::pair<uint64_t, uint64_t> fingerprint = state->getFingerprint();
+        _body.write64(fingerprint.first);
+        _body.write64(fingerprint.second);
+      }
+
+      if (state->configs != nullptr) {
+        writeConfigs(*state->configs);
+      }
+    }
+
+    void writeConfigs(ATNConfigSet &configs) {
+      bool isLexer = _atn.grammarType == ATNType::LEXER;
+      _body.write8((configs.fullCtx ? FULL_CONTEXT : 0) | (configs.hasSemanticContext ? HAS_SEMANTIC_CONTEXT : 0)
+        | (configs.dipsIntoOuterContext ? DIPS_INTO_OUTER_CONTEXT : 0) | (configs.isReadonly() ? READONLY : 0));
+      _body.write64(configs.uniqueAlt);
+
+      _body.writeCount(configs.conflictingAlts.count());
+      for (size_t alt = configs.conflictingAlts.nextSetBit(0); alt != INVALID_INDEX;
+           alt = configs.conflictingAlts.nextSetBit(alt + 1)) {
+        _body.write64(alt);
+      }
+
+      _body.writeCount(configs.size());
+      for (auto &config : configs.configs) {
+        _body.write32(static_cast<uint32_t>(config->state->stateNumber));
+        _body.write64(config->alt);
+        _body.write32(getContextId(config->context));
+        _body.write32(getSemanticContextId(config->semanticContext));
+        _body.write64(config->reachesIntoOuterContext);
+        if (isLexer) {
+          Ref<LexerATNConfig> lexerConfig = std::static_pointer_cast<LexerATNConfig>(config);
+          _body.write32(getExecutorId(lexerConfig->getLexerActionExecutor()));
+          _body.write8(lexerConfig->hasPassedThroughNonGreedyDecision() ? 1 : 0);
+        }
+      }
+    }
+  };
+
+  class SnapshotReader {
+  public:
+    struct Edge {
+      DFAState *from;
+      size_t a;
+      size_t b;
+      DFAState *to;
+      bool isRange;
+    };
+
+    // A DFA as read from the snapshot, which can be installed without further checks.
+    struct LoadedDFA {
+      bool compactStates;
+      std::vector<std::unique_ptr<DFAState>> states;
+      std::vector<Edge> edges;
+      DFAState *s0;
+      std::vector<std::pair<size_t, DFAState *>> precedenceStartStates;
+    };
+
+    SnapshotReader(const ATN &atn, Reader &reader) : _atn(atn), _reader(reader) {
+    }
+
+    void readTables() {
+      size_t count = _reader.readCount(1);
+      for (size_t i = 0; i < count; ++i) {
+        _contexts.push_back(readContext());
+      }
+
+      count = _reader.readCount(1);
+      for (size_t i = 0; i < count; ++i) {
+        _semanticContexts.push_back(readSemanticContext());
+      }
+
+      count = _reader.readCount(4);
+      for (size_t i = 0; i < count; ++i) {
+        _executors.push_back(readExecutor());
+      }
+    }
+
+    void readDFA(DFA &dfa, LoadedDFA &loaded) {
+      uint32_t decision = _reader.read32();
+      uint8_t flags = _reader.read8();
+      if (decision != dfa.decision || ((flags & PRECEDENCE_DFA) != 0) != dfa.isPrecedenceDfa()) {
+        fail("DFA doesn't match the decision");
+      }
+      loaded.compactStates = (flags & COMPACT_STATES) != 0;
+
+      size_t count = _reader.readCount(17);
+      for (size_t i = 0; i < count; ++i) {
+        loaded.states.push_back(std::unique_ptr<DFAState>(readState(loaded.compactStates)));
+      }
+
+      for (size_t i = 0; i < count; ++i) {
+        DFAState *from = loaded.states[i].get();
+        size_t edgeCount = _reader.readCount(12);
+        for (size_t j = 0; j < edgeCount; ++j) {
+          size_t symbol = _reader.readSize();
+          loaded.edges.push_back({ from, symbol, symbol, readState(loaded), false });
+        }
+
+        edgeCount = _reader.readCount(20);
+        for (size_t j = 0; j < edgeCount; ++j) {
+          size_t a = _reader.readSize();
+          size_t b = _reader.readSize();
+          loaded.edges.push_back({ from, a, b, readState(loaded), true });
+        }
+      }
+
+      loaded.s0 = nullptr;
+      if (dfa.isPrecedenceDfa()) {
+        size_t edgeCount = _reader.readCount(12);
+        for (size_t j = 0; j < edgeCount; ++j) {
+          size_t precedence = _reader.readSize();
+          loaded.precedenceStartStates.push_back({ precedence, readState(loaded) });
+        }
+      } else {
+        uint32_t id = _reader.readId(loaded.states.size(), true);
+        loaded.s0 = id == NO_ID ? nullptr : loaded.states[id].get();
+      }
+    }
+
+  private:
+    const ATN &_atn;
+    Reader &_reader;
+
+    std::vector<RefPtr<PredictionContext>> _contexts;
+    std::vector<RefPtr<SemanticContext>> _semanticContexts;
+    std::vector<Ref<LexerActionExecutor>> _executors;
+
+    RefPtr<PredictionContext> readContextId() {
+      uint32_t id = _reader.readId(_contexts.size(), true);
+      return id == NO_ID ? nullptr : _contexts[id];
+    }
+
+    RefPtr<PredictionContext> readContext() {
+      switch (_reader.read8()) {
+        case EMPTY_CONTEXT:
+          return PredictionContext::EMPTY;
+
+        case SINGLETON_CONTEXT: {
+          RefPtr<PredictionContext> parent = readContextId();
+          size_t returnState = _reader.readSize();
+          return makeRefPtr<SingletonPredictionContext>(parent, returnState);
+        }
+
+        case ARRAY_CONTEXT: {
+          size_t count = _reader.readCount(12);
+          if (count == 0) {
+            fail("empty context");
+          }
+          std::vector<RefPtr<PredictionContext>> parents;
+          std::vector<size_t> returnStates;
+          for (size_t i = 0; i < count; ++i) {
+            parents.push_back(readContextId());
+            returnStates.push_back(_reader.readSize());
+          }
+          return makeRefPtr<ArrayPredictionContext>(parents, returnStates);
+        }
+
+        default:
+          fail("unknown context type");
+          return nullptr;
+      }
+    }
+
+    RefPtr<SemanticContext> readSemanticContext() {
+      uint8_t kind = _reader.read8();
+      switch (kind) {
+        case NONE_PREDICATE:
+          return SemanticContext::NONE;
+
+        case PREDICATE: {
+          size_t ruleIndex = _reader.readSize();
+          size_t predIndex = _reader.readSize();
+          bool isCtxDependent = _reader.read8() != 0;
+          return makeRefPtr<SemanticContext::Predicate>(ruleIndex, predIndex, isCtxDependent);
+        }
+
+        case PRECEDENCE_PREDICATE:
+          return makeRefPtr<SemanticContext::PrecedencePredicate>(static_cast<int>(_reader.read32()));
+
+        case AND_OPERATOR:
+        case OR_OPERATOR: {
+          size_t count = _reader.readCount(4);
+          if (count < 2) {
+            fail("operator with less than two operands");
+          }
+          std::vector<RefPtr<SemanticContext>> operands;
+          for (size_t i = 0; i < count; ++i) {
+            operands.push_back(_semanticContexts[_reader.readId(_semanticContexts.size())]);
+          }
+
+          // The operand order is part of the identity of an operator, so it's restored as is (the constructors
+          // would order the operands by their hash instead).
+          if (kind == AND_OPERATOR) {
+            RefPtr<SemanticContext::AND> result = makeRefPtr<SemanticContext::AND>(operands[0], operands[1]);
+            result->opnds = std::move(operands);
+            return result;
+          }
+          RefPtr<SemanticContext::OR> result = makeRefPtr<SemanticContext::OR>(operands[0], operands[1]);
+          result->opnds = std::move(operands);
+          return result;
+        }
+
+        default:
+          fail("unknown semantic context type");
+          return nullptr;
+      }
+    }
+
+    Ref<LexerAction> readAction() {
+      return _atn.lexerActions[_reader.readId(_atn.lexerActions.size())];
+    }
+
+    Ref<LexerActionExecutor> readExecutor() {
+      size_t count = _reader.readCount(5);
+      std::vector<Ref<LexerAction>> actions;
+      for (size_t i = 0; i < count; ++i) {
+        if (_reader.read8() != 0) {
+          int offset = static_cast<int>(_reader.read32());
+          actions.push_back(std::make_shared<LexerIndexedCustomAction>(offset, readAction()));
+        } else {
+          actions.push_back(readAction());
+        }
+      }
+      return std::make_shared<LexerActionExecutor>(actions);
+    }
+
+    Ref<LexerActionExecutor> readExecutorId() {
+      uint32_t id = _reader.readId(_executors.size(), true);
+      return id == NO_ID ? nullptr : _executors[id];
+    }
+
+    DFAState* readState(LoadedDFA &loaded) {
+      uint32_t id = _reader.read32();
+      if (id == ERROR_ID) {
+        return ATNSimulator::ERROR.get();
+      }
+      if (id >= loaded.states.size()) {
+        fail("reference out of range");
+      }
+      return loaded.states[id].get();
+    }
+
+    DFAState* readState(bool compactStates) {
+      std::unique_ptr<DFAState> state(_atn.grammarType == ATNType::LEXER ?
+        new DFAState(std::unique_ptr<ATNConfigSet>(), LexerATNSimulator::MAX_DFA_EDGE - LexerATNSimulator::MIN_DFA_EDGE + 1) :
+        new DFAState());
+
+      uint8_t flags = _reader.read8();
+      state->isAcceptState = (flags & ACCEPT_STATE) != 0;
+      state->requiresFullContext = (flags & REQUIRES_FULL_CONTEXT) != 0;
+      state->prediction = _reader.readSize();
+      state->lexerActionExecutor = readExecutorId();
+
+      size_t count = _reader.readCount(8);
+      for (size_t i = 0; i < count; ++i) {
+        RefPtr<SemanticContext> pred = _semanticContexts[_reader.readId(_semanticContexts.size())];
+        int alt = static_cast<int>(_reader.read32());
+        state->predicates.push_back(new DFAState::PredPrediction(pred, alt)); /* mem-check: managed by the state */
+      }
+
+      // States of compact DFAs are identified by their fingerprint, all others by their configurations.
+      if (((flags & HAS_FINGERPRINT) != 0) != compactStates || ((flags & HAS_CONFIGS) == 0 && !compactStates)) {
+        fail("inconsistent state");
+      }
+      if ((flags & HAS_FINGERPRINT) != 0) {
+        uint64_t low = _reader.read64();
+        uint64_t high = _reader.read64();
+        state->setFingerprint({ low, high });
+      }
+      if ((flags & HAS_CONFIGS) != 0) {
+        state->configs = readConfigs();
+      }
+
+      return state.release();
+    }
+
+    std::unique_ptr<ATNConfigSet> readConfigs() {
+      bool isLexer = _atn.grammarType == ATNType::LEXER;
+      uint8_t flags = _reader.read8();
+      std::unique_ptr<ATNConfigSet> configs(isLexer ? new OrderedATNConfigSet() : new ATNConfigSet((flags & FULL_CONTEXT) != 0));
+      size_t uniqueAlt = _reader.readSize();
+
+      size_t count = _reader.readCount(8);
+      for (size_t i = 0; i < count; ++i) {
+        configs->conflictingAlts.set(_reader.readSize());
+      }
+
+      count = _reader.readCount(isLexer ? 33 : 28);
+      for (size_t i = 0; i < count; ++i) {
+        ATNState *atnState = _atn.states[_reader.readId(_atn.states.size())];
+        size_t alt = _reader.readSize();
+        RefPtr<PredictionContext> context = readContextId();
+        RefPtr<SemanticContext> semanticContext = _semanticContexts[_reader.readId(_semanticContexts.size())];
+        size_t reachesIntoOuterContext = _reader.readSize();
+        if (atnState == nullptr || !context) {
+          fail("incomplete configuration");
+        }
+
+        Ref<ATNConfig> config;
+        if (isLexer) {
+          Ref<LexerActionExecutor> executor = readExecutorId();
+          bool passedThroughNonGreedyDecision = _reader.read8() != 0;
+          config = std::make_shared<LexerATNConfig>(atnState, static_cast<int>(alt), context, executor,
+                                                    passedThroughNonGreedyDecision);
+        } else {
+          config = std::make_shared<ATNConfig>(atnState, alt, context, semanticContext);
+        }
+        config->reachesIntoOuterContext = reachesIntoOuterContext;
+        configs->add(config);
+      }
+
+      configs->uniqueAlt = uniqueAlt;
+      configs->hasSemanticContext = (flags & HAS_SEMANTIC_CONTEXT) != 0;
+      configs->dipsIntoOuterContext = (flags & DIPS_INTO_OUTER_CONTEXT) != 0;
+      configs->setReadonly((flags & READONLY) != 0);
+      return configs;
+    }
+  };
+
+  std::string readStream(std::istream &input) {
+    std::stringstream buffer;
+    buffer << input.rdbuf();
+    return buffer.str();
+  }
+
+} // namespace
+
+void DFASnapshot::save(const atn::ATN &atn, std::vector<DFA> &decisionToDFA, std::ostream &output) {
+  std::string data = save(atn, decisionToDFA);
+  output.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+std::string DFASnapshot::save(const atn::ATN &atn, std::vector<DFA> &decisionToDFA) {
+  SnapshotWriter writer(atn);
+  for (auto &dfa : decisionToDFA) {
+    writer.writeDFA(dfa);
+  }
+  return writer.finish(decisionToDFA.size());
+}
+
+void DFASnapshot::load(const atn::ATN &atn, std::vector<DFA> &decisionToDFA, const void *data, size_t size) {
+  Reader reader(data, size);
+  if (readHeader(reader, atn) != decisionToDFA.size()) {
+    fail("different number of decisions");
+  }
+
+  // Everything is read and checked first, so a damaged snapshot leaves the DFAs as they are.
+  SnapshotReader snapshotReader(atn, reader);
+  snapshotReader.readTables();
+  std::vector<SnapshotReader::LoadedDFA> loadedDFAs(decisionToDFA.size());
+  for (size_t i = 0; i < decisionToDFA.size(); ++i) {
+    snapshotReader.readDFA(decisionToDFA[i], loadedDFAs[i]);
+  }
+  if (!reader.atEnd()) {
+    fail("unexpected data at the end");
+  }
+
+  for (size_t i = 0; i < decisionToDFA.size(); ++i) {
+    DFA &dfa = decisionToDFA[i];
+    SnapshotReader::LoadedDFA &loaded = loadedDFAs[i];
+
+    std::lock_guard<std::mutex> lck(dfa.getLock());
+    if (!dfa.states.empty()) {
+      dfa.resetLocked();
+      dfa.reclaim();
+    }
+    dfa._compactStates = loaded.compactStates;
+
+    for (auto &state : loaded.states) {
+      dfa.addState(state.release());
+    }
+    for (auto &edge : loaded.edges) {
+      if (edge.isRange) {
+        dfa.addRangeEdge(edge.from, edge.a, edge.b, edge.to);
+      } else {
+        dfa.addEdge(edge.from, edge.a, edge.to);
+      }
+    }
+
+    // The states become visible to other threads with the start state.
+    if (dfa.isPrecedenceDfa()) {
+      for (auto &start : loaded.precedenceStartStates) {
+        dfa.setPrecedenceStartState(static_cast<int>(start.first), start.second);
+      }
+    } else {
+      dfa.s0.store(loaded.s0, std::memory_order_release);
+    }
+  }
+}
+
+void DFASnapshot::load(const atn::ATN &atn, std::vector<DFA> &decisionToDFA, std::istream &input) {
+  std::string data = readStream(input);
+  load(atn, decisionToDFA, data.data(), data.size());
+}
+
+bool DFASnapshot::isCompatible(const atn::ATN &atn, const void *data, size_t size) {
+  try {
+    Reader reader(data, size);
+    readHeader(reader, atn);
+    return true;
+  } catch (IllegalArgumentException &) {
+    return false;
+  }
+}
+
+uint64_t DFASnapshot::getChecksum(const atn::ATN &atn) {
+  // The checksum identifies the grammar (and its version) the snapshot was taken from.
+  std::vector<size_t> serialized = ATNSerializer::getSerialized(const_cast<ATN *>(&atn));
+  size_t hash = misc::MurmurHash::initialize();
+  for (size_t value : serialized) {
+    hash = misc::MurmurHash::update(hash, value);
+  }
+  return misc::MurmurHash::finish(hash, serialized.size());
+}
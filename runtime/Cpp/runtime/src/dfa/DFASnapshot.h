@@ -0,0 +1,50 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include "antlr4-common.h"
+
+namespace antlr4 {
+namespace dfa {
+
+  /// Saves the DFAs of a recognizer (its decisionToDFA vector) in a binary format and restores them later, e.g. to
+  /// start a new process with the DFAs warmed up by an earlier one instead of building them again from live input.
+  ///
+  /// A snapshot holds everything needed to continue prediction (and to extend the DFAs) exactly as before: states with
+  /// their configurations, edges (including range edges), predictions, predicates and lexer action executors. Prediction
+  /// contexts, semantic contexts and lexer action executors shared between states are stored only once.
+  ///
+  /// A snapshot can only be loaded for the ATN it was taken from. It records the ATN serialization UUID and a checksum
+  /// of the serialized ATN, so a snapshot of another grammar (or of an older version of the same grammar) is rejected.
+  /// Snapshots also depend on the word size of the platform.
+  ///
+  /// load() takes a plain memory block, so a snapshot file can be mapped into memory instead of being read.
+  class ANTLR4CPP_PUBLIC DFASnapshot {
+  public:
+    static const uint32_t VERSION = 2; // 2: fingerprints of compact states are built from the context structure.
+
+    /// Writes the DFAs for the given ATN to the stream. Each DFA is locked while it is written, so this can be done
+    /// while other threads use them.
+    static void save(const atn::ATN &atn, std::vector<DFA> &decisionToDFA, std::ostream &output);
+    static std::string save(const atn::ATN &atn, std::vector<DFA> &decisionToDFA);
+
+    /// Replaces the states of the DFAs by the ones in the snapshot. The DFAs can be in use by other threads meanwhile
+    /// (their old states are retired as with DFA::reset()).
+    ///
+    /// @throws IllegalArgumentException if the snapshot was not taken from the given ATN or is damaged. The DFAs
+    /// are left untouched then.
+    static void load(const atn::ATN &atn, std::vector<DFA> &decisionToDFA, const void *data, size_t size);
+    static void load(const atn::ATN &atn, std::vector<DFA> &decisionToDFA, std::istream &input);
+
+    /// Checks if a snapshot was taken from the given ATN, without loading it.
+    static bool isCompatible(const atn::ATN &atn, const void *data, size_t size);
+
+    /// Returns the checksum which identifies the given ATN in snapshots (a hash of its serialized form).
+    static uint64_t getChecksum(const atn::ATN &atn);
+  };
+
+} // namespace dfa
+} // namespace antlr4
@@ -6,6 +6,7 @@
 #include "atn/ATNConfigSet.h"
 #include "atn/SemanticContext.h"
 #include "atn/ATNConfig.h"
+#include "atn/PredictionContext.h"
 #include "misc/MurmurHash.h"
 
 #include "dfa/DFAState.h"
@@ -13,7 +14,109 @@
 using namespace antlr4::dfa;
 using namespace antlr4::atn;
 
-DFAState::PredPrediction::PredPrediction(const Ref<SemanticContext> &pred, int alt) : pred(pred) {
+namespace {
+
+  // Builds a 128 bit fingerprint from two independent 64 bit lanes. Each lane is a multiply/rotate hash with its own
+  // constants (as used by MurmurHash3), finished with the MurmurHash3 avalanche step.
+  class FingerprintBuilder {
+  public:
+    FingerprintBuilder() : _low(0x243F6A8885A308D3ULL), _high(0x13198A2E03707344ULL) {
+    }
+
+    void add(uint64_t value) {
+      _low = rotate(_low ^ (value * 0x87C37B91114253D5ULL), 31) * 5 + 0x52DCE729;
+      _high = rotate(_high ^ (value * 0x4CF5AD432745937FULL), 33) * 5 + 0x38495AB5;
+    }
+
+    void add(std::pair<uint64_t, uint64_t> const& fingerprint) {
+      add(fingerprint.first);
+      add(fingerprint.second);
+    }
+
+    std::pair<uint64_t, uint64_t> finish() const {
+      return { avalanche(_low), avalanche(_high) };
+    }
+
+  private:
+    uint64_t _low;
+    uint64_t _high;
+
+    static uint64_t rotate(uint64_t value, int count) {
+      return (value << count) | (value >> (64 - count));
+    }
+
+    static uint64_t avalanche(uint64_t value) {
+      value ^= value >> 33;
+      value *= 0xFF51AFD7ED558CCDULL;
+      value ^= value >> 33;
+      value *= 0xC4CEB9FE1A85EC53ULL;
+      value ^= value >> 33;
+      return value;
+    }
+  };
+
+  // Fingerprints of the structure of prediction and semantic contexts, i.e. of what their == operators compare.
+  // The hash codes of the contexts can't be used for that, because they are only size_t values (32 bit on some
+  // targets) and so collide far too often. Contexts are graphs which share their parents, hence the fingerprint of
+  // each context node is computed only once per configuration set.
+  class ContextFingerprints {
+  public:
+    std::pair<uint64_t, uint64_t> get(PredictionContext const* context) {
+      if (context == nullptr) {
+        return { 0, 0 };
+      }
+
+      auto iterator = _contexts.find(context);
+      if (iterator != _contexts.end()) {
+        return iterator->second;
+      }
+
+      FingerprintBuilder builder;
+      builder.add(context->size());
+      for (size_t i = 0; i < context->size(); ++i) {
+        builder.add(context->getReturnState(i));
+        builder.add(get(context->getParent(i).get()));
+      }
+
+      std::pair<uint64_t, uint64_t> result = builder.finish();
+      _contexts[context] = result;
+      return result;
+    }
+
+    std::pair<uint64_t, uint64_t> get(SemanticContext const* context) {
+      FingerprintBuilder builder;
+      if (auto predicate = dynamic_cast<SemanticContext::Predicate const*>(context)) {
+        builder.add(1);
+        builder.add(predicate->ruleIndex);
+        builder.add(predicate->predIndex);
+        builder.add(predicate->isCtxDependent ? 1 : 0);
+      } else if (auto predicate = dynamic_cast<SemanticContext::PrecedencePredicate const*>(context)) {
+        builder.add(2);
+        builder.add(static_cast<uint64_t>(predicate->precedence));
+      } else if (auto andContext = dynamic_cast<SemanticContext::AND const*>(context)) {
+        builder.add(3);
+        addOperands(builder, andContext->opnds);
+      } else if (auto orContext = dynamic_cast<SemanticContext::OR const*>(context)) {
+        builder.add(4);
+        addOperands(builder, orContext->opnds);
+      }
+      return builder.finish();
+    }
+
+  private:
+    std::unordered_map<PredictionContext const*, std::pair<uint64_t, uint64_t>> _contexts;
+
+    void addOperands(FingerprintBuilder &builder, std::vector<RefPtr<SemanticContext>> const& operands) {
+      builder.add(operands.size());
+      for (auto &operand : operands) {
+        builder.add(get(operand.get()));
+      }
+    }
+  };
+
+}
+
+DFAState::PredPrediction::PredPrediction(const RefPtr<SemanticContext> &pred, int alt) : pred(pred) {
   InitializeInstanceFields();
   this->alt = alt;
 }
@@ -37,7 +140,11 @@ DFAState::DFAState(int state) : DFAState() {
   stateNumber = state;
 }
 
-DFAState::DFAState(std::unique_ptr<ATNConfigSet> configs_) : DFAState() {
+DFAState::DFAState(std::unique_ptr<ATNConfigSet> configs_) : DFAState(std::move(configs_), 0) {
+}
+
+DFAState::DFAState(std::unique_ptr<ATNConfigSet> configs_, size_t denseEdgeCount) : edges(denseEdgeCount) {
+  InitializeInstanceFields();
   configs = std::move(configs_);
 }
 
@@ -58,6 +165,10 @@ std::set<size_t> DFAState::getAltSet() {
 }
 
 size_t DFAState::hashCode() const {
+  if (_hasFingerprint) {
+    return static_cast<size_t>(_fingerprint[0]);
+  }
+
   size_t hash = misc::MurmurHash::initialize(7);
   hash = misc::MurmurHash::update(hash, configs->hashCode());
   hash = misc::MurmurHash::finish(hash, 1);
@@ -70,9 +181,52 @@ bool DFAState::operator == (const DFAState &o) const {
     return true;
   }
 
+  if (_hasFingerprint && o._hasFingerprint) {
+    return _fingerprint[0] == o._fingerprint[0] && _fingerprint[1] == o._fingerprint[1];
+  }
+
   return *configs == *o.configs;
 }
 
+void DFAState::computeFingerprint() {
+  // Covers everything ATNConfigSet::operator == compares, down to the return states of the contexts and the indices
+  // of the predicates.
+  ContextFingerprints contexts;
+  FingerprintBuilder builder;
+  builder.add(configs->size());
+  builder.add((configs->fullCtx ? 1 : 0) | (configs->hasSemanticContext ? 2 : 0) | (configs->dipsIntoOuterContext ? 4 : 0));
+  builder.add(configs->uniqueAlt);
+  for (size_t alt = configs->conflictingAlts.nextSetBit(0); alt != INVALID_INDEX;
+       alt = configs->conflictingAlts.nextSetBit(alt + 1)) {
+    builder.add(alt);
+  }
+  builder.add(configs->conflictingAlts.count());
+
+  for (auto &config : configs->configs) {
+    builder.add(config->state->stateNumber);
+    builder.add(config->alt);
+    builder.add(contexts.get(config->context.get()));
+    builder.add(contexts.get(config->semanticContext.get()));
+    builder.add(config->isPrecedenceFilterSuppressed() ? 1 : 0);
+  }
+
+  setFingerprint(builder.finish());
+}
+
+bool DFAState::hasFingerprint() const {
+  return _hasFingerprint;
+}
+
+std::pair<uint64_t, uint64_t> DFAState::getFingerprint() const {
+  return { _fingerprint[0], _fingerprint[1] };
+}
+
+void DFAState::setFingerprint(std::pair<uint64_t, uint64_t> const& fingerprint) {
+  _fingerprint[0] = fingerprint.first;
+  _fingerprint[1] = fingerprint.second;
+  _hasFingerprint = true;
+}
+
 std::string DFAState::toString() {
   std::stringstream ss;
   ss << stateNumber;
@@ -94,6 +248,9 @@ std::string DFAState::toString() {
 
 void DFAState::InitializeInstanceFields() {
   stateNumber = -1;
+  _hasFingerprint = false;
+  _fingerprint[0] = 0;
+  _fingerprint[1] = 0;
   isAcceptState = false;
   prediction = 0;
   requiresFullContext = false;
@@ -5,7 +5,7 @@
 
 #pragma once
 
-#include "antlr4-common.h"
+#include "dfa/DFAEdgeMap.h"
 
 namespace antlr4 {
 namespace dfa {
@@ -39,10 +39,10 @@ namespace dfa {
   public:
     class PredPrediction {
     public:
-      Ref<atn::SemanticContext> pred; // never null; at least SemanticContext.NONE
+      RefPtr<atn::SemanticContext> pred; // never null; at least SemanticContext.NONE
       int alt;
 
-      PredPrediction(const Ref<atn::SemanticContext> &pred, int alt);
+      PredPrediction(const RefPtr<atn::SemanticContext> &pred, int alt);
       virtual ~PredPrediction();
 
       virtual std::string toString();
@@ -53,13 +53,16 @@ namespace dfa {
 
     int stateNumber;
 
+    /// The configurations of this state. Null for states of compact DFAs which no longer need them
+    /// (see DFA::setCompactStates()).
     std::unique_ptr<atn::ATNConfigSet> configs;
 
     /// {@code edges[symbol]} points to target of symbol. Shift up by 1 so (-1)
     ///  <seealso cref="Token#EOF"/> maps to {@code edges[0]}.
     // ml: this is a sparse list, so we use a map instead of a vector.
     //     Watch out: we no longer have the -1 offset, as it isn't needed anymore.
-    std::unordered_map<size_t, DFAState *> edges;
+    //     Edges can be read without locking, but only be added while holding the owning DFA's lock.
+    DFAEdgeMap edges;
 
     bool isAcceptState;
 
@@ -97,6 +100,9 @@ namespace dfa {
     DFAState();
     DFAState(int state);
     DFAState(std::unique_ptr<atn::ATNConfigSet> configs);
+
+    /// Creates a state whose edges for the symbols 0..denseEdgeCount-1 are stored in a flat array (see DFAEdgeMap).
+    DFAState(std::unique_ptr<atn::ATNConfigSet> configs, size_t denseEdgeCount);
     virtual ~DFAState();
 
     /// <summary>
@@ -107,8 +113,18 @@ namespace dfa {
 
     virtual size_t hashCode() const;
 
+    /// Computes a 128 bit fingerprint of the configurations, which then replaces them for hashing and comparison.
+    /// This allows releasing the configurations later on (as done for states of compact DFAs).
+    void computeFingerprint();
+    bool hasFingerprint() const;
+
+    /// Direct access to the fingerprint, for restoring states whose configurations were released (see DFASnapshot).
+    std::pair<uint64_t, uint64_t> getFingerprint() const;
+    void setFingerprint(std::pair<uint64_t, uint64_t> const& fingerprint);
+
     /// Two DFAState instances are equal if their ATN configuration sets
-    /// are the same. This method is used to see if a state already exists.
+    /// are the same (or, if both states have one, their fingerprints are). This method is used to see if a state
+    /// already exists.
     ///
     /// Because the number of alternatives and number of ATN configurations are
     /// finite, there is a finite number of DFA states that can be processed.
@@ -137,6 +153,9 @@ namespace dfa {
     };
 
   private:
+    bool _hasFingerprint;
+    uint64_t _fingerprint[2];
+
     void InitializeInstanceFields();
   };
 
@@ -0,0 +1,361 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include "Exceptions.h"
+#include "ANTLRInputStream.h"
+#include "Lexer.h"
+#include "Token.h"
+#include "atn/ATN.h"
+#include "atn/ATNType.h"
+#include "atn/ATNConfigSet.h"
+#include "atn/ActionTransition.h"
+#include "atn/LexerAction.h"
+#include "atn/LexerActionExecutor.h"
+#include "atn/LexerATNSimulator.h"
+#include "atn/PredictionContextCache.h"
+#include "atn/TokensStartState.h"
+#include "atn/Transition.h"
+#include "dfa/DFA.h"
+#include "dfa/DFAState.h"
+#include "dfa/DFASnapshot.h"
+
+#include "dfa/LexerDFATable.h"
+
+using namespace antlr4;
+using namespace antlr4::atn;
+using namespace antlr4::dfa;
+using namespace antlrcpp;
+
+const uint32_t LexerDFATable::VERSION;
+const size_t LexerDFATable::ERROR_STATE;
+
+namespace {
+
+  const uint32_t MAGIC = 0x4146444C; // "LDFA"
+  const uint32_t NO_PREDICTION = 0xFFFFFFFF;
+  const size_t MAX_TABLE_SIZE = 0xFFFF;
+
+  void fail(const std::string &message) {
+    throw IllegalArgumentException("Invalid lexer DFA table: " + message);
+  }
+
+  // Drives the lexer simulator to compute DFA states, without a recognizer or input (neither is needed without
+  // predicates and custom actions).
+  class TableBuilder : public LexerATNSimulator {
+  public:
+    TableBuilder(const ATN &atn, std::vector<DFA> &decisionToDFA, PredictionContextCache &sharedContextCache)
+      : LexerATNSimulator(atn, decisionToDFA, sharedContextCache) {
+    }
+
+    DFAState* getStartState(size_t mode) {
+      _mode = mode;
+      std::unique_ptr<ATNConfigSet> configs = computeStartState(&_input, atn.modeToStartState[mode]);
+      return addDFAState(configs.release());
+    }
+
+    // Returns the target state of s on t, or ATNSimulator::ERROR.
+    DFAState* getTargetState(size_t mode, DFAState *s, size_t t) {
+      _mode = mode;
+      return computeTargetState(&_input, s, t);
+    }
+
+  private:
+    ANTLRInputStream _input;
+  };
+
+  class Reader {
+  public:
+    Reader(const uint32_t *data, size_t size) : _data(data), _size(size), _offset(0) {
+    }
+
+    uint32_t read() {
+      if (_offset == _size) {
+        fail("unexpected end of data");
+      }
+      return _data[_offset++];
+    }
+
+    // Reads a value which must be below limit.
+    size_t read(size_t limit) {
+      size_t result = read();
+      if (result >= limit) {
+        fail("value out of range");
+      }
+      return result;
+    }
+
+    bool atEnd() const {
+      return _offset == _size;
+    }
+
+  private:
+    const uint32_t *_data;
+    const size_t _size;
+    size_t _offset;
+  };
+
+}
+
+LexerDFATable::LexerDFATable(const atn::ATN &atn) : _atn(atn) {
+  if (!isSupported(atn)) {
+    throw IllegalArgumentException("Only lexers without predicates and custom actions can be compiled into a table.");
+  }
+  initClasses();
+  build();
+}
+
+LexerDFATable::LexerDFATable(const atn::ATN &atn, const uint32_t *data, size_t size) : _atn(atn) {
+  initClasses();
+
+  Reader reader(data, size);
+  if (reader.read() != MAGIC || reader.read() != VERSION) {
+    fail("not a lexer DFA table or an unsupported version");
+  }
+  uint64_t checksum = reader.read();
+  checksum |= static_cast<uint64_t>(reader.read()) << 32;
+  if (checksum != DFASnapshot::getChecksum(atn)) {
+    fail("created for a different ATN");
+  }
+
+  // The classes follow from the ATN, the count is only a consistency check.
+  if (reader.read() != getClassCount()) {
+    fail("created for a different ATN");
+  }
+  size_t stateCount = reader.read(MAX_TABLE_SIZE);
+
+  size_t modeCount = reader.read(size + 1);
+  if (modeCount != atn.modeToStartState.size()) {
+    fail("created for a different ATN");
+  }
+  for (size_t i = 0; i < modeCount; ++i) {
+    _modeStarts.push_back(reader.read(stateCount + 1));
+  }
+
+  _predictions.resize(stateCount + 1, INVALID_INDEX);
+  _executors.resize(stateCount + 1);
+  for (size_t state = 1; state <= stateCount; ++state) {
+    uint32_t prediction = reader.read();
+    _predictions[state] = prediction == NO_PREDICTION ? INVALID_INDEX : prediction;
+
+    size_t actionCount = reader.read(atn.lexerActions.size() + 1);
+    if (actionCount > 0) {
+      std::vector<Ref<LexerAction>> actions;
+      for (size_t i = 0; i < actionCount; ++i) {
+        actions.push_back(atn.lexerActions[reader.read(atn.lexerActions.size())]);
+      }
+      _executors[state] = std::make_shared<LexerActionExecutor>(actions);
+    }
+  }
+
+  if ((size - 1) / _columns < stateCount) {
+    fail("unexpected end of data");
+  }
+  _next.resize((stateCount + 1) * _columns, ERROR_STATE);
+  for (size_t i = _columns; i < _next.size(); ++i) {
+    _next[i] = static_cast<uint16_t>(reader.read(stateCount + 1));
+  }
+
+  if (!reader.atEnd()) {
+    fail("unexpected data after the table");
+  }
+}
+
+bool LexerDFATable::isSupported(const atn::ATN &atn) {
+  if (atn.grammarType != ATNType::LEXER) {
+    return false;
+  }
+
+  for (ATNState *state : atn.states) {
+    if (state == nullptr) {
+      continue;
+    }
+    for (Transition *transition : state->transitions) {
+      switch (transition->getSerializationType()) {
+        case Transition::PREDICATE:
+        case Transition::PRECEDENCE:
+          return false;
+
+        case Transition::ACTION: {
+          size_t actionIndex = static_cast<ActionTransition *>(transition)->actionIndex;
+          if (actionIndex >= atn.lexerActions.size() || atn.lexerActions[actionIndex]->isPositionDependent()) {
+            return false;
+          }
+          break;
+        }
+
+        default:
+          break;
+      }
+    }
+  }
+  return true;
+}
+
+const atn::ATN& LexerDFATable::getATN() const {
+  return _atn;
+}
+
+size_t LexerDFATable::getStateCount() const {
+  return _predictions.size() - 1;
+}
+
+size_t LexerDFATable::getClassCount() const {
+  return _classes->getCharClassCount();
+}
+
+std::vector<uint32_t> LexerDFATable::serialize() const {
+  std::vector<uint32_t> result;
+  uint64_t checksum = DFASnapshot::getChecksum(_atn);
+  result.push_back(MAGIC);
+  result.push_back(VERSION);
+  result.push_back(static_cast<uint32_t>(checksum));
+  result.push_back(static_cast<uint32_t>(checksum >> 32));
+  result.push_back(static_cast<uint32_t>(getClassCount()));
+  result.push_back(static_cast<uint32_t>(getStateCount()));
+
+  result.push_back(static_cast<uint32_t>(_modeStarts.size()));
+  for (size_t start : _modeStarts) {
+    result.push_back(static_cast<uint32_t>(start));
+  }
+
+  for (size_t state = 1; state < _predictions.size(); ++state) {
+    result.push_back(isAcceptState(state) ? static_cast<uint32_t>(_predictions[state]) : NO_PREDICTION);
+    if (_executors[state] == nullptr) {
+      result.push_back(0);
+      continue;
+    }
+
+    const std::vector<Ref<LexerAction>> &actions = _executors[state]->getLexerActions();
+    result.push_back(static_cast<uint32_t>(actions.size()));
+    for (auto &action : actions) {
+      size_t index = 0;
+      while (index < _atn.lexerActions.size() && _atn.lexerActions[index] != action &&
+             *_atn.lexerActions[index] != *action) {
+        ++index;
+      }
+      if (index == _atn.lexerActions.size()) {
+        throw IllegalStateException("Lexer action not found in the ATN.");
+      }
+      result.push_back(static_cast<uint32_t>(index));
+    }
+  }
+
+  result.insert(result.end(), _next.begin() + _columns, _next.end());
+  return result;
+}
+
+std::string LexerDFATable::generateSource(const std::string &name) const {
+  std::vector<uint32_t> data = serialize();
+
+  std::string result = "// Lexer DFA table, generated by antlr4::dfa::LexerDFATable. Use it with\n"
+    "// antlr4::atn::LexerATNSimulator::setTable().\n\n"
+    "#include <stddef.h>\n"
+    "#include <stdint.h>\n";
+
+  result += "\nextern const uint32_t " + name + "[] = {";
+  for (size_t i = 0; i < data.size(); ++i) {
+    result += i % 12 == 0 ? "\n  " : " ";
+    result += std::to_string(data[i]) + ",";
+  }
+  result += "\n};\n";
+  result += "extern const size_t " + name + "Size = sizeof(" + name + ") / sizeof(" + name + "[0]);\n";
+  return result;
+}
+
+size_t LexerDFATable::getStartState(size_t mode) const {
+  return _modeStarts[mode];
+}
+
+void LexerDFATable::initClasses() {
+  // Lexer ATNs get their classes when deserialized, other ones (e.g. created in code) need their own.
+  _classes = _atn.charClasses;
+  if (_classes == nullptr) {
+    _classes = std::make_shared<LexerCharClasses>(_atn);
+  }
+  _columns = _classes->getCharClassCount() + 2;
+}
+
+void LexerDFATable::build() {
+  size_t classCount = getClassCount();
+
+  std::vector<DFA> decisionToDFA;
+  for (size_t mode = 0; mode < _atn.modeToStartState.size(); ++mode) {
+    decisionToDFA.emplace_back(_atn.modeToStartState[mode], mode);
+  }
+  PredictionContextCache sharedContextCache(0);
+  TableBuilder builder(_atn, decisionToDFA, sharedContextCache);
+
+  // States are numbered in the order they are found, each one is expanded once.
+  std::vector<DFAState *> states = { nullptr };
+  std::vector<size_t> stateModes = { 0 };
+  std::unordered_map<DFAState *, size_t> numbers;
+  auto getNumber = [&](DFAState *state, size_t mode) -> size_t {
+    if (state == ATNSimulator::ERROR.get()) {
+      return ERROR_STATE;
+    }
+    auto iterator = numbers.find(state);
+    if (iterator != numbers.end()) {
+      return iterator->second;
+    }
+    if (states.size() >= MAX_TABLE_SIZE) {
+      throw IllegalStateException("Too many states for a lexer DFA table.");
+    }
+    numbers[state] = states.size();
+    states.push_back(state);
+    stateModes.push_back(mode);
+    return states.size() - 1;
+  };
+
+  for (size_t mode = 0; mode < _atn.modeToStartState.size(); ++mode) {
+    _modeStarts.push_back(getNumber(builder.getStartState(mode), mode));
+  }
+
+  _next.resize(_columns, ERROR_STATE);
+  for (size_t i = 1; i < states.size(); ++i) {
+    DFAState *state = states[i];
+    size_t mode = stateModes[i];
+    size_t row = _next.size();
+    _next.resize(row + _columns, ERROR_STATE);
+
+    // The target only depends on which transitions of the state match, so it's computed once per combination.
+    std::vector<std::pair<size_t, size_t>> transitions; // State number and transition index.
+    for (auto &config : state->configs->configs) {
+      for (size_t j = 0; j < config->state->transitions.size(); ++j) {
+        if (!config->state->transitions[j]->isEpsilon()) {
+          transitions.push_back({ config->state->stateNumber, j });
+        }
+      }
+    }
+
+    std::map<std::vector<bool>, size_t> targets;
+    for (size_t c = 0; c < classCount; ++c) {
+      std::vector<bool> matches(transitions.size());
+      bool any = false;
+      for (size_t j = 0; j < transitions.size(); ++j) {
+        matches[j] = _classes->matches(transitions[j].first, transitions[j].second, c);
+        any = any || matches[j];
+      }
+      if (!any) {
+        continue;
+      }
+
+      auto iterator = targets.find(matches);
+      if (iterator == targets.end()) {
+        iterator = targets.insert({ matches, getNumber(builder.getTargetState(mode, state, _classes->getRepresentative(c)), mode) }).first;
+      }
+      _next[row + c] = static_cast<uint16_t>(iterator->second);
+    }
+    _next[row + _classes->getEOFClass()] = static_cast<uint16_t>(getNumber(builder.getTargetState(mode, state, Token::EOF), mode));
+  }
+
+  _predictions.resize(states.size(), INVALID_INDEX);
+  _executors.resize(states.size());
+  for (size_t i = 1; i < states.size(); ++i) {
+    if (states[i]->isAcceptState) {
+      _predictions[i] = states[i]->prediction;
+      _executors[i] = states[i]->lexerActionExecutor;
+    }
+  }
+}
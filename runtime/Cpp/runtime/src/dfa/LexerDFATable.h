@@ -0,0 +1,102 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include "atn/LexerCharClasses.h"
+
+namespace antlr4 {
+namespace dfa {
+
+  /// The complete DFA of a lexer, for all of its modes, as a flat transition table. A lexer simulator with a table
+  /// (see LexerATNSimulator::setTable()) matches tokens with one table lookup per character, without ever going
+  /// through ATN simulation or the DFA cache.
+  ///
+  /// The table has one column per character class of the ATN (see atn::LexerCharClasses) instead of one per
+  /// character, including the classes for EOF and characters outside of the Unicode range.
+  ///
+  /// Only lexers without semantic predicates and custom actions can be compiled into a table, as those depend on
+  /// the recognizer state at match time. Lexer commands (skip, more, type, channel, mode, pushMode, popMode) are fine.
+  ///
+  /// Building the table expands the whole DFA, which can take a while for big lexers. To do that at build time,
+  /// write the table with generateSource() and create it from the generated array at runtime:
+  ///
+  ///   // Build step:
+  ///   std::ofstream("TLexerTable.cpp") << LexerDFATable(lexer.getATN()).generateSource("TLexerTable");
+  ///
+  ///   // Application:
+  ///   extern const uint32_t TLexerTable[];
+  ///   extern const size_t TLexerTableSize;
+  ///   static LexerDFATable table(lexer.getATN(), TLexerTable, TLexerTableSize);
+  ///   lexer.getInterpreter<atn::LexerATNSimulator>()->setTable(&table);
+  class ANTLR4CPP_PUBLIC LexerDFATable {
+  public:
+    static const uint32_t VERSION = 2;
+
+    /// The state number used for "no transition". Valid states are numbered from 1.
+    static const size_t ERROR_STATE = 0;
+
+    /// Builds the table for the given lexer ATN.
+    /// @throws IllegalArgumentException if the ATN is not a lexer ATN or uses predicates or custom actions.
+    /// @throws IllegalStateException if the DFA is too big for a table (more than 65534 states).
+    LexerDFATable(const atn::ATN &atn);
+
+    /// Restores a table from the output of serialize(), e.g. an array written by generateSource().
+    /// @throws IllegalArgumentException if the data was not created for the given ATN or is damaged.
+    LexerDFATable(const atn::ATN &atn, const uint32_t *data, size_t size);
+
+    LexerDFATable(const LexerDFATable &other) = delete;
+    LexerDFATable& operator = (const LexerDFATable &other) = delete;
+
+    /// Returns true if the ATN is a lexer ATN without predicates and custom actions.
+    static bool isSupported(const atn::ATN &atn);
+
+    const atn::ATN& getATN() const;
+    size_t getStateCount() const;
+    size_t getClassCount() const;
+
+    std::vector<uint32_t> serialize() const;
+
+    /// Generates a C++ source file defining the serialized table as {@code extern const uint32_t <name>[]}, with its
+    /// size in {@code extern const size_t <name>Size}.
+    std::string generateSource(const std::string &name) const;
+
+    size_t getStartState(size_t mode) const;
+
+    /// Returns the state reached from the given one on the symbol (a character or EOF), or ERROR_STATE.
+    size_t getTarget(size_t state, size_t symbol) const {
+      return _next[state * _columns + _classes->getClass(symbol)];
+    }
+
+    bool isAcceptState(size_t state) const {
+      return _predictions[state] != INVALID_INDEX;
+    }
+
+    /// The token type matched in an accept state.
+    size_t getPrediction(size_t state) const {
+      return _predictions[state];
+    }
+
+    /// The lexer commands to execute in an accept state (can be null).
+    Ref<atn::LexerActionExecutor> const& getLexerActionExecutor(size_t state) const {
+      return _executors[state];
+    }
+
+  private:
+    const atn::ATN &_atn;
+    Ref<atn::LexerCharClasses> _classes;
+    size_t _columns; // Classes, EOF and characters outside of the Unicode range.
+
+    std::vector<size_t> _modeStarts;
+    std::vector<uint16_t> _next; // One row per state (including ERROR_STATE), one column per class.
+    std::vector<size_t> _predictions;
+    std::vector<Ref<atn::LexerActionExecutor>> _executors;
+
+    void initClasses();
+    void build();
+  };
+
+} // namespace dfa
+} // namespace antlr4
@@ -41,6 +41,11 @@ namespace misc {
       return update(hash, value != nullptr ? value->hashCode() : 0);
     }
 
+    template <class T>
+    static size_t update(size_t hash, RefPtr<T> const& value) {
+      return update(hash, value != nullptr ? value->hashCode() : 0);
+    }
+
     template <class T>
     static size_t update(size_t hash, T *value) {
       return update(hash, value != nullptr ? value->hashCode() : 0);
@@ -70,6 +75,16 @@ namespace misc {
 
       return finish(hash, data.size());
     }
+
+    template<typename T>
+    static size_t hashCode(const std::vector<RefPtr<T>> &data, size_t seed) {
+      size_t hash = initialize(seed);
+      for (auto &entry : data) {
+        hash = update(hash, entry->hashCode());
+      }
+
+      return finish(hash, data.size());
+    }
   };
 
 } // namespace atn
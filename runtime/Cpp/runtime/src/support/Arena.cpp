@@ -0,0 +1,94 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include <cstddef>
+
+#include "support/Arena.h"
+
+using namespace antlrcpp;
+
+static const size_t INITIAL_CHUNK_SIZE = 64 * 1024;
+static const size_t MAX_CHUNK_SIZE = 4 * 1024 * 1024;
+static const size_t ALIGNMENT = alignof(std::max_align_t);
+
+Arena* Arena::create() {
+  return new Arena();
+}
+
+Arena::Arena() : _references(1), _chunkIndex(0), _current(nullptr), _end(nullptr) {
+}
+
+Arena::~Arena() {
+  for (auto &chunk : _chunks) {
+    delete [] chunk.data;
+  }
+}
+
+void* Arena::allocate(size_t size) {
+  size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+  _references.fetch_add(1, std::memory_order_relaxed);
+
+  if (size <= (size_t)(_end - _current)) {
+    void *result = _current;
+    _current += size;
+    return result;
+  }
+  return allocateFromNextChunk(size);
+}
+
+void Arena::deallocate(void * /*p*/) {
+  // Memory is only reclaimed as a whole (see rewind()).
+  release();
+}
+
+bool Arena::owns(const void *p) const {
+  std::less_equal<const void *> lessEqual;
+  for (auto &chunk : _chunks) {
+    if (lessEqual(chunk.data, p) && !lessEqual(chunk.data + chunk.size, p)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Arena::isUnused() const {
+  return _references.load(std::memory_order_acquire) == 1;
+}
+
+void Arena::rewind() {
+  _chunkIndex = 0;
+  if (_chunks.empty()) {
+    _current = nullptr;
+    _end = nullptr;
+  } else {
+    _current = _chunks[0].data;
+    _end = _current + _chunks[0].size;
+  }
+}
+
+void Arena::release() {
+  if (_references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    delete this;
+  }
+}
+
+void* Arena::allocateFromNextChunk(size_t size) {
+  // Chunks left over from before the last rewind are reused, as long as they are large enough.
+  size_t index = _current == nullptr ? 0 : _chunkIndex + 1;
+  while (index < _chunks.size() && _chunks[index].size < size) {
+    ++index;
+  }
+
+  if (index == _chunks.size()) {
+    size_t chunkSize = _chunks.empty() ? INITIAL_CHUNK_SIZE : std::min(_chunks.back().size * 2, MAX_CHUNK_SIZE);
+    chunkSize = std::max(chunkSize, size);
+    _chunks.push_back({ new char[chunkSize], chunkSize });
+  }
+
+  _chunkIndex = index;
+  _current = _chunks[index].data + size;
+  _end = _chunks[index].data + _chunks[index].size;
+  return _chunks[index].data;
+}
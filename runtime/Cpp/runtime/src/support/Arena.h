@@ -0,0 +1,94 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include "antlr4-common.h"
+
+namespace antlrcpp {
+
+  /// A bump allocator for short lived objects (e.g. the configs and contexts created during a single prediction).
+  ///
+  /// Memory is taken from a list of chunks by simply advancing a pointer, releasing an object does nothing but
+  /// decrease the number of live allocations. Once that number drops to zero the arena can be rewound, which makes
+  /// all chunks available again without returning them to the system.
+  ///
+  /// The arena is reference counted by its owner and all live allocations. Hence objects which escape the owner
+  /// (e.g. because they are stored somewhere else) are always safe to use: the owner releases the arena instead of
+  /// rewinding it and the last object to go away frees it.
+  class ANTLR4CPP_PUBLIC Arena {
+  public:
+    /// Creates a new arena with one reference held by the caller (see release()).
+    static Arena* create();
+
+    void* allocate(size_t size);
+    void deallocate(void *p);
+
+    /// Returns true if the given address lies in memory handed out by this arena.
+    bool owns(const void *p) const;
+
+    /// Returns true if the owner holds the only reference, that is, no allocation is alive anymore.
+    bool isUnused() const;
+
+    /// Makes all memory available again. Must only be called if the arena is unused.
+    void rewind();
+
+    /// Drops the owner's reference. The arena is freed once the last allocation has been released.
+    void release();
+
+  private:
+    struct Chunk {
+      char *data;
+      size_t size;
+    };
+
+    std::atomic<size_t> _references;
+    std::vector<Chunk> _chunks;
+    size_t _chunkIndex;
+    char *_current;
+    char *_end;
+
+    Arena();
+    ~Arena();
+
+    void* allocateFromNextChunk(size_t size);
+  };
+
+  /// A standard conforming allocator which takes its memory from an Arena, e.g. for use with std::allocate_shared.
+  template <typename T>
+  class ArenaAllocator {
+  public:
+    using value_type = T;
+
+    ArenaAllocator(Arena *arena) : _arena(arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : _arena(other._arena) {}
+
+    T* allocate(size_t n) {
+      return static_cast<T *>(_arena->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T *p, size_t) {
+      _arena->deallocate(p);
+    }
+
+    template <typename U>
+    bool operator == (const ArenaAllocator<U> &other) const {
+      return _arena == other._arena;
+    }
+
+    template <typename U>
+    bool operator != (const ArenaAllocator<U> &other) const {
+      return _arena != other._arena;
+    }
+
+  private:
+    template <typename U> friend class ArenaAllocator;
+
+    Arena *_arena;
+  };
+
+} // namespace antlrcpp
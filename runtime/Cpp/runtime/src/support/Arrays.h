@@ -61,6 +61,26 @@ namespace antlrcpp {
       return true;
     }
 
+    template <typename T>
+    static bool equals(const std::vector<RefPtr<T>> &a, const std::vector<RefPtr<T>> &b) {
+      if (a.size() != b.size())
+        return false;
+
+      for (size_t i = 0; i < a.size(); ++i) {
+        if (!a[i] && !b[i])
+          continue;
+        if (!a[i] || !b[i])
+          return false;
+        if (a[i] == b[i])
+          continue;
+
+        if (!(*a[i] == *b[i]))
+          return false;
+      }
+
+      return true;
+    }
+
     template <typename T>
     static std::string toString(const std::vector<T> &source) {
       std::string result = "[";
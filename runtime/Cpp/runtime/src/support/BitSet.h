@@ -7,33 +7,148 @@
 
 #include "antlr4-common.h"
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 namespace antlrcpp {
 
-  class ANTLR4CPP_PUBLIC BitSet : public std::bitset<1024> {
+  /// A growable set of bits, used mostly for sets of alternatives during prediction.
+  ///
+  /// Decisions rarely have more than 64 alternatives, so the first 64 bits are stored inline and only larger
+  /// indices spill into a heap allocated vector. Copying a set with small values therefore never allocates.
+  class ANTLR4CPP_PUBLIC BitSet {
   public:
+    BitSet() : _word(0) {}
+
+    bool test(size_t pos) const {
+      if (pos < BITS_PER_WORD) {
+        return (_word & bit(pos)) != 0;
+      }
+      size_t index = pos / BITS_PER_WORD - 1;
+      return index < _spill.size() && (_spill[index] & bit(pos % BITS_PER_WORD)) != 0;
+    }
+
+    bool operator [] (size_t pos) const {
+      return test(pos);
+    }
+
+    BitSet& set(size_t pos, bool value = true) {
+      uint64_t *word = &_word;
+      if (pos >= BITS_PER_WORD) {
+        size_t index = pos / BITS_PER_WORD - 1;
+        if (index >= _spill.size()) {
+          if (!value) {
+            return *this; // Not stored, hence not set.
+          }
+          _spill.resize(index + 1, 0);
+        }
+        word = &_spill[index];
+      }
+
+      if (value) {
+        *word |= bit(pos % BITS_PER_WORD);
+      } else {
+        *word &= ~bit(pos % BITS_PER_WORD);
+      }
+      return *this;
+    }
+
+    BitSet& reset(size_t pos) {
+      return set(pos, false);
+    }
+
+    BitSet& reset() {
+      _word = 0;
+      _spill.clear();
+      return *this;
+    }
+
+    /// The number of bits which can be stored without growing the set.
+    size_t size() const {
+      return (_spill.size() + 1) * BITS_PER_WORD;
+    }
+
+    size_t count() const {
+      size_t result = popCount(_word);
+      for (uint64_t word : _spill) {
+        result += popCount(word);
+      }
+      return result;
+    }
+
+    bool any() const {
+      if (_word != 0) {
+        return true;
+      }
+      for (uint64_t word : _spill) {
+        if (word != 0) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    bool none() const {
+      return !any();
+    }
+
     size_t nextSetBit(size_t pos) const {
-      for (size_t i = pos; i < size(); i++){
-        if (test(i)) {
-          return i;
+      for (size_t index = pos / BITS_PER_WORD; index <= _spill.size(); ++index) {
+        uint64_t word = index == 0 ? _word : _spill[index - 1];
+        if (index == pos / BITS_PER_WORD) {
+          word &= ~(bit(pos % BITS_PER_WORD) - 1); // Mask out the bits before pos.
+        }
+        if (word != 0) {
+          return index * BITS_PER_WORD + countTrailingZeros(word);
         }
       }
 
       return INVALID_INDEX;
     }
 
+    BitSet& operator |= (const BitSet &other) {
+      _word |= other._word;
+      if (_spill.size() < other._spill.size()) {
+        _spill.resize(other._spill.size(), 0);
+      }
+      for (size_t i = 0; i < other._spill.size(); ++i) {
+        _spill[i] |= other._spill[i];
+      }
+      return *this;
+    }
+
+    bool operator == (const BitSet &other) const {
+      if (_word != other._word) {
+        return false;
+      }
+
+      // Missing words are zero, so sets which spilled and cleared those bits again compare equal.
+      for (size_t i = 0; i < std::max(_spill.size(), other._spill.size()); ++i) {
+        uint64_t lhs = i < _spill.size() ? _spill[i] : 0;
+        uint64_t rhs = i < other._spill.size() ? other._spill[i] : 0;
+        if (lhs != rhs) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    bool operator != (const BitSet &other) const {
+      return !(*this == other);
+    }
+
     // Prints a list of every index for which the bitset contains a bit in true.
     friend std::wostream& operator << (std::wostream& os, const BitSet& obj)
     {
       os << "{";
-      size_t total = obj.count();
-      for (size_t i = 0; i < obj.size(); i++){
-        if (obj.test(i)){
-          os << i;
-          --total;
-          if (total > 1){
-            os << ", ";
-          }
+      bool valueAdded = false;
+      for (size_t i = obj.nextSetBit(0); i != INVALID_INDEX; i = obj.nextSetBit(i + 1)) {
+        if (valueAdded) {
+          os << ", ";
         }
+        os << i;
+        valueAdded = true;
       }
 
       os << "}";
@@ -54,23 +169,58 @@ namespace antlrcpp {
       return result;
     }
 
-    std::string toString(){
+    std::string toString() const {
       std::stringstream stream;
       stream << "{";
       bool valueAdded = false;
-      for (size_t i = 0; i < size(); ++i){
-        if (test(i)){
-          if (valueAdded) {
-            stream << ", ";
-          }
-          stream << i;
-          valueAdded = true;
+      for (size_t i = nextSetBit(0); i != INVALID_INDEX; i = nextSetBit(i + 1)) {
+        if (valueAdded) {
+          stream << ", ";
         }
+        stream << i;
+        valueAdded = true;
       }
 
       stream << "}";
       return stream.str();
     }
 
+  private:
+    static const size_t BITS_PER_WORD = 64;
+
+    uint64_t _word;               // Bits 0..63.
+    std::vector<uint64_t> _spill; // Bits 64 and up, allocated only when such a bit is set.
+
+    static uint64_t bit(size_t pos) {
+      return (uint64_t)1 << pos;
+    }
+
+    static size_t countTrailingZeros(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+      return (size_t)__builtin_ctzll(word);
+#elif defined(_MSC_VER) && defined(_M_X64)
+      unsigned long index;
+      _BitScanForward64(&index, word);
+      return index;
+#else
+      size_t result = 0;
+      while ((word & 1) == 0) {
+        word >>= 1;
+        ++result;
+      }
+      return result;
+#endif
+    }
+
+    static size_t popCount(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+      return (size_t)__builtin_popcountll(word);
+#else
+      word = word - ((word >> 1) & 0x5555555555555555ULL);
+      word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+      word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+      return (size_t)((word * 0x0101010101010101ULL) >> 56);
+#endif
+    }
   };
 }
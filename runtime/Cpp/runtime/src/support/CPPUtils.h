@@ -46,6 +46,11 @@ namespace antlrcpp {
     return dynamic_cast<T1 *>(obj.get()) != nullptr;
   }
 
+  template <typename T1, typename T2>
+  inline bool is(RefPtr<T2> const& obj) { // For intrusive pointers.
+    return dynamic_cast<T1 *>(obj.get()) != nullptr;
+  }
+
   template <typename T>
   std::string toString(const T &o) {
     std::stringstream ss;
@@ -84,6 +84,7 @@ namespace antlr4 {
     class LexerActionExecutor;
     class LexerATNConfig;
     class LexerATNSimulator;
+    class LexerCharClasses;
     class LexerMoreAction;
     class LexerPopModeAction;
     class LexerSkipAction;
@@ -119,12 +120,14 @@ namespace antlr4 {
     class DFASerializer;
     class DFAState;
     class LexerDFASerializer;
+    class LexerDFATable;
     class Vocabulary;
   }
   namespace tree {
     class AbstractParseTreeVisitor;
     class ErrorNode;
     class ErrorNodeImpl;
+    class ParallelParseTreeWalker;
     class ParseTree;
     class ParseTreeListener;
     template<typename T> class ParseTreeProperty;
@@ -0,0 +1,215 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+namespace antlrcpp {
+
+  /// Base class for objects managed by IntrusivePtr. The reference count is stored in the object itself, so there is
+  /// only one allocation per object and handles are a single pointer (no separate control block as with shared_ptr).
+  ///
+  /// The count is updated atomically, which is required when ATN data (and hence the DFA and prediction context
+  /// caches) is shared between parsers running in different threads. Applications which never do that can define
+  /// ANTLR4CPP_NONATOMIC_REFCOUNT (for both the runtime and the application) to use plain integer updates instead.
+  class ANTLR4CPP_PUBLIC RefCounted {
+  public:
+    RefCounted() : _refCount(0) {}
+    RefCounted(RefCounted const&) : _refCount(0) {}
+    virtual ~RefCounted() {}
+
+    RefCounted& operator = (RefCounted const&) { return *this; }
+
+    void addRef() const {
+#ifdef ANTLR4CPP_NONATOMIC_REFCOUNT
+      ++_refCount;
+#else
+      _refCount.fetch_add(1, std::memory_order_relaxed);
+#endif
+    }
+
+    void release() const {
+#ifdef ANTLR4CPP_NONATOMIC_REFCOUNT
+      if (--_refCount == 0) {
+        destroy();
+      }
+#else
+      if (_refCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        destroy();
+      }
+#endif
+    }
+
+    size_t useCount() const {
+#ifdef ANTLR4CPP_NONATOMIC_REFCOUNT
+      return _refCount;
+#else
+      return _refCount.load(std::memory_order_relaxed);
+#endif
+    }
+
+  protected:
+    /// Called when the last reference is gone. Objects which were not allocated with new (e.g. placed in an arena)
+    /// override this to release their memory accordingly.
+    virtual void destroy() const {
+      delete this;
+    }
+
+  private:
+#ifdef ANTLR4CPP_NONATOMIC_REFCOUNT
+    mutable size_t _refCount;
+#else
+    mutable std::atomic<size_t> _refCount;
+#endif
+  };
+
+  /// A smart pointer to a RefCounted object, with the same interface as std::shared_ptr (as far as used in the
+  /// runtime). Used for the immutable graphs built during prediction (prediction and semantic contexts), which are
+  /// copied a lot.
+  template<class T>
+  class IntrusivePtr {
+  public:
+    typedef T element_type;
+
+    IntrusivePtr() NOEXCEPT : _ptr(nullptr) {}
+    IntrusivePtr(std::nullptr_t) NOEXCEPT : _ptr(nullptr) {}
+
+    /// Takes a (shared) reference to the given object.
+    explicit IntrusivePtr(T *ptr) : _ptr(ptr) {
+      if (_ptr != nullptr) {
+        _ptr->addRef();
+      }
+    }
+
+    IntrusivePtr(IntrusivePtr const& other) : _ptr(other._ptr) {
+      if (_ptr != nullptr) {
+        _ptr->addRef();
+      }
+    }
+
+    IntrusivePtr(IntrusivePtr &&other) NOEXCEPT : _ptr(other._ptr) {
+      other._ptr = nullptr;
+    }
+
+    template<class U, typename = typename std::enable_if<std::is_convertible<U *, T *>::value>::type>
+    IntrusivePtr(IntrusivePtr<U> const& other) : _ptr(other.get()) {
+      if (_ptr != nullptr) {
+        _ptr->addRef();
+      }
+    }
+
+    template<class U, typename = typename std::enable_if<std::is_convertible<U *, T *>::value>::type>
+    IntrusivePtr(IntrusivePtr<U> &&other) NOEXCEPT : _ptr(other.detach()) {
+    }
+
+    ~IntrusivePtr() {
+      if (_ptr != nullptr) {
+        _ptr->release();
+      }
+    }
+
+    IntrusivePtr& operator = (IntrusivePtr const& other) {
+      IntrusivePtr(other).swap(*this);
+      return *this;
+    }
+
+    IntrusivePtr& operator = (IntrusivePtr &&other) NOEXCEPT {
+      IntrusivePtr(std::move(other)).swap(*this);
+      return *this;
+    }
+
+    IntrusivePtr& operator = (std::nullptr_t) {
+      reset();
+      return *this;
+    }
+
+    T* get() const NOEXCEPT { return _ptr; }
+    T& operator * () const { return *_ptr; }
+    T* operator -> () const NOEXCEPT { return _ptr; }
+    explicit operator bool () const NOEXCEPT { return _ptr != nullptr; }
+
+    size_t use_count() const {
+      return _ptr != nullptr ? _ptr->useCount() : 0;
+    }
+
+    void reset() {
+      IntrusivePtr().swap(*this);
+    }
+
+    void swap(IntrusivePtr &other) NOEXCEPT {
+      std::swap(_ptr, other._ptr);
+    }
+
+    /// Gives up ownership of the object without releasing it. For internal use (moves between pointer types).
+    T* detach() NOEXCEPT {
+      T *result = _ptr;
+      _ptr = nullptr;
+      return result;
+    }
+
+  private:
+    T *_ptr;
+  };
+
+  template<class T, class U>
+  inline bool operator == (IntrusivePtr<T> const& a, IntrusivePtr<U> const& b) NOEXCEPT {
+    return a.get() == b.get();
+  }
+
+  template<class T, class U>
+  inline bool operator != (IntrusivePtr<T> const& a, IntrusivePtr<U> const& b) NOEXCEPT {
+    return a.get() != b.get();
+  }
+
+  template<class T, class U>
+  inline bool operator < (IntrusivePtr<T> const& a, IntrusivePtr<U> const& b) NOEXCEPT {
+    return std::less<const void *>()(a.get(), b.get());
+  }
+
+  template<class T>
+  inline bool operator == (IntrusivePtr<T> const& a, std::nullptr_t) NOEXCEPT {
+    return a.get() == nullptr;
+  }
+
+  template<class T>
+  inline bool operator == (std::nullptr_t, IntrusivePtr<T> const& a) NOEXCEPT {
+    return a.get() == nullptr;
+  }
+
+  template<class T>
+  inline bool operator != (IntrusivePtr<T> const& a, std::nullptr_t) NOEXCEPT {
+    return a.get() != nullptr;
+  }
+
+  template<class T>
+  inline bool operator != (std::nullptr_t, IntrusivePtr<T> const& a) NOEXCEPT {
+    return a.get() != nullptr;
+  }
+
+  /// The counterpart of std::make_shared: creates a new object with a single allocation.
+  template<class T, class... Args>
+  inline IntrusivePtr<T> makeRefPtr(Args&&... args) {
+    return IntrusivePtr<T>(new T(std::forward<Args>(args)...));
+  }
+
+  template<class T, class U>
+  inline IntrusivePtr<T> static_pointer_cast(IntrusivePtr<U> const& ptr) {
+    return IntrusivePtr<T>(static_cast<T *>(ptr.get()));
+  }
+
+  template<class T, class U>
+  inline IntrusivePtr<T> dynamic_pointer_cast(IntrusivePtr<U> const& ptr) {
+    return IntrusivePtr<T>(dynamic_cast<T *>(ptr.get()));
+  }
+
+} // namespace antlrcpp
+
+namespace std {
+  template<class T>
+  struct hash<antlrcpp::IntrusivePtr<T>> {
+    size_t operator () (antlrcpp::IntrusivePtr<T> const& ptr) const {
+      return std::hash<T *>()(ptr.get());
+    }
+  };
+}
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "antlr4-common.h"
+#include "support/UTF8.h"
 
 namespace antlrcpp {
 
@@ -17,33 +18,19 @@ namespace antlrcpp {
   typedef std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> UTF32Converter;
 #endif
   
-  // The conversion functions fails in VS2017, so we explicitly use a workaround.
+  // The std::codecvt based converter above is slow and throws on invalid input, so the conversions below use
+  // our own implementation (see UTF8.h).
   template<typename T>
   inline std::string utf32_to_utf8(T const& data)
   {
-    // Don't make the converter static or we have to serialize access to it.
-    UTF32Converter converter;
-
-    #if defined(_MSC_VER) && _MSC_VER >= 1900 && _MSC_VER < 2000
-      auto p = reinterpret_cast<const int32_t *>(data.data());
-      return converter.to_bytes(p, p + data.size());
-    #else
-      return converter.to_bytes(data);
-    #endif
+    auto p = reinterpret_cast<const UTF8::CodePoint *>(data.data());
+    return UTF8::encode(p, p + data.size());
   }
 
+  // Invalid input is replaced by U+FFFD (one per byte).
   inline UTF32String utf8_to_utf32(const char* first, const char* last)
   {
-    UTF32Converter converter;
-
-    #if defined(_MSC_VER) && _MSC_VER >= 1900 && _MSC_VER < 2000
-      auto r = converter.from_bytes(first, last);
-      i32string s = reinterpret_cast<const int32_t *>(r.data());
-    #else
-      std::u32string s = converter.from_bytes(first, last);
-    #endif
-    
-    return s;
+    return UTF8::decode(first, last);
   }
 
   void replaceAll(std::string &str, std::string const& from, std::string const& to);
@@ -0,0 +1,261 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include <string.h>
+
+#include "support/UTF8.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define ANTLR4_UTF8_SSE2
+  #include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+  #include <intrin.h>
+#endif
+
+using namespace antlrcpp;
+
+typedef UTF8::CodePoint CodePoint;
+
+const uint32_t UTF8::REPLACEMENT_CHARACTER;
+const uint32_t UTF8::INVALID;
+
+static inline size_t countTrailingZeros(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+  return (size_t)__builtin_ctz(mask);
+#elif defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return index;
+#else
+  size_t result = 0;
+  while ((mask & 1) == 0) {
+    mask >>= 1;
+    ++result;
+  }
+  return result;
+#endif
+}
+
+#ifdef ANTLR4_UTF8_SSE2
+
+static const size_t BLOCK_SIZE = 16;
+
+// Widens the ASCII bytes at the start of a block of BLOCK_SIZE bytes to code points and returns how many of them
+// were ASCII. All BLOCK_SIZE code points are written (the ones after the first non-ASCII byte are overwritten later),
+// so the output must have room for a full block.
+static inline size_t convertAsciiBlock(const unsigned char *in, CodePoint *out) {
+  __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in));
+  uint32_t mask = (uint32_t)_mm_movemask_epi8(bytes);
+  if (mask == 0xFFFF) {
+    return 0;
+  }
+
+  __m128i zero = _mm_setzero_si128();
+  __m128i low = _mm_unpacklo_epi8(bytes, zero);
+  __m128i high = _mm_unpackhi_epi8(bytes, zero);
+  __m128i *target = reinterpret_cast<__m128i *>(out);
+  _mm_storeu_si128(target, _mm_unpacklo_epi16(low, zero));
+  _mm_storeu_si128(target + 1, _mm_unpackhi_epi16(low, zero));
+  _mm_storeu_si128(target + 2, _mm_unpacklo_epi16(high, zero));
+  _mm_storeu_si128(target + 3, _mm_unpackhi_epi16(high, zero));
+
+  return mask == 0 ? BLOCK_SIZE : countTrailingZeros(mask);
+}
+
+static inline size_t countAsciiBlock(const unsigned char *in) {
+  uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in)));
+  return mask == 0 ? BLOCK_SIZE : countTrailingZeros(mask);
+}
+
+// Narrows a block of BLOCK_SIZE code points to bytes, if all of them are ASCII.
+static inline bool encodeAsciiBlock(const CodePoint *in, char *out) {
+  const __m128i *source = reinterpret_cast<const __m128i *>(in);
+  __m128i a = _mm_loadu_si128(source);
+  __m128i b = _mm_loadu_si128(source + 1);
+  __m128i c = _mm_loadu_si128(source + 2);
+  __m128i d = _mm_loadu_si128(source + 3);
+
+  __m128i all = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+  if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(all, _mm_set1_epi32(~0x7F)), _mm_setzero_si128())) != 0xFFFF) {
+    return false;
+  }
+
+  // Values are < 0x80, so the saturating packs do not change them.
+  __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(out), bytes);
+  return true;
+}
+
+#else
+
+static const size_t BLOCK_SIZE = 8;
+
+static inline size_t countAsciiBlock(const unsigned char *in) {
+  uint64_t word;
+  memcpy(&word, in, sizeof(word));
+  word &= 0x8080808080808080ULL;
+  if (word == 0) {
+    return BLOCK_SIZE;
+  }
+
+  size_t count = 0;
+  while (in[count] < 0x80) {
+    ++count;
+  }
+  return count;
+}
+
+static inline size_t convertAsciiBlock(const unsigned char *in, CodePoint *out) {
+  size_t count = countAsciiBlock(in);
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = in[i];
+  }
+  return count;
+}
+
+static inline bool encodeAsciiBlock(const CodePoint *in, char *out) {
+  uint32_t all = 0;
+  for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+    all |= (uint32_t)in[i];
+  }
+  if (all >= 0x80) {
+    return false;
+  }
+  for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+    out[i] = (char)in[i];
+  }
+  return true;
+}
+
+#endif
+
+UTF32String UTF8::decode(const char *first, const char *last, ErrorPolicy policy, uint32_t replacement) {
+  UTF32String result;
+  if (first == last) {
+    return result;
+  }
+
+  // Every byte yields at most one code point, so the output never overtakes the input.
+  result.resize(static_cast<size_t>(last - first));
+  CodePoint *out = &result[0];
+  const unsigned char *in = reinterpret_cast<const unsigned char *>(first);
+  const unsigned char *end = reinterpret_cast<const unsigned char *>(last);
+
+  while (in < end) {
+    if (static_cast<size_t>(end - in) >= BLOCK_SIZE) {
+      size_t count = convertAsciiBlock(in, out);
+      in += count;
+      out += count;
+      if (count == BLOCK_SIZE) {
+        continue;
+      }
+    } else if (*in < 0x80) {
+      *out++ = *in++;
+      continue;
+    }
+
+    size_t length;
+    uint32_t codePoint = decodeCodePoint(in, static_cast<size_t>(end - in), length);
+    if (codePoint != INVALID) {
+      *out++ = static_cast<CodePoint>(codePoint);
+    } else {
+      switch (policy) {
+        case ErrorPolicy::Replace:
+          *out++ = static_cast<CodePoint>(replacement);
+          break;
+
+        case ErrorPolicy::Skip:
+          break;
+
+        case ErrorPolicy::Throw:
+          throw std::range_error("Invalid UTF-8 sequence at byte offset " +
+                                 std::to_string(in - reinterpret_cast<const unsigned char *>(first)));
+      }
+    }
+    in += length;
+  }
+
+  result.resize(static_cast<size_t>(out - &result[0]));
+  return result;
+}
+
+bool UTF8::isValid(const char *first, const char *last) {
+  const unsigned char *in = reinterpret_cast<const unsigned char *>(first);
+  const unsigned char *end = reinterpret_cast<const unsigned char *>(last);
+
+  while (in < end) {
+    if (static_cast<size_t>(end - in) >= BLOCK_SIZE) {
+      size_t count = countAsciiBlock(in);
+      in += count;
+      if (count == BLOCK_SIZE) {
+        continue;
+      }
+    } else if (*in < 0x80) {
+      ++in;
+      continue;
+    }
+
+    size_t length;
+    if (decodeCodePoint(in, static_cast<size_t>(end - in), length) == INVALID) {
+      return false;
+    }
+    in += length;
+  }
+  return true;
+}
+
+static inline uint32_t validCodePoint(CodePoint value) {
+  uint32_t codePoint = static_cast<uint32_t>(value);
+  if (codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF)) {
+    return UTF8::REPLACEMENT_CHARACTER;
+  }
+  return codePoint;
+}
+
+std::string UTF8::encode(const CodePoint *first, const CodePoint *last) {
+  // Compute the exact size first, to avoid both reallocations and a worst case buffer.
+  size_t size = 0;
+  for (const CodePoint *in = first; in < last; ++in) {
+    uint32_t codePoint = validCodePoint(*in);
+    size += codePoint < 0x80 ? 1 : codePoint < 0x800 ? 2 : codePoint < 0x10000 ? 3 : 4;
+  }
+
+  std::string result;
+  if (size == 0) {
+    return result;
+  }
+
+  result.resize(size);
+  char *out = &result[0];
+  const CodePoint *in = first;
+  while (in < last) {
+    if (static_cast<size_t>(last - in) >= BLOCK_SIZE && encodeAsciiBlock(in, out)) {
+      in += BLOCK_SIZE;
+      out += BLOCK_SIZE;
+      continue;
+    }
+
+    uint32_t codePoint = validCodePoint(*in++);
+    if (codePoint < 0x80) {
+      *out++ = static_cast<char>(codePoint);
+    } else if (codePoint < 0x800) {
+      *out++ = static_cast<char>(0xC0 | (codePoint >> 6));
+      *out++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+      *out++ = static_cast<char>(0xE0 | (codePoint >> 12));
+      *out++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+      *out++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else {
+      *out++ = static_cast<char>(0xF0 | (codePoint >> 18));
+      *out++ = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+      *out++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+      *out++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+  }
+
+  return result;
+}
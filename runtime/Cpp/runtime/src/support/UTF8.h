@@ -0,0 +1,95 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include "antlr4-common.h"
+
+namespace antlrcpp {
+
+  /// Conversion between UTF-8 and UTF-32, used by the char streams.
+  ///
+  /// Runs of ASCII characters (which make up most of typical grammar input) are converted 16 bytes at a time
+  /// with SSE2 where available, otherwise 8 bytes at a time with plain integer operations. Everything else goes
+  /// through a scalar decoder which rejects overlong forms, surrogates and code points beyond U+10FFFF.
+  class ANTLR4CPP_PUBLIC UTF8 {
+  public:
+    typedef UTF32String::value_type CodePoint;
+
+    static const uint32_t REPLACEMENT_CHARACTER = 0xFFFD;
+
+    /// Returned by decodeCodePoint() for an invalid or truncated sequence.
+    static const uint32_t INVALID = 0xFFFFFFFF;
+
+    /// How invalid input is handled when decoding.
+    enum class ErrorPolicy {
+      Replace, // Every invalid byte is replaced by a replacement character (U+FFFD by default).
+      Skip,    // Invalid bytes are dropped.
+      Throw    // A std::range_error is thrown (the behavior of std::codecvt_utf8).
+    };
+
+    /// Decodes the UTF-8 input in [first, last) to UTF-32. Invalid input is handled according to the given policy,
+    /// one replacement character per invalid byte.
+    static UTF32String decode(const char *first, const char *last, ErrorPolicy policy = ErrorPolicy::Replace,
+                              uint32_t replacement = REPLACEMENT_CHARACTER);
+
+    /// Returns true if [first, last) is well formed UTF-8.
+    static bool isValid(const char *first, const char *last);
+
+    /// Encodes the code points in [first, last) to UTF-8. Values which are no valid code points (surrogates or values
+    /// beyond U+10FFFF) are encoded as U+FFFD.
+    static std::string encode(const CodePoint *first, const CodePoint *last);
+
+    /// Decodes the code point at the start of data (with at least one byte available) and stores the number of bytes
+    /// it takes in length. Invalid or truncated sequences return INVALID and a length of 1.
+    static uint32_t decodeCodePoint(const unsigned char *data, size_t available, size_t &length) {
+      unsigned char c = data[0];
+      length = 1;
+      if (c < 0x80) {
+        return c;
+      }
+
+      size_t needed;
+      uint32_t result;
+      unsigned char low = 0x80, high = 0xBF; // Valid range of the second byte.
+      if (c >= 0xC2 && c <= 0xDF) {
+        needed = 1;
+        result = c & 0x1F;
+      } else if (c >= 0xE0 && c <= 0xEF) {
+        needed = 2;
+        result = c & 0x0F;
+        if (c == 0xE0) {
+          low = 0xA0; // Overlong.
+        } else if (c == 0xED) {
+          high = 0x9F; // Surrogates.
+        }
+      } else if (c >= 0xF0 && c <= 0xF4) {
+        needed = 3;
+        result = c & 0x07;
+        if (c == 0xF0) {
+          low = 0x90; // Overlong.
+        } else if (c == 0xF4) {
+          high = 0x8F; // Beyond U+10FFFF.
+        }
+      } else {
+        return INVALID;
+      }
+
+      if (available <= needed || data[1] < low || data[1] > high) {
+        return INVALID;
+      }
+      for (size_t i = 1; i <= needed; ++i) {
+        if ((data[i] & 0xC0) != 0x80) {
+          return INVALID;
+        }
+        result = (result << 6) | (data[i] & 0x3F);
+      }
+
+      length = needed + 1;
+      return result;
+    }
+  };
+
+} // namespace antlrcpp
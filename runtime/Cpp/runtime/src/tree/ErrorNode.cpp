@@ -5,5 +5,9 @@
 
 #include "tree/ErrorNode.h"
 
+antlr4::tree::ErrorNode::ErrorNode() {
+  _treeType = ParseTreeType::ERROR_NODE;
+}
+
 antlr4::tree::ErrorNode::~ErrorNode() {
 }
@@ -0,0 +1,62 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include "ParserRuleContext.h"
+#include "tree/ErrorNode.h"
+#include "tree/TerminalNode.h"
+
+namespace antlr4 {
+namespace tree {
+
+  template<typename Listener>
+  class FusedListenerSlot {
+  protected:
+    FusedListenerSlot(Listener &listener) : _listener(&listener) {}
+
+    Listener *_listener;
+  };
+
+  /// A listener which forwards each event to all of the given listeners, in their order, so that a single walk of a
+  /// tree serves all of them. Each listener receives the same events in the same order as from a walk of its own.
+  ///
+  /// The listener types are known at compile time and their methods are called non-virtually, which allows the
+  /// compiler to inline them. Hence every type must be the dynamic type of the listener object passed in, and no
+  /// type may occur twice. The generated <grammar>FusedListener templates derive from this class (with the generated
+  /// listener interface as Interface) and forward the rule specific events in the same way.
+  template<typename Interface, typename... Listeners>
+  class FusedParseTreeListener : public Interface, private FusedListenerSlot<Listeners>... {
+  public:
+    FusedParseTreeListener(Listeners &... listeners) : FusedListenerSlot<Listeners>(listeners)... {}
+
+    virtual void visitTerminal(TerminalNode *node) override {
+      (void)Calls { 0, (listener<Listeners>().Listeners::visitTerminal(node), 0)... };
+    }
+
+    virtual void visitErrorNode(ErrorNode *node) override {
+      (void)Calls { 0, (listener<Listeners>().Listeners::visitErrorNode(node), 0)... };
+    }
+
+    virtual void enterEveryRule(ParserRuleContext *ctx) override {
+      (void)Calls { 0, (listener<Listeners>().Listeners::enterEveryRule(ctx), 0)... };
+    }
+
+    virtual void exitEveryRule(ParserRuleContext *ctx) override {
+      (void)Calls { 0, (listener<Listeners>().Listeners::exitEveryRule(ctx), 0)... };
+    }
+
+  protected:
+    // Expands a call for each listener, left to right: (void)Calls { 0, (call, 0)... };
+    typedef int Calls[];
+
+    template<typename Listener>
+    Listener& listener() {
+      return *FusedListenerSlot<Listener>::_listener;
+    }
+  };
+
+} // namespace tree
+} // namespace antlr4
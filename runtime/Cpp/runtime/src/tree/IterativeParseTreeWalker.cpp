@@ -13,59 +13,96 @@
 
 using namespace antlr4::tree;
 
-void IterativeParseTreeWalker::walk(ParseTreeListener *listener, ParseTree *t) const {
-
-  std::vector<ParseTree *> nodeStack;
-  std::vector<size_t> indexStack;
+namespace {
 
-  ParseTree *currentNode = t;
-  size_t currentIndex = 0;
+  // The traversal of both walk() variants: visit is called for each node in pre-order, and exit for each rule node
+  // in post-order.
+  template<typename Visit, typename Exit>
+  void walkTree(ParseTree *t, const Visit &visit, const Exit &exit) {
+    std::vector<ParseTree *> nodeStack;
+    std::vector<size_t> indexStack;
 
-  while (currentNode != nullptr) {
-    // pre-order visit
-    if (antlrcpp::is<ErrorNode *>(currentNode)) {
-      listener->visitErrorNode(dynamic_cast<ErrorNode *>(currentNode));
-    } else if (antlrcpp::is<TerminalNode *>(currentNode)) {
-      listener->visitTerminal((TerminalNode *)currentNode);
-    } else {
-      enterRule(listener, currentNode);
-    }
+    ParseTree *currentNode = t;
+    size_t currentIndex = 0;
 
-    // Move down to first child, if it exists.
-    if (!currentNode->children.empty()) {
-      nodeStack.push_back(currentNode);
-      indexStack.push_back(currentIndex);
-      currentIndex = 0;
-      currentNode = currentNode->children[0];
-      continue;
-    }
-
-    // No child nodes, so walk tree.
-    do {
-      // post-order visit
-      if (!antlrcpp::is<TerminalNode *>(currentNode)) {
-        exitRule(listener, currentNode);
-      }
+    while (currentNode != nullptr) {
+      // pre-order visit
+      visit(currentNode);
 
-      // No parent, so no siblings.
-      if (nodeStack.empty()) {
-        currentNode = nullptr;
+      // Move down to first child, if it exists.
+      if (!currentNode->children.empty()) {
+        nodeStack.push_back(currentNode);
+        indexStack.push_back(currentIndex);
         currentIndex = 0;
-        break;
+        currentNode = currentNode->children[0];
+        continue;
       }
 
-      // Move to next sibling if possible.
-      if (nodeStack.back()->children.size() > ++currentIndex) {
-        currentNode = nodeStack.back()->children[currentIndex];
-        break;
-      }
+      // No child nodes, so walk tree.
+      do {
+        // post-order visit
+        if (currentNode->isRuleNode()) {
+          exit(currentNode);
+        }
+
+        // No parent, so no siblings.
+        if (nodeStack.empty()) {
+          currentNode = nullptr;
+          currentIndex = 0;
+          break;
+        }
+
+        // Move to next sibling if possible.
+        if (nodeStack.back()->children.size() > ++currentIndex) {
+          currentNode = nodeStack.back()->children[currentIndex];
+          break;
+        }
 
-      // No next sibling, so move up.
-      currentNode = nodeStack.back();
-      nodeStack.pop_back();
-      currentIndex = indexStack.back();
-      indexStack.pop_back();
+        // No next sibling, so move up.
+        currentNode = nodeStack.back();
+        nodeStack.pop_back();
+        currentIndex = indexStack.back();
+        indexStack.pop_back();
 
-    } while (currentNode != nullptr);
+      } while (currentNode != nullptr);
+    }
   }
+
+}
+
+void IterativeParseTreeWalker::walk(ParseTreeListener *listener, ParseTree *t) const {
+  walkTree(t, [this, listener](ParseTree *node) {
+    if (node->isErrorNode()) {
+      listener->visitErrorNode(dynamic_cast<ErrorNode *>(node));
+    } else if (node->isTerminalNode()) {
+      listener->visitTerminal(static_cast<TerminalNode *>(node));
+    } else {
+      enterRule(listener, node);
+    }
+  }, [this, listener](ParseTree *node) {
+    exitRule(listener, node);
+  });
+}
+
+void IterativeParseTreeWalker::walkAll(const std::vector<ParseTreeListener *> &listeners, ParseTree *t) const {
+  walkTree(t, [this, &listeners](ParseTree *node) {
+    if (node->isErrorNode()) {
+      ErrorNode *errorNode = dynamic_cast<ErrorNode *>(node);
+      for (auto listener : listeners) {
+        listener->visitErrorNode(errorNode);
+      }
+    } else if (node->isTerminalNode()) {
+      for (auto listener : listeners) {
+        listener->visitTerminal(static_cast<TerminalNode *>(node));
+      }
+    } else {
+      for (auto listener : listeners) {
+        enterRule(listener, node);
+      }
+    }
+  }, [this, &listeners](ParseTree *node) {
+    for (auto listener : listeners) {
+      exitRule(listener, node);
+    }
+  });
 }
@@ -47,6 +47,7 @@ namespace tree {
   class ANTLR4CPP_PUBLIC IterativeParseTreeWalker : public ParseTreeWalker {
   public:
     virtual void walk(ParseTreeListener *listener, ParseTree *t) const override;
+    virtual void walkAll(const std::vector<ParseTreeListener *> &listeners, ParseTree *t) const override;
   };
 
 } // namespace tree
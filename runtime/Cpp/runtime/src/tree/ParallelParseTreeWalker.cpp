@@ -0,0 +1,190 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include <thread>
+
+#include "ParserRuleContext.h"
+#include "tree/ParseTreeListener.h"
+#include "tree/ParseTreeVisitor.h"
+#include "tree/ParseTreeWalker.h"
+
+#include "tree/ParallelParseTreeWalker.h"
+
+using namespace antlr4;
+using namespace antlr4::tree;
+
+// Worker threads which wait for a job and run it together with the thread that posted it.
+class ParallelParseTreeWalker::Pool {
+public:
+  Pool(size_t workerCount) {
+    try {
+      for (size_t i = 0; i < workerCount; ++i) {
+        _threads.emplace_back(&Pool::work, this);
+      }
+    } catch (std::system_error &) {
+      // Continue with the threads we got.
+    }
+  }
+
+  ~Pool() {
+    {
+      std::lock_guard<std::mutex> guard(_lock);
+      _stopping = true;
+    }
+    _wake.notify_all();
+    for (auto &thread : _threads) {
+      thread.join();
+    }
+  }
+
+  size_t getWorkerCount() const {
+    return _threads.size();
+  }
+
+  // Runs job on all workers and on the calling thread, and returns when all are done.
+  void run(const std::function<void ()> &job) {
+    std::lock_guard<std::mutex> runGuard(_runLock);
+    {
+      std::lock_guard<std::mutex> guard(_lock);
+      _job = &job;
+      _busy = _threads.size();
+      ++_generation;
+    }
+    _wake.notify_all();
+
+    job();
+
+    std::unique_lock<std::mutex> guard(_lock);
+    _done.wait(guard, [this]() { return _busy == 0; });
+    _job = nullptr;
+  }
+
+private:
+  std::vector<std::thread> _threads;
+  std::mutex _runLock; // Serializes run().
+  std::mutex _lock;
+  std::condition_variable _wake;
+  std::condition_variable _done;
+  const std::function<void ()> *_job = nullptr;
+  size_t _generation = 0;
+  size_t _busy = 0;
+  bool _stopping = false;
+
+  void work() {
+    size_t generation = 0;
+    std::unique_lock<std::mutex> guard(_lock);
+    while (true) {
+      _wake.wait(guard, [this, generation]() { return _stopping || _generation != generation; });
+      if (_stopping) {
+        return;
+      }
+
+      generation = _generation;
+      const std::function<void ()> *job = _job;
+      guard.unlock();
+      (*job)();
+      guard.lock();
+      if (--_busy == 0) {
+        _done.notify_all();
+      }
+    }
+  }
+};
+
+ParallelParseTreeWalker::ParallelParseTreeWalker(size_t threadCount) {
+  if (threadCount == 0) {
+    threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  }
+  _pool.reset(new Pool(threadCount - 1));
+}
+
+ParallelParseTreeWalker::~ParallelParseTreeWalker() {
+}
+
+size_t ParallelParseTreeWalker::getThreadCount() const {
+  return _pool->getWorkerCount() + 1;
+}
+
+void ParallelParseTreeWalker::walk(ParseTreeListener *listener, ParseTree *t,
+  const std::function<std::unique_ptr<ParseTreeListener>()> &fork,
+  const std::function<void (ParseTreeListener *)> &join) const {
+  if (t->isTerminalNode()) {
+    ParseTreeWalker::DEFAULT.walk(listener, t);
+    return;
+  }
+
+  ParserRuleContext *ctx = static_cast<ParserRuleContext *>(t);
+  listener->enterEveryRule(ctx);
+  ctx->enterRule(listener);
+
+  // The listeners are created up front, so fork() is only called from this thread.
+  const ParseTreeChildren &children = t->children;
+  std::vector<std::unique_ptr<ParseTreeListener>> listeners;
+  for (size_t i = getGroupCount(children.size()); i > 0; --i) {
+    listeners.push_back(fork());
+  }
+  run(children.size(), listeners.size(), [&](size_t group, size_t first, size_t last) {
+    for (size_t i = first; i < last; ++i) {
+      ParseTreeWalker::DEFAULT.walk(listeners[group].get(), children[i]);
+    }
+  });
+  for (auto &groupListener : listeners) {
+    join(groupListener.get());
+  }
+
+  ctx->exitRule(listener);
+  listener->exitEveryRule(ctx);
+}
+
+std::vector<antlrcpp::Any> ParallelParseTreeWalker::visitChildren(ParseTree *t,
+  const std::function<std::unique_ptr<ParseTreeVisitor>()> &fork) const {
+  const ParseTreeChildren &children = t->children;
+  std::vector<std::unique_ptr<ParseTreeVisitor>> visitors;
+  for (size_t i = getGroupCount(children.size()); i > 0; --i) {
+    visitors.push_back(fork());
+  }
+
+  std::vector<antlrcpp::Any> results(children.size());
+  run(children.size(), visitors.size(), [&](size_t group, size_t first, size_t last) {
+    for (size_t i = first; i < last; ++i) {
+      results[i] = children[i]->accept(visitors[group].get());
+    }
+  });
+  return results;
+}
+
+size_t ParallelParseTreeWalker::getGroupCount(size_t childCount) const {
+  // More groups than threads even out the differences between subtree sizes.
+  return std::min(childCount, getThreadCount() * 4);
+}
+
+void ParallelParseTreeWalker::run(size_t count, size_t groupCount,
+  const std::function<void (size_t, size_t, size_t)> &task) const {
+  std::atomic<size_t> next(0);
+  std::atomic<bool> failed(false);
+  std::vector<std::exception_ptr> exceptions(groupCount);
+  auto work = [&]() {
+    for (size_t group = next++; group < groupCount && !failed; group = next++) {
+      try {
+        task(group, group * count / groupCount, (group + 1) * count / groupCount);
+      } catch (...) {
+        exceptions[group] = std::current_exception();
+        failed = true;
+      }
+    }
+  };
+
+  if (groupCount > 1) {
+    _pool->run(work);
+  } else {
+    work();
+  }
+
+  for (auto &exception : exceptions) {
+    if (exception) {
+      std::rethrow_exception(exception);
+    }
+  }
+}
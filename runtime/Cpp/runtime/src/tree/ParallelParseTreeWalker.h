@@ -0,0 +1,61 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include "antlr4-common.h"
+#include "support/Any.h"
+
+namespace antlr4 {
+namespace tree {
+
+  /// Walks or visits the subtrees below a node concurrently, for analyses which are independent per subtree (think of
+  /// the declarations of a compilation unit).
+  ///
+  /// The walker owns a pool of worker threads, which is created once and used for all walks (the calling thread
+  /// takes part in each walk, too). The children of the node are split into groups of consecutive children, which the
+  /// threads take one after the other until all are done, so a few large subtrees don't hold up the others. Each group
+  /// is handled by its own listener (or visitor) from a fork function, and the results are joined in the order of the
+  /// children on the calling thread. This makes the outcome independent of the number of threads and of their timing.
+  ///
+  /// Listeners and visitors must not change the tree and should only access the subtree they are given. Walks with
+  /// the same walker are serialized, so they must not be started from its own listeners or visitors.
+  class ANTLR4CPP_PUBLIC ParallelParseTreeWalker {
+  public:
+    /// A thread count of 0 uses as many threads as there are cores.
+    ParallelParseTreeWalker(size_t threadCount = 0);
+    ParallelParseTreeWalker(const ParallelParseTreeWalker &other) = delete;
+    ~ParallelParseTreeWalker();
+
+    ParallelParseTreeWalker& operator = (const ParallelParseTreeWalker &other) = delete;
+
+    /// The number of threads used for a walk, including the calling thread.
+    size_t getThreadCount() const;
+
+    /// Walks the tree with the given listener, except for the subtrees of the children of t, which are walked
+    /// concurrently with listeners from fork(). Once all are done, join() is called with each of these listeners in
+    /// the order of the children and before the listener gets the exit events of t. If a listener throws, the first
+    /// exception (in child order) is rethrown after all running groups have stopped, and join() is not called.
+    void walk(ParseTreeListener *listener, ParseTree *t, const std::function<std::unique_ptr<ParseTreeListener>()> &fork,
+      const std::function<void (ParseTreeListener *)> &join) const;
+
+    /// Visits the children of t concurrently with visitors from fork() and returns the results in child order.
+    std::vector<antlrcpp::Any> visitChildren(ParseTree *t,
+      const std::function<std::unique_ptr<ParseTreeVisitor>()> &fork) const;
+
+  private:
+    class Pool;
+
+    std::unique_ptr<Pool> _pool;
+
+    size_t getGroupCount(size_t childCount) const;
+
+    // Splits count children into groupCount groups and runs task(group, first, last) for each of them on the pool
+    // threads and the calling thread.
+    void run(size_t count, size_t groupCount, const std::function<void (size_t, size_t, size_t)> &task) const;
+  };
+
+} // namespace tree
+} // namespace antlr4
@@ -3,13 +3,64 @@
  * can be found in the LICENSE.txt file in the project root.
  */
 
+#include "Exceptions.h"
+
 #include "tree/ParseTree.h"
 
+using namespace antlr4;
 using namespace antlr4::tree;
 
-ParseTree::ParseTree() : parent(nullptr) {
+ParseTree::ParseTree() : parent(nullptr), _treeType(ParseTreeType::RULE_NODE) {
 }
 
 bool ParseTree::operator == (const ParseTree &other) const {
   return &other == this;
 }
+
+ParseTreeTracker::ParseTreeTracker() : _arena(antlrcpp::Arena::create()) {
+}
+
+ParseTreeTracker::~ParseTreeTracker() {
+  reset();
+  if (_arena != nullptr) {
+    _arena->release();
+  }
+}
+
+void ParseTreeTracker::reset() {
+  if (_arena == nullptr) {
+    for (auto entry : _allocated)
+      delete entry;
+    _allocated.clear();
+    return;
+  }
+
+  for (auto entry : _allocated) {
+    entry->~ParseTree();
+    _arena->deallocate(entry);
+  }
+  _allocated.clear();
+  if (_arena->isUnused()) {
+    _arena->rewind();
+  }
+}
+
+void ParseTreeTracker::setUseArena(bool useArena) {
+  if (useArena == isUsingArena()) {
+    return;
+  }
+  if (!_allocated.empty()) {
+    throw IllegalStateException("The allocation of parse trees can only be changed while no tree exists.");
+  }
+
+  if (useArena) {
+    _arena = antlrcpp::Arena::create();
+  } else {
+    _arena->release();
+    _arena = nullptr;
+  }
+}
+
+bool ParseTreeTracker::isUsingArena() const {
+  return _arena != nullptr;
+}
@@ -6,10 +6,19 @@
 #pragma once
 
 #include "support/Any.h"
+#include "support/Arena.h"
+#include "tree/ParseTreeChildren.h"
 
 namespace antlr4 {
 namespace tree {
 
+  /// The kind of a parse tree node, to allow for type checks and static casts without RTTI.
+  enum class ParseTreeType : size_t {
+    RULE_NODE,     // RuleContext and its subclasses
+    TERMINAL_NODE, // TerminalNode
+    ERROR_NODE     // ErrorNode (which is also a TerminalNode)
+  };
+
   /// An interface to access the tree of <seealso cref="RuleContext"/> objects created
   /// during a parse that makes the data structure look like a simple parse tree.
   /// This node represents both internal nodes, rule invocations,
@@ -35,7 +44,7 @@ namespace tree {
     /// operation because we don't the need to track the details about
     /// how we parse this rule.
     // ml: memory is not managed here, but by the owning class. This is just for the structure.
-    std::vector<ParseTree *> children;
+    ParseTreeChildren children;
 
     /// Print out a whole tree, not just a node, in LISP format
     /// {@code (root child1 .. childN)}. Print just a node if this is a leaf.
@@ -48,6 +57,13 @@ namespace tree {
 
     virtual bool operator == (const ParseTree &other) const;
 
+    ParseTreeType getTreeType() const { return _treeType; }
+
+    /// Rule nodes are RuleContext instances, terminal (and error) nodes are TerminalNode instances.
+    bool isRuleNode() const { return _treeType == ParseTreeType::RULE_NODE; }
+    bool isTerminalNode() const { return _treeType != ParseTreeType::RULE_NODE; }
+    bool isErrorNode() const { return _treeType == ParseTreeType::ERROR_NODE; }
+
     /// The <seealso cref="ParseTreeVisitor"/> needs a double dispatch method.
     // ml: This has been changed to use Any instead of a template parameter, to avoid the need of a virtual template function.
     virtual antlrcpp::Any accept(ParseTreeVisitor *visitor) = 0;
@@ -74,26 +90,54 @@ namespace tree {
      * EOF is unspecified.</p>
      */
     virtual misc::Interval getSourceInterval() = 0;
+
+  protected:
+    /// Set by the constructors of TerminalNode and ErrorNode.
+    ParseTreeType _treeType;
   };
 
   // A class to help managing ParseTree instances without the need of a shared_ptr.
+  //
+  // Nodes are taken from an arena, so creating one is mostly a pointer bump and the nodes of a tree lie close
+  // together in memory. reset() runs the destructors of all nodes and then rewinds the arena, which keeps its memory
+  // for the next tree instead of freeing each node.
   class ANTLR4CPP_PUBLIC ParseTreeTracker {
   public:
+    ParseTreeTracker();
+    ParseTreeTracker(const ParseTreeTracker &other) = delete;
+    ~ParseTreeTracker();
+
+    ParseTreeTracker& operator = (const ParseTreeTracker &other) = delete;
+
     template<typename T, typename ... Args>
     T* createInstance(Args&& ... args) {
       static_assert(std::is_base_of<ParseTree, T>::value, "Argument must be a parse tree type");
-      T* result = new T(args...);
+      T* result;
+      if (_arena != nullptr) {
+        void *memory = _arena->allocate(sizeof(T));
+        try {
+          result = new (memory) T(args...);
+        } catch (...) {
+          _arena->deallocate(memory);
+          throw;
+        }
+      } else {
+        result = new T(args...);
+      }
       _allocated.push_back(result);
       return result;
     }
 
-    void reset() {
-      for (auto entry : _allocated)
-        delete entry;
-      _allocated.clear();
-    }
+    void reset();
+
+    /// Allocates each node separately with new/delete instead of from the arena, e.g. to let memory checkers watch
+    /// every node. Can only be changed while no nodes exist.
+    /// @throws IllegalStateException if nodes have been created since the last reset().
+    void setUseArena(bool useArena);
+    bool isUsingArena() const;
 
   private:
+    antlrcpp::Arena *_arena;
     std::vector<ParseTree *> _allocated;
   };
 
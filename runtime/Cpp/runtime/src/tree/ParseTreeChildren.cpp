@@ -0,0 +1,185 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#include "RuleContext.h"
+#include "Token.h"
+#include "tree/TerminalNode.h"
+
+#include "tree/ParseTreeChildren.h"
+
+using namespace antlr4;
+using namespace antlr4::tree;
+
+const size_t ParseTreeChildren::INDEX_THRESHOLD;
+
+// The children sorted by key (and by position for equal keys).
+struct ParseTreeChildren::Index {
+  std::vector<size_t> keys;
+  std::vector<ParseTree *> children;
+};
+
+ParseTreeChildren::ParseTreeChildren(std::initializer_list<ParseTree *> list) : ParseTreeChildren() {
+  assign(list.begin(), list.size());
+}
+
+ParseTreeChildren::ParseTreeChildren(const ParseTreeChildren &other) : ParseTreeChildren() {
+  assign(other.data(), other.size());
+}
+
+ParseTreeChildren& ParseTreeChildren::operator = (const ParseTreeChildren &other) {
+  if (&other != this) {
+    assign(other.data(), other.size());
+  }
+  return *this;
+}
+
+ParseTreeChildren& ParseTreeChildren::operator = (std::initializer_list<ParseTree *> list) {
+  assign(list.begin(), list.size());
+  return *this;
+}
+
+ParseTreeChildren::iterator ParseTreeChildren::erase(iterator first, iterator last) {
+  invalidateIndex();
+  iterator end = this->end();
+  std::copy(last, end, first);
+  _size -= static_cast<uint32_t>(last - first);
+  return first;
+}
+
+void ParseTreeChildren::reserve(size_t capacity) {
+  if (capacity <= _capacity) {
+    return;
+  }
+
+  // The index stays valid, it refers to the children and not to their positions.
+  ParseTree **heap = allocate(capacity);
+  ParseTree **old = data();
+  std::copy(old, old + _size, heap);
+  if (_capacity > 1) {
+    moveIndex(_heap, heap);
+    release(_heap);
+  }
+  _heap = heap;
+  _capacity = static_cast<uint32_t>(capacity);
+}
+
+void ParseTreeChildren::shrink_to_fit() {
+  if (_capacity == 1 || _size == _capacity) {
+    return;
+  }
+
+  ParseTree **heap = _heap;
+  if (_size <= 1) {
+    _single = _size == 1 ? heap[0] : nullptr;
+    _capacity = 1;
+  } else {
+    _heap = allocate(_size);
+    std::copy(heap, heap + _size, _heap);
+    moveIndex(heap, _heap);
+    _capacity = _size;
+  }
+  release(heap);
+}
+
+ParseTree** ParseTreeChildren::allocate(size_t capacity) {
+  static_assert(sizeof(Header) % alignof(ParseTree *) == 0, "The children must be aligned after the header");
+  char *block = static_cast<char *>(::operator new(sizeof(Header) + capacity * sizeof(ParseTree *)));
+  Header *header = new (block) Header();
+  header->index.store(nullptr, std::memory_order_relaxed);
+  return reinterpret_cast<ParseTree **>(block + sizeof(Header));
+}
+
+void ParseTreeChildren::release(ParseTree **heap) {
+  Header &header = getHeader(heap);
+  delete header.index.load(std::memory_order_relaxed);
+  header.~Header();
+  ::operator delete(&header);
+}
+
+void ParseTreeChildren::moveIndex(ParseTree **from, ParseTree **to) {
+  Index *index = getHeader(from).index.exchange(nullptr, std::memory_order_relaxed);
+  getHeader(to).index.store(index, std::memory_order_relaxed);
+}
+
+void ParseTreeChildren::dropIndex() {
+  delete getHeader(_heap).index.exchange(nullptr, std::memory_order_relaxed);
+}
+
+const ParseTreeChildren::Index& ParseTreeChildren::buildIndex() const {
+  std::atomic<Index *> &slot = getHeader(_heap).index;
+  Index *index = slot.load(std::memory_order_acquire);
+  if (index != nullptr) {
+    return *index;
+  }
+
+  std::vector<std::pair<size_t, size_t>> order(_size);
+  for (size_t i = 0; i < _size; ++i) {
+    order[i] = { getKey(_heap[i]), i };
+  }
+  std::sort(order.begin(), order.end());
+
+  index = new Index();
+  index->keys.reserve(_size);
+  index->children.reserve(_size);
+  for (auto &entry : order) {
+    index->keys.push_back(entry.first);
+    index->children.push_back(_heap[entry.second]);
+  }
+
+  // Concurrent lookups may build the index at the same time, the first one to finish is used.
+  Index *expected = nullptr;
+  if (!slot.compare_exchange_strong(expected, index, std::memory_order_acq_rel, std::memory_order_acquire)) {
+    delete index;
+    return *expected;
+  }
+  return *index;
+}
+
+size_t ParseTreeChildren::getKey(ParseTree *child) {
+  if (child->isTerminalNode()) {
+    return static_cast<TerminalNode *>(child)->getSymbol()->getType() * 2 + 1;
+  }
+  return static_cast<RuleContext *>(child)->getRuleIndex() * 2;
+}
+
+std::pair<ParseTreeChildren::const_iterator, ParseTreeChildren::const_iterator> ParseTreeChildren::find(size_t key) const {
+  if (_capacity == 1) {
+    if (_size == 1 && getKey(_single) == key) {
+      return { &_single, &_single + 1 };
+    }
+    return { nullptr, nullptr };
+  }
+
+  const Index &index = buildIndex();
+  auto range = std::equal_range(index.keys.begin(), index.keys.end(), key);
+  const_iterator first = index.children.data() + (range.first - index.keys.begin());
+  return { first, first + (range.second - range.first) };
+}
+
+ParseTree* ParseTreeChildren::find(size_t key, size_t i) const {
+  if (_capacity == 1 || (_size < INDEX_THRESHOLD && getHeader(_heap).index.load(std::memory_order_acquire) == nullptr)) {
+    const_iterator end = this->end();
+    for (const_iterator iterator = begin(); iterator != end; ++iterator) {
+      if (getKey(*iterator) == key && i-- == 0) {
+        return *iterator;
+      }
+    }
+    return nullptr;
+  }
+
+  auto range = find(key);
+  if (i >= static_cast<size_t>(range.second - range.first)) {
+    return nullptr;
+  }
+  return range.first[i];
+}
+
+void ParseTreeChildren::assign(ParseTree* const* first, size_t size) {
+  invalidateIndex();
+  _size = 0;
+  reserve(size);
+  std::copy(first, first + size, data());
+  _size = static_cast<uint32_t>(size);
+}
@@ -0,0 +1,223 @@
+/* Copyright (c) 2012-2017 The ANTLR Project. All rights reserved.
+ * Use of this file is governed by the BSD 3-clause license that
+ * can be found in the LICENSE.txt file in the project root.
+ */
+
+#pragma once
+
+#include "antlr4-common.h"
+
+namespace antlr4 {
+namespace tree {
+
+  class ParseTree;
+
+  /// A view of consecutive child pointers as pointers to one child type, for instance the children of a rule context
+  /// which match a rule (see ParseTreeChildren::findRuleContexts()). It has the read interface of a std::vector<T *>
+  /// and converts to one, but doesn't copy anything. The view is valid until the child list it refers to changes.
+  template<typename T>
+  class ChildSpan {
+  public:
+    class const_iterator {
+    public:
+      typedef std::random_access_iterator_tag iterator_category;
+      typedef T* value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef T* const* pointer;
+      typedef T* reference;
+
+      const_iterator() : _position(nullptr) {}
+      explicit const_iterator(ParseTree* const* position) : _position(position) {}
+
+      T* operator * () const { return static_cast<T *>(*_position); }
+      T* operator [] (difference_type offset) const { return static_cast<T *>(_position[offset]); }
+
+      const_iterator& operator ++ () { ++_position; return *this; }
+      const_iterator operator ++ (int) { return const_iterator(_position++); }
+      const_iterator& operator -- () { --_position; return *this; }
+      const_iterator operator -- (int) { return const_iterator(_position--); }
+      const_iterator& operator += (difference_type offset) { _position += offset; return *this; }
+      const_iterator& operator -= (difference_type offset) { _position -= offset; return *this; }
+      const_iterator operator + (difference_type offset) const { return const_iterator(_position + offset); }
+      const_iterator operator - (difference_type offset) const { return const_iterator(_position - offset); }
+      difference_type operator - (const const_iterator &other) const { return _position - other._position; }
+
+      bool operator == (const const_iterator &other) const { return _position == other._position; }
+      bool operator != (const const_iterator &other) const { return _position != other._position; }
+      bool operator < (const const_iterator &other) const { return _position < other._position; }
+      bool operator > (const const_iterator &other) const { return _position > other._position; }
+      bool operator <= (const const_iterator &other) const { return _position <= other._position; }
+      bool operator >= (const const_iterator &other) const { return _position >= other._position; }
+
+    private:
+      ParseTree* const* _position;
+    };
+
+    typedef T* value_type;
+    typedef const_iterator iterator;
+    typedef size_t size_type;
+
+    ChildSpan() : _begin(nullptr), _end(nullptr) {}
+    ChildSpan(ParseTree* const* begin, ParseTree* const* end) : _begin(begin), _end(end) {}
+    ChildSpan(const std::pair<ParseTree* const*, ParseTree* const*> &range) : _begin(range.first), _end(range.second) {}
+
+    operator std::vector<T *>() const {
+      return std::vector<T *>(begin(), end());
+    }
+
+    const_iterator begin() const { return const_iterator(_begin); }
+    const_iterator end() const { return const_iterator(_end); }
+
+    size_t size() const { return static_cast<size_t>(_end - _begin); }
+    bool empty() const { return _begin == _end; }
+
+    T* operator [] (size_t index) const { return static_cast<T *>(_begin[index]); }
+    T* at(size_t index) const {
+      if (index >= size()) {
+        throw std::out_of_range("ChildSpan::at");
+      }
+      return static_cast<T *>(_begin[index]);
+    }
+
+    T* front() const { return static_cast<T *>(*_begin); }
+    T* back() const { return static_cast<T *>(_end[-1]); }
+
+  private:
+    ParseTree* const* _begin;
+    ParseTree* const* _end;
+  };
+
+  /// The child list of a parse tree node, with the interface of a std::vector<ParseTree *> (as far as it is used for
+  /// parse trees).
+  ///
+  /// Most rule nodes have a single child (think of the chains of rules in an expression grammar) and terminal nodes
+  /// have none. So a single child is stored inline and only larger lists go to the heap, which makes the list 16
+  /// bytes instead of the 24 of a vector plus a separately allocated block.
+  ///
+  /// Children can also be looked up by their rule index or token type (which is what the generated context accessors
+  /// do). Larger lists build an index for that on the first lookup, which is kept in the heap block until the list is
+  /// changed (push_back, pop_back, erase, clear or assignment). The index is published atomically, so lookups in the
+  /// same list may run concurrently. Replacing a child in place (through an iterator or operator []) doesn't update
+  /// the index, so lookups see such a change only after one of the changes listed above.
+  class ANTLR4CPP_PUBLIC ParseTreeChildren {
+  public:
+    typedef ParseTree* value_type;
+    typedef ParseTree** iterator;
+    typedef ParseTree* const* const_iterator;
+    typedef size_t size_type;
+
+    ParseTreeChildren() : _single(nullptr), _size(0), _capacity(1) {}
+    ParseTreeChildren(std::initializer_list<ParseTree *> list);
+    ParseTreeChildren(const ParseTreeChildren &other);
+    ~ParseTreeChildren() {
+      if (_capacity > 1) {
+        release(_heap);
+      }
+    }
+
+    ParseTreeChildren& operator = (const ParseTreeChildren &other);
+    ParseTreeChildren& operator = (std::initializer_list<ParseTree *> list);
+
+    operator std::vector<ParseTree *>() const {
+      return std::vector<ParseTree *>(begin(), end());
+    }
+
+    ParseTree** data() { return _capacity > 1 ? _heap : &_single; }
+    ParseTree* const* data() const { return _capacity > 1 ? _heap : &_single; }
+
+    iterator begin() { return data(); }
+    iterator end() { return data() + _size; }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + _size; }
+
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    size_t capacity() const { return _capacity; }
+
+    ParseTree*& operator [] (size_t index) { return data()[index]; }
+    ParseTree* operator [] (size_t index) const { return data()[index]; }
+
+    ParseTree*& front() { return data()[0]; }
+    ParseTree*& back() { return data()[_size - 1]; }
+
+    void push_back(ParseTree *child) {
+      if (_size == _capacity) {
+        reserve(_capacity * 2);
+      }
+      invalidateIndex();
+      data()[_size++] = child;
+    }
+
+    void pop_back() { invalidateIndex(); --_size; }
+    void clear() { invalidateIndex(); _size = 0; }
+
+    iterator erase(iterator position) { return erase(position, position + 1); }
+    iterator erase(iterator first, iterator last);
+
+    void reserve(size_t capacity);
+    void shrink_to_fit();
+
+    /// Returns the children which are rule contexts with the given rule index, in their order.
+    std::pair<const_iterator, const_iterator> findRuleContexts(size_t ruleIndex) const {
+      return find(ruleIndex * 2);
+    }
+
+    /// Returns the children which are terminal nodes (including error nodes) with the given token type, in their order.
+    std::pair<const_iterator, const_iterator> findTokens(size_t ttype) const {
+      return find(ttype * 2 + 1);
+    }
+
+    /// Returns the i-th child which is a rule context with the given rule index, or null if there is none.
+    ParseTree* findRuleContext(size_t ruleIndex, size_t i) const {
+      return find(ruleIndex * 2, i);
+    }
+
+    /// Returns the i-th child which is a terminal node with the given token type, or null if there is none.
+    ParseTree* findToken(size_t ttype, size_t i) const {
+      return find(ttype * 2 + 1, i);
+    }
+
+  private:
+    struct Index;
+
+    // Single lookups in lists up to this size scan the list if there's no index yet, instead of creating one.
+    static const size_t INDEX_THRESHOLD = 8;
+
+    union {
+      ParseTree *_single;
+      ParseTree **_heap;
+    };
+    uint32_t _size;
+    uint32_t _capacity; // 1 means the child is stored inline.
+
+    // A heap block starts with this header, followed by the children.
+    struct Header {
+      std::atomic<Index *> index;
+    };
+
+    static ParseTree** allocate(size_t capacity);
+    static void release(ParseTree **heap);
+    static Header& getHeader(ParseTree **heap) {
+      return *reinterpret_cast<Header *>(reinterpret_cast<char *>(heap) - sizeof(Header));
+    }
+    static void moveIndex(ParseTree **from, ParseTree **to);
+
+    void invalidateIndex() {
+      if (_capacity > 1 && getHeader(_heap).index.load(std::memory_order_relaxed) != nullptr) {
+        dropIndex();
+      }
+    }
+
+    void dropIndex();
+    const Index& buildIndex() const;
+
+    // Rule contexts and terminal nodes share the key space: rule index * 2 and token type * 2 + 1 respectively.
+    static size_t getKey(ParseTree *child);
+    std::pair<const_iterator, const_iterator> find(size_t key) const;
+    ParseTree* find(size_t key, size_t i) const;
+
+    void assign(ParseTree* const* first, size_t size);
+  };
+
+} // namespace tree
+} // namespace antlr4
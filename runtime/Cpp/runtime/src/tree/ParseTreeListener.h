@@ -17,9 +17,8 @@ namespace tree {
    *		walker.walk(myParseTreeListener, myParseTree); <-- triggers events in your listener
    *
    *  If you want to trigger events in multiple listeners during a single
-   *  tree walk, you can use the ParseTreeDispatcher object available at
-   *
-   * 		https://github.com/antlr/antlr4/issues/841
+   *  tree walk, pass them all to ParseTreeWalker::walkAll(), or combine them in a
+   *  FusedParseTreeListener (or the generated <grammar>FusedListener).
    */
   class ANTLR4CPP_PUBLIC ParseTreeListener {
   public:
@@ -21,11 +21,12 @@ ParseTreeWalker::~ParseTreeWalker() {
 }
 
 void ParseTreeWalker::walk(ParseTreeListener *listener, ParseTree *t) const {
-  if (is<ErrorNode *>(t)) {
+  if (t->isErrorNode()) {
+    // ErrorNode is a virtual base, so this cast cannot be static.
     listener->visitErrorNode(dynamic_cast<ErrorNode *>(t));
     return;
-  } else if (is<TerminalNode *>(t)) {
-    listener->visitTerminal(dynamic_cast<TerminalNode *>(t));
+  } else if (t->isTerminalNode()) {
+    listener->visitTerminal(static_cast<TerminalNode *>(t));
     return;
   }
 
@@ -36,14 +37,39 @@ void ParseTreeWalker::walk(ParseTreeListener *listener, ParseTree *t) const {
   exitRule(listener, t);
 }
 
+void ParseTreeWalker::walkAll(const std::vector<ParseTreeListener *> &listeners, ParseTree *t) const {
+  if (t->isErrorNode()) {
+    ErrorNode *errorNode = dynamic_cast<ErrorNode *>(t);
+    for (auto listener : listeners) {
+      listener->visitErrorNode(errorNode);
+    }
+    return;
+  } else if (t->isTerminalNode()) {
+    for (auto listener : listeners) {
+      listener->visitTerminal(static_cast<TerminalNode *>(t));
+    }
+    return;
+  }
+
+  for (auto listener : listeners) {
+    enterRule(listener, t);
+  }
+  for (auto &child : t->children) {
+    walkAll(listeners, child);
+  }
+  for (auto listener : listeners) {
+    exitRule(listener, t);
+  }
+}
+
 void ParseTreeWalker::enterRule(ParseTreeListener *listener, ParseTree *r) const {
-  ParserRuleContext *ctx = dynamic_cast<ParserRuleContext *>(r);
+  ParserRuleContext *ctx = static_cast<ParserRuleContext *>(r);
   listener->enterEveryRule(ctx);
   ctx->enterRule(listener);
 }
 
 void ParseTreeWalker::exitRule(ParseTreeListener *listener, ParseTree *r) const {
-  ParserRuleContext *ctx = dynamic_cast<ParserRuleContext *>(r);
+  ParserRuleContext *ctx = static_cast<ParserRuleContext *>(r);
   ctx->exitRule(listener);
   listener->exitEveryRule(ctx);
 }
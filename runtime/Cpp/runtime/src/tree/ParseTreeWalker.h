@@ -18,6 +18,12 @@ namespace tree {
 
     virtual void walk(ParseTreeListener *listener, ParseTree *t) const;
 
+    /// Walks the tree once for all listeners: each node is visited once and its events go to the listeners in
+    /// their order. Every listener receives the same events in the same order as from a walk of its own.
+    /// See also FusedParseTreeListener, which additionally avoids the virtual calls per listener.
+    // Not an overload of walk(), which would be hidden in subclasses overriding only the single listener variant.
+    virtual void walkAll(const std::vector<ParseTreeListener *> &listeners, ParseTree *t) const;
+
   protected:
     /// The discovery of a rule node, involves sending two events: the generic
     /// <seealso cref="ParseTreeListener#enterEveryRule"/> and a
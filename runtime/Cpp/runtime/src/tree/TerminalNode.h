@@ -12,6 +12,7 @@ namespace tree {
 
   class ANTLR4CPP_PUBLIC TerminalNode : public ParseTree {
   public:
+    TerminalNode();
     ~TerminalNode() override;
 
     virtual Token* getSymbol() = 0;
@@ -86,18 +86,18 @@ std::string Trees::getNodeText(ParseTree *t, Parser *recog) {
 
 std::string Trees::getNodeText(ParseTree *t, const std::vector<std::string> &ruleNames) {
   if (ruleNames.size() > 0) {
-    if (is<RuleContext *>(t)) {
-      size_t ruleIndex = dynamic_cast<RuleContext *>(t)->getRuleIndex();
+    if (t->isRuleNode()) {
+      size_t ruleIndex = static_cast<RuleContext *>(t)->getRuleIndex();
       std::string ruleName = ruleNames[ruleIndex];
-      size_t altNumber = dynamic_cast<RuleContext *>(t)->getAltNumber();
+      size_t altNumber = static_cast<RuleContext *>(t)->getAltNumber();
       if (altNumber != atn::ATN::INVALID_ALT_NUMBER) {
         return ruleName + ":" + std::to_string(altNumber);
       }
       return ruleName;
-    } else if (is<ErrorNode *>(t)) {
+    } else if (t->isErrorNode()) {
       return t->toString();
-    } else if (is<TerminalNode *>(t)) {
-      Token *symbol = dynamic_cast<TerminalNode *>(t)->getSymbol();
+    } else {
+      Token *symbol = static_cast<TerminalNode *>(t)->getSymbol();
       if (symbol != nullptr) {
         std::string s = symbol->getText();
         return s;
@@ -105,15 +105,11 @@ std::string Trees::getNodeText(ParseTree *t, const std::vector<std::string> &rul
     }
   }
   // no recog for rule names
-  if (is<RuleContext *>(t)) {
-    return dynamic_cast<RuleContext *>(t)->getText();
-  }
-
-  if (is<TerminalNodeImpl *>(t)) {
-    return dynamic_cast<TerminalNodeImpl *>(t)->getSymbol()->getText();
+  if (t->isRuleNode()) {
+    return static_cast<RuleContext *>(t)->getText();
   }
 
-  return "";
+  return static_cast<TerminalNode *>(t)->getSymbol()->getText();
 }
 
 std::vector<ParseTree *> Trees::getAncestors(ParseTree *t) {
@@ -129,13 +125,13 @@ std::vector<ParseTree *> Trees::getAncestors(ParseTree *t) {
 template<typename T>
 static void _findAllNodes(ParseTree *t, size_t index, bool findTokens, std::vector<T> &nodes) {
   // check this node (the root) first
-  if (findTokens && is<TerminalNode *>(t)) {
-    TerminalNode *tnode = dynamic_cast<TerminalNode *>(t);
+  if (findTokens && t->isTerminalNode()) {
+    TerminalNode *tnode = static_cast<TerminalNode *>(t);
     if (tnode->getSymbol()->getType() == index) {
       nodes.push_back(t);
     }
-  } else if (!findTokens && is<ParserRuleContext *>(t)) {
-    ParserRuleContext *ctx = dynamic_cast<ParserRuleContext *>(t);
+  } else if (!findTokens && t->isRuleNode()) {
+    RuleContext *ctx = static_cast<RuleContext *>(t);
     if (ctx->getRuleIndex() == index) {
       nodes.push_back(t);
     }
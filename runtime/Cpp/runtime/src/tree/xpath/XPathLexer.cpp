@@ -5,6 +5,8 @@ using namespace antlr4;
 
 
 XPathLexer::XPathLexer(CharStream *input) : Lexer(input) {
+  // The ATN and the DFAs are built when the first instance is created (once per grammar, thread safe).
+  static Initializer init;
   _interpreter = new atn::LexerATNSimulator(this, _atn, _decisionToDFA, _sharedContextCache);
 }
 
@@ -169,5 +171,3 @@ XPathLexer::Initializer::Initializer() {
     _decisionToDFA.emplace_back(_atn.getDecisionState(i), i);
   }
 }
-
-XPathLexer::Initializer XPathLexer::_init;
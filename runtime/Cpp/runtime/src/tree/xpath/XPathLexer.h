@@ -51,6 +51,5 @@ private:
   struct Initializer {
     Initializer();
   };
-  static Initializer _init;
 };
 